@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+namespace cppcourse {
+namespace benchmark {
+
+// Keeps the compiler from optimizing away the computation of `value`.
+template <typename T> inline void doNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs `fn` `repetitions` times and returns the fastest run in seconds.
+template <typename Fn> double bestOf(int repetitions, Fn fn) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repetitions; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+inline void printRow(const char *name, double value, const char *unit) {
+  std::printf("%-40s %12.3f %s\n", name, value, unit);
+}
+
+} // namespace benchmark
+} // namespace cppcourse
@@ -0,0 +1,93 @@
+// Persisting a trajectory: text through operator<< against the binary array
+// format, and loading the binary file by mapping it against reading it into
+// a vector.
+//
+// Usage: binary_file_BENCH [poses (1M)] [directory (/tmp)]
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "binary_file.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const int kRepetitions{3};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  const std::string directory = argc > 2 ? argv[2] : "/tmp";
+  const std::string binary_path = directory + "/binary_file_BENCH.bin";
+  const std::string text_path = directory + "/binary_file_BENCH.txt";
+
+  std::vector<Isometry> poses;
+  poses.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    poses.push_back(Isometry::FromTranslation({0.01 * i, 1., 2.}) *
+                    Isometry::FromEulerAngles(1e-3 * i, 0.2, -0.3));
+  }
+  std::printf("%zu poses, %.1f MiB\n", count,
+              count * sizeof(Isometry) / 1048576.);
+
+  printRow("write text", bestOf(kRepetitions,
+                                [&]() {
+                                  std::ofstream out(text_path);
+                                  for (const Isometry &pose : poses) {
+                                    out << pose << '\n';
+                                  }
+                                }) *
+                             1e3,
+           "ms");
+  printRow("write binary", bestOf(kRepetitions,
+                                  [&]() {
+                                    binary::writeArray(binary_path, poses);
+                                  }) *
+                               1e3,
+           "ms");
+  printRow("map binary", bestOf(kRepetitions,
+                                [&]() {
+                                  binary::MappedArrayFile file(binary_path);
+                                  doNotOptimize(file.view<Isometry>().data());
+                                }) *
+                             1e6,
+           "us");
+  printRow("map binary and read every pose",
+           bestOf(kRepetitions,
+                  [&]() {
+                    binary::MappedArrayFile file(binary_path);
+                    double sum = 0.;
+                    for (const Isometry &pose : file.view<Isometry>()) {
+                      sum += pose.translation().x();
+                    }
+                    doNotOptimize(sum);
+                  }) *
+               1e3,
+           "ms");
+  printRow("read binary into a vector",
+           bestOf(kRepetitions,
+                  [&]() {
+                    std::ifstream in(binary_path, std::ios::binary);
+                    in.seekg(binary::kHeaderSize);
+                    std::vector<Isometry> loaded(count);
+                    in.read(reinterpret_cast<char *>(loaded.data()),
+                            count * sizeof(Isometry));
+                    doNotOptimize(loaded.back());
+                  }) *
+               1e3,
+           "ms");
+  std::remove(binary_path.c_str());
+  std::remove(text_path.c_str());
+  return 0;
+}
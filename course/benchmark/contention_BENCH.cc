@@ -0,0 +1,144 @@
+// Read latency of the latest pose under contention: one writer thread
+// publishing back to back (or at a given rate) while N reader threads read.
+// Compares the seqlock PoseCell and the RCU SharedFrameGraph with the same
+// data behind a std::mutex.
+//
+// Usage: contention_BENCH [readers (4)] [writer rate in Hz, 0 = unthrottled]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "seqlock.h"
+#include "shared_frame_graph.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const std::size_t kReadsPerThread{200000};
+
+typedef std::chrono::steady_clock Clock;
+
+FrameGraph graphNumber(double k) {
+  FrameGraph graph;
+  graph.addFrame("map");
+  graph.setTransform("map", "odom", Isometry::FromTranslation({k, 0., 0.}));
+  graph.setTransform("odom", "base",
+                     Isometry::RotateAround(Vector3::kUnitZ, k));
+  graph.setTransform("base", "camera",
+                     Isometry::FromTranslation({0., 0., 1.}));
+  return graph;
+}
+
+// Runs `write(k)` in a loop on one thread and `read()` kReadsPerThread times
+// on each of `readers` threads, then prints read latency percentiles.
+template <typename Write, typename Read>
+void measure(const std::string &name, int readers, double writer_hz,
+             Write write, Read read) {
+  std::atomic<bool> done{false};
+  std::thread writer([&]() {
+    const auto period = std::chrono::duration<double>(
+        writer_hz > 0. ? 1. / writer_hz : 0.);
+    for (int k = 1; !done.load(); ++k) {
+      write(k);
+      if (writer_hz > 0.) {
+        std::this_thread::sleep_for(period);
+      }
+    }
+  });
+  std::vector<std::vector<double>> latencies(readers);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < readers; ++i) {
+    threads.emplace_back([&, i]() {
+      std::vector<double> &out = latencies[i];
+      out.reserve(kReadsPerThread);
+      for (std::size_t j = 0; j < kReadsPerThread; ++j) {
+        const auto start = Clock::now();
+        doNotOptimize(read());
+        out.push_back(
+            std::chrono::duration<double, std::nano>(Clock::now() - start)
+                .count());
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  done.store(true);
+  writer.join();
+
+  std::vector<double> all;
+  for (const std::vector<double> &thread_latencies : latencies) {
+    all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+  const auto percentile = [&](double p) {
+    return all[static_cast<std::size_t>(p * (all.size() - 1))];
+  };
+  printRow((name + " p50").c_str(), percentile(0.5), "ns");
+  printRow((name + " p99").c_str(), percentile(0.99), "ns");
+  printRow((name + " p99.9").c_str(), percentile(0.999), "ns");
+  printRow((name + " max").c_str(), all.back(), "ns");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const int readers = argc > 1 ? std::atoi(argv[1]) : 4;
+  const double writer_hz = argc > 2 ? std::atof(argv[2]) : 0.;
+  std::printf("%d readers, writer %s\n", readers,
+              writer_hz > 0. ? (std::to_string(writer_hz) + " Hz").c_str()
+                             : "unthrottled");
+
+  PoseCell cell;
+  measure("PoseCell (seqlock)", readers, writer_hz,
+          [&](int k) {
+            cell.store(Isometry::FromTranslation({1. * k, 0., 0.}));
+          },
+          [&]() { return cell.load(); });
+
+  std::mutex pose_mutex;
+  Isometry pose;
+  measure("std::mutex + Isometry", readers, writer_hz,
+          [&](int k) {
+            const Isometry next = Isometry::FromTranslation({1. * k, 0., 0.});
+            std::lock_guard<std::mutex> lock(pose_mutex);
+            pose = next;
+          },
+          [&]() {
+            std::lock_guard<std::mutex> lock(pose_mutex);
+            return pose;
+          });
+
+  SharedFrameGraph shared(graphNumber(0.));
+  measure("SharedFrameGraph lookup", readers, writer_hz,
+          [&](int k) { shared.publish(graphNumber(k)); },
+          [&]() { return shared.read()->lookup("camera", "map"); });
+
+  std::mutex graph_mutex;
+  FrameGraph graph = graphNumber(0.);
+  graph.resolveAll();
+  measure("std::mutex + FrameGraph lookup", readers, writer_hz,
+          [&](int k) {
+            FrameGraph next = graphNumber(k);
+            next.resolveAll();
+            std::lock_guard<std::mutex> lock(graph_mutex);
+            graph = std::move(next);
+          },
+          [&]() {
+            std::lock_guard<std::mutex> lock(graph_mutex);
+            return graph.lookup("camera", "map");
+          });
+  return 0;
+}
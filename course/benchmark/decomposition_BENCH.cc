@@ -0,0 +1,173 @@
+// Throughput of the 3x3 symmetric eigendecomposition and SVD, one matrix per
+// call and in structure-of-arrays batches, at both accuracies, and the
+// largest error each accuracy makes on the benchmarked matrices. The batch
+// routines run on the backend picked by kernels::activeBackend(); set
+// CPPCOURSE_SIMD_BACKEND=scalar to compare with the plain C++ kernels.
+//
+// Usage: decomposition_BENCH [matrices (1M)]
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "benchmark.h"
+#include "decomposition.h"
+#include "transform_kernels.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const int kRepetitions{5};
+
+const struct {
+  DecompositionAccuracy accuracy;
+  const char *name;
+} kAccuracies[] = {{DecompositionAccuracy::kFast, "fast"},
+                   {DecompositionAccuracy::kAccurate, "accurate"}};
+
+// General matrices with elements in [-1, 1] and the covariance-like
+// symmetric matrices m^T m.
+template <typename T>
+void randomMatrices(std::size_t count, std::vector<Matrix3T<T>> &general,
+                    std::vector<Matrix3T<T>> &symmetric) {
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> element(-1., 1.);
+  for (std::size_t i = 0; i < count; ++i) {
+    Matrix3 m;
+    for (int k = 0; k < 9; ++k) {
+      m[k / 3][k % 3] = element(generator);
+    }
+    general.push_back(m.cast<T>());
+    symmetric.push_back(m.transpose().product(m).cast<T>());
+  }
+}
+
+template <typename T>
+void run(const char *type, const std::vector<Matrix3T<T>> &general,
+         const std::vector<Matrix3T<T>> &symmetric) {
+  const std::size_t count = general.size();
+  const Matrix3ArrayT<T> general_array(general);
+  const Matrix3ArrayT<T> symmetric_array(symmetric);
+  PointCloud3T<T> values;
+  Matrix3ArrayT<T> u, v;
+  char name[64];
+  for (const auto &accuracy : kAccuracies) {
+    double seconds = bestOf(kRepetitions, [&]() {
+      for (const Matrix3T<T> &m : symmetric) {
+        doNotOptimize(symmetricEigen(m, accuracy.accuracy));
+      }
+    });
+    std::snprintf(name, sizeof(name), "symmetricEigen %s %s", type,
+                  accuracy.name);
+    printRow(name, count * 1e-6 / seconds, "M/s");
+    seconds = bestOf(kRepetitions, [&]() {
+      symmetricEigen(symmetric_array, values, u, accuracy.accuracy);
+      doNotOptimize(values.x()[count - 1]);
+    });
+    std::snprintf(name, sizeof(name), "  batch");
+    printRow(name, count * 1e-6 / seconds, "M/s");
+
+    seconds = bestOf(kRepetitions, [&]() {
+      for (const Matrix3T<T> &m : general) {
+        doNotOptimize(svd(m, accuracy.accuracy));
+      }
+    });
+    std::snprintf(name, sizeof(name), "svd %s %s", type, accuracy.name);
+    printRow(name, count * 1e-6 / seconds, "M/s");
+    seconds = bestOf(kRepetitions, [&]() {
+      svd(general_array, u, values, v, accuracy.accuracy);
+      doNotOptimize(values.x()[count - 1]);
+    });
+    std::snprintf(name, sizeof(name), "  batch");
+    printRow(name, count * 1e-6 / seconds, "M/s");
+  }
+}
+
+// printRow() with room for errors of a few epsilon.
+void printError(const char *name, double value) {
+  std::printf("%-40s %12.3g |m|\n", name, value);
+}
+
+// Largest |m v - lambda v| and |u s v^T - m| elements over the matrices,
+// relative to the largest element of m.
+template <typename T>
+void errors(const char *type, const std::vector<Matrix3T<T>> &general,
+            const std::vector<Matrix3T<T>> &symmetric) {
+  char name[64];
+  for (const auto &accuracy : kAccuracies) {
+    double eigen_error = 0., svd_error = 0.;
+    for (std::size_t i = 0; i < general.size(); ++i) {
+      const Matrix3 m = symmetric[i].template cast<double>();
+      const SymmetricEigenT<T> eigen =
+          symmetricEigen(symmetric[i], accuracy.accuracy);
+      double scale = 0., error = 0.;
+      for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+          scale = std::max(scale, std::abs(m(r, c)));
+        }
+      }
+      for (int k = 0; k < 3; ++k) {
+        const Vector3 vector = eigen.vectors.col(k).template cast<double>();
+        const Vector3 residual =
+            m.product(vector) - vector * double(eigen.values[k]);
+        for (int r = 0; r < 3; ++r) {
+          error = std::max(error, std::abs(residual[r]));
+        }
+      }
+      eigen_error = std::max(eigen_error, error / scale);
+
+      const Matrix3 g = general[i].template cast<double>();
+      const SvdT<T> decomposition = svd(general[i], accuracy.accuracy);
+      Matrix3 sigma;
+      for (int k = 0; k < 3; ++k) {
+        sigma[k][k] = decomposition.singular_values[k];
+      }
+      const Matrix3 product =
+          decomposition.u.template cast<double>()
+              .product(sigma)
+              .product(decomposition.v.template cast<double>().transpose());
+      scale = 0.;
+      error = 0.;
+      for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+          scale = std::max(scale, std::abs(g(r, c)));
+          error = std::max(error, std::abs(product(r, c) - g(r, c)));
+        }
+      }
+      svd_error = std::max(svd_error, error / scale);
+    }
+    std::snprintf(name, sizeof(name), "eigen residual %s %s", type,
+                  accuracy.name);
+    printError(name, eigen_error);
+    std::snprintf(name, sizeof(name), "svd error %s %s", type,
+                  accuracy.name);
+    printError(name, svd_error);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  std::vector<Matrix3> general, symmetric;
+  std::vector<Matrix3f> generalf, symmetricf;
+  randomMatrices(count, general, symmetric);
+  randomMatrices(count, generalf, symmetricf);
+
+  std::printf("%zu matrices, %s backend\n", count,
+              kernels::backendName(kernels::activeBackend()));
+  run("double", general, symmetric);
+  run("float", generalf, symmetricf);
+  errors("double", general, symmetric);
+  errors("float", generalf, symmetricf);
+  return 0;
+}
@@ -0,0 +1,101 @@
+// Compares expression-template evaluation of typical 5 and 10 term Vector3
+// expressions with the same arithmetic hand-written per coordinate.
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include "benchmark.h"
+#include "isometry.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const std::size_t kSize{4096};
+const int kRepetitions{200};
+
+struct Inputs {
+  std::vector<Vector3> a, b, c, d, e;
+  double s{1.25}, t{-0.5};
+};
+
+Inputs makeInputs() {
+  Inputs in;
+  for (std::size_t i = 0; i < kSize; ++i) {
+    const double v = 1. + i * 1e-3;
+    in.a.push_back(Vector3(v, 2. * v, 3. * v));
+    in.b.push_back(Vector3(-v, v, 0.5 * v));
+    in.c.push_back(Vector3(v + 1., v + 2., v + 3.));
+    in.d.push_back(Vector3(0.1 * v, -0.2 * v, 0.3 * v));
+    in.e.push_back(Vector3(3., -v, v * v));
+  }
+  return in;
+}
+
+void fiveTermsFused(const Inputs &in, std::vector<Vector3> &out) {
+  for (std::size_t i = 0; i < kSize; ++i) {
+    out[i] = (in.a[i] + in.b[i]) * in.s - in.c[i] * in.d[i] + in.e[i];
+  }
+}
+
+void fiveTermsByHand(const Inputs &in, std::vector<Vector3> &out) {
+  for (std::size_t i = 0; i < kSize; ++i) {
+    const Vector3 &a = in.a[i], &b = in.b[i], &c = in.c[i], &d = in.d[i],
+                  &e = in.e[i];
+    out[i].x() = (a.x() + b.x()) * in.s - c.x() * d.x() + e.x();
+    out[i].y() = (a.y() + b.y()) * in.s - c.y() * d.y() + e.y();
+    out[i].z() = (a.z() + b.z()) * in.s - c.z() * d.z() + e.z();
+  }
+}
+
+void tenTermsFused(const Inputs &in, std::vector<Vector3> &out) {
+  for (std::size_t i = 0; i < kSize; ++i) {
+    out[i] = (in.a[i] + in.b[i]) * in.s - in.c[i] * in.d[i] + in.e[i] +
+             (in.a[i] - in.e[i]) * in.t + in.b[i] / in.c[i] - in.d[i] * 2. +
+             in.a[i] * in.e[i] - in.c[i];
+  }
+}
+
+void tenTermsByHand(const Inputs &in, std::vector<Vector3> &out) {
+  for (std::size_t i = 0; i < kSize; ++i) {
+    const Vector3 &a = in.a[i], &b = in.b[i], &c = in.c[i], &d = in.d[i],
+                  &e = in.e[i];
+    for (int k = 0; k < 3; ++k) {
+      out[i][k] = (a[k] + b[k]) * in.s - c[k] * d[k] + e[k] +
+                  (a[k] - e[k]) * in.t + b[k] / c[k] - d[k] * 2. +
+                  a[k] * e[k] - c[k];
+    }
+  }
+}
+
+template <typename Fn>
+double nanosecondsPerExpression(Fn fn, const Inputs &in,
+                                std::vector<Vector3> &out) {
+  const double seconds = bestOf(kRepetitions, [&]() {
+    fn(in, out);
+    doNotOptimize(out.data());
+  });
+  return seconds * 1e9 / kSize;
+}
+
+} // namespace
+
+int main() {
+  const Inputs in = makeInputs();
+  std::vector<Vector3> out(kSize);
+  const double five_fused = nanosecondsPerExpression(fiveTermsFused, in, out);
+  const double five_hand = nanosecondsPerExpression(fiveTermsByHand, in, out);
+  const double ten_fused = nanosecondsPerExpression(tenTermsFused, in, out);
+  const double ten_hand = nanosecondsPerExpression(tenTermsByHand, in, out);
+  printRow("5 terms, expression templates", five_fused, "ns/expr");
+  printRow("5 terms, hand-written", five_hand, "ns/expr");
+  printRow("10 terms, expression templates", ten_fused, "ns/expr");
+  printRow("10 terms, hand-written", ten_hand, "ns/expr");
+  printRow("5 terms, fused / hand-written", five_fused / five_hand, "x");
+  printRow("10 terms, fused / hand-written", ten_fused / ten_hand, "x");
+  return 0;
+}
@@ -0,0 +1,148 @@
+// Per-operation latency of the Vector3, Matrix3 and Isometry hot path. Each
+// loop feeds its result into the next iteration, so the numbers are latencies
+// rather than throughputs. Build once with -DCPPCOURSE_ISOMETRY_HEADER_ONLY=ON
+// and once without (optionally with -DCPPCOURSE_ENABLE_LTO=ON) to compare.
+
+#include <cstddef>
+#include <cstdio>
+
+#include "benchmark.h"
+#include "isometry.h"
+#include "quaternion.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const std::size_t kIterations{1 << 20};
+const int kRepetitions{20};
+
+// Read through a volatile so the compiler cannot fold the inputs.
+volatile double g_seed{1e-3};
+
+template <typename Fn> void run(const char *name, Fn fn) {
+  const double seconds = bestOf(kRepetitions, fn);
+  printRow(name, seconds * 1e9 / kIterations, "ns/op");
+}
+
+} // namespace
+
+int main() {
+  const double seed = g_seed;
+  const Vector3 w{seed, 2. * seed, 3. * seed};
+  const Isometry step = Isometry::FromTranslation(w) *
+                        Isometry::RotateAround(Vector3::kUnitZ, seed);
+  const Matrix3 m = step.rotation();
+
+#ifdef CPPCOURSE_ISOMETRY_HEADER_ONLY
+  std::printf("isometry build: header-only\n");
+#else
+  std::printf("isometry build: compiled library\n");
+#endif
+
+  run("Vector3::operator[]", [&]() {
+    Vector3 v{w};
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      v[static_cast<int>(i % 3)] += v[static_cast<int>((i + 1) % 3)];
+    }
+    doNotOptimize(v);
+  });
+  run("Vector3::operator+", [&]() {
+    Vector3 v{w};
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      v = v + w;
+    }
+    doNotOptimize(v);
+  });
+  run("Vector3::dot", [&]() {
+    Vector3 v{w};
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      v.x() = v.dot(w);
+    }
+    doNotOptimize(v);
+  });
+  run("Matrix3::product(Vector3)", [&]() {
+    Vector3 v{w};
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      v = m.product(v);
+    }
+    doNotOptimize(v);
+  });
+  run("Matrix3::product(Matrix3)", [&]() {
+    Matrix3 r{m};
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      r = r.product(m);
+    }
+    doNotOptimize(r);
+  });
+  run("Matrix3::det", [&]() {
+    Matrix3 r{m};
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      r[0][0] = r.det();
+    }
+    doNotOptimize(r);
+  });
+  run("Isometry * Vector3", [&]() {
+    Vector3 v{w};
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      v = step * v;
+    }
+    doNotOptimize(v);
+  });
+  run("Isometry * Isometry", [&]() {
+    Isometry pose;
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      pose = pose * step;
+    }
+    doNotOptimize(pose);
+  });
+  run("IsometryQ * IsometryQ", [&]() {
+    const IsometryQ step_q(step);
+    IsometryQ pose;
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      pose = pose * step_q;
+    }
+    doNotOptimize(pose);
+  });
+  run("Isometry::inverse", [&]() {
+    Isometry pose{step};
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      pose = pose.inverse();
+    }
+    doNotOptimize(pose);
+  });
+  run("Isometry::inverseGeneral", [&]() {
+    Isometry pose{step};
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      pose = pose.inverseGeneral();
+    }
+    doNotOptimize(pose);
+  });
+  run("Isometry::RotateAround", [&]() {
+    double angle = seed;
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      angle = Isometry::RotateAround(Vector3::kUnitZ, angle).rotation()[1][0];
+    }
+    doNotOptimize(angle);
+  });
+  run("Isometry::FromEulerAngles", [&]() {
+    double angle = seed;
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      angle = Isometry::FromEulerAngles(angle, 0.5, 0.25).rotation()[1][0];
+    }
+    doNotOptimize(angle);
+  });
+  run("euler::fromRotation", [&]() {
+    Matrix3 rotation = m;
+    for (std::size_t i = 0; i < kIterations; ++i) {
+      const Vector3 angles =
+          euler::fromRotation(rotation, EulerConvention::kZYX);
+      rotation[0][0] = angles.x();
+    }
+    doNotOptimize(rotation);
+  });
+  return 0;
+}
@@ -0,0 +1,126 @@
+// KD-tree build and query throughput over uniformly random clouds of
+// increasing size: build on one thread and on the global pool, then 1-NN,
+// 8-NN and radius queries one at a time and in batches on the pool. The
+// queries are as many random points in the same box, at most 1M of them, so
+// large trees do not take minutes.
+//
+// Usage: kd_tree_BENCH [points...] (100k 1M 5M)
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "benchmark.h"
+#include "kd_tree.h"
+#include "thread_pool.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const int kRepetitions{3};
+const std::size_t kMaxQueries{1000000};
+// About 8 neighbors per radius query at 1M points in the 100 m box below.
+const double kRadiusAt1M{1.25};
+
+template <typename T>
+PointCloud3T<T> randomCloud(std::size_t count, unsigned seed) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> coordinate(-50., 50.);
+  PointCloud3T<T> cloud(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    cloud.set(i, Vector3(coordinate(generator), coordinate(generator),
+                         coordinate(generator))
+                     .cast<T>());
+  }
+  return cloud;
+}
+
+template <typename T> void run(const char *type, std::size_t count) {
+  const PointCloud3T<T> cloud = randomCloud<T>(count, 1);
+  const PointCloud3T<T> queries =
+      randomCloud<T>(std::min(count, kMaxQueries), 2);
+  ThreadPool &pool = ThreadPool::global();
+  char name[64];
+
+  double seconds = bestOf(kRepetitions, [&]() {
+    doNotOptimize(KdTreeT<T>(cloud.view()).size());
+  });
+  std::snprintf(name, sizeof(name), "build %s %zu", type, count);
+  printRow(name, count * 1e-6 / seconds, "M points/s");
+  seconds = bestOf(kRepetitions, [&]() {
+    doNotOptimize(KdTreeT<T>(cloud.view(), pool).size());
+  });
+  std::snprintf(name, sizeof(name), "  on the pool");
+  printRow(name, count * 1e-6 / seconds, "M points/s");
+
+  const KdTreeT<T> tree(cloud.view(), pool);
+  const std::size_t n = queries.size();
+  std::vector<NeighborT<T>> neighbors(8);
+  std::vector<std::size_t> offsets;
+  // Same density of neighbors at every size.
+  const T radius = static_cast<T>(kRadiusAt1M * std::cbrt(1e6 / count));
+
+  seconds = bestOf(kRepetitions, [&]() {
+    for (std::size_t i = 0; i < n; ++i) {
+      doNotOptimize(tree.nearest(queries[i]));
+    }
+  });
+  std::snprintf(name, sizeof(name), "  1-NN");
+  printRow(name, n * 1e-6 / seconds, "M queries/s");
+  seconds = bestOf(kRepetitions, [&]() {
+    for (std::size_t i = 0; i < n; ++i) {
+      doNotOptimize(tree.nearest(queries[i], 8, neighbors.data()));
+    }
+  });
+  std::snprintf(name, sizeof(name), "  8-NN");
+  printRow(name, n * 1e-6 / seconds, "M queries/s");
+  seconds = bestOf(kRepetitions, [&]() {
+    tree.nearest(queries.view(), 8, neighbors, pool);
+    doNotOptimize(neighbors.back());
+  });
+  std::snprintf(name, sizeof(name), "  8-NN batch on the pool");
+  printRow(name, n * 1e-6 / seconds, "M queries/s");
+  seconds = bestOf(kRepetitions, [&]() {
+    for (std::size_t i = 0; i < n; ++i) {
+      tree.radiusSearch(queries[i], radius, neighbors);
+      doNotOptimize(neighbors.size());
+    }
+  });
+  std::snprintf(name, sizeof(name), "  radius");
+  printRow(name, n * 1e-6 / seconds, "M queries/s");
+  seconds = bestOf(kRepetitions, [&]() {
+    tree.radiusSearch(queries.view(), radius, offsets, neighbors, pool);
+    doNotOptimize(offsets.back());
+  });
+  std::snprintf(name, sizeof(name), "  radius batch on the pool");
+  printRow(name, n * 1e-6 / seconds, "M queries/s");
+  std::snprintf(name, sizeof(name), "  neighbors per radius query");
+  printRow(name, double(offsets.back()) / n, "");
+  std::snprintf(name, sizeof(name), "  memory");
+  printRow(name, double(tree.memoryBytes()) / count, "B/point");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::vector<std::size_t> counts;
+  for (int i = 1; i < argc; ++i) {
+    counts.push_back(std::strtoul(argv[i], nullptr, 10));
+  }
+  if (counts.empty()) {
+    counts = {100000, 1000000, 5000000};
+  }
+  std::printf("%zu threads\n", ThreadPool::global().threads());
+  for (const std::size_t count : counts) {
+    run<double>("double", count);
+    run<float>("float", count);
+  }
+  return 0;
+}
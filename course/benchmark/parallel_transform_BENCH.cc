@@ -0,0 +1,76 @@
+// Strong scaling of the pooled point cloud transform: the same cloud
+// transformed with 1..N threads, against the serial kernel.
+//
+// Usage: parallel_transform_BENCH [max threads (hardware concurrency)]
+//                                 [points (4M)]
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "benchmark.h"
+#include "isometry.h"
+#include "point_cloud.h"
+#include "thread_pool.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const int kRepetitions{10};
+
+PointCloud3 makeCloud(std::size_t points) {
+  PointCloud3 cloud;
+  cloud.resize(points);
+  for (std::size_t i = 0; i < points; ++i) {
+    cloud.x()[i] = std::sin(0.001 * i);
+    cloud.y()[i] = std::cos(0.002 * i);
+    cloud.z()[i] = 0.0001 * i;
+  }
+  return cloud;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t max_threads =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+               : std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t points =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::size_t{1} << 22;
+
+  const Isometry pose = Isometry::FromTranslation({1., -2., 3.}) *
+                        Isometry::FromEulerAngles(0.3, -0.2, 0.1);
+  const PointCloud3 in = makeCloud(points);
+  PointCloud3 out;
+  pose.transform(in, out);
+  // Three coordinates read and three written per point.
+  const double bytes = 6. * sizeof(double) * points;
+
+  std::printf("%zu points, up to %zu threads\n", points, max_threads);
+  const double serial = bestOf(kRepetitions, [&]() {
+    pose.transform(in, out);
+    doNotOptimize(out.x()[0]);
+  });
+  printRow("serial", serial * 1e3, "ms");
+  printRow("serial", bytes / serial * 1e-9, "GB/s");
+  for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+    ThreadPool pool(threads);
+    const double seconds = bestOf(kRepetitions, [&]() {
+      pose.transform(in, out, pool);
+      doNotOptimize(out.x()[0]);
+    });
+    const std::string name = "pool, " + std::to_string(threads) + " threads";
+    printRow(name.c_str(), seconds * 1e3, "ms");
+    printRow(name.c_str(), bytes / seconds * 1e-9, "GB/s");
+    printRow(name.c_str(), serial / seconds, "x speedup");
+  }
+  return 0;
+}
@@ -0,0 +1,120 @@
+// Loading a binary PLY scan with interleaved x, y, z and intensity floats:
+// a naive ifstream parser into std::vector<Vector3f> against the mapped
+// reader, both followed by a transform. Throughput counts the point payload
+// and assumes the file is in the page cache (it was just written).
+//
+// Usage: point_file_BENCH [points (10M)] [directory (/tmp)]
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "point_file.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const int kRepetitions{3};
+const std::size_t kStride{4 * sizeof(float)};
+
+void writeScan(const std::string &path, std::size_t count) {
+  std::ofstream out(path, std::ios::binary);
+  out << "ply\nformat binary_little_endian 1.0\nelement vertex " << count
+      << "\nproperty float x\nproperty float y\nproperty float z\n"
+         "property float intensity\nend_header\n";
+  std::vector<float> records;
+  for (std::size_t i = 0; i < count; ++i) {
+    records.insert(records.end(), {0.001f * i, 1.f, -0.002f * i, 0.5f});
+    if (records.size() == 4 * 4096 || i + 1 == count) {
+      out.write(reinterpret_cast<const char *>(records.data()),
+                records.size() * sizeof(float));
+      records.clear();
+    }
+  }
+}
+
+// What loading looked like before: header lines, then one record at a time.
+std::vector<Vector3f> parseNaively(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  std::string line;
+  std::size_t count = 0;
+  while (std::getline(in, line) && line != "end_header") {
+    if (line.compare(0, 15, "element vertex ") == 0) {
+      count = std::strtoul(line.c_str() + 15, nullptr, 10);
+    }
+  }
+  std::vector<Vector3f> points;
+  points.reserve(count);
+  char record[kStride];
+  for (std::size_t i = 0; i < count && in.read(record, kStride); ++i) {
+    float xyz[3];
+    std::memcpy(xyz, record, sizeof(xyz));
+    points.emplace_back(xyz[0], xyz[1], xyz[2]);
+  }
+  return points;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+  const std::string directory = argc > 2 ? argv[2] : "/tmp";
+  const std::string path = directory + "/point_file_BENCH.ply";
+  writeScan(path, count);
+  const double gigabytes = count * kStride * 1e-9;
+  std::printf("%zu points, %.1f MiB payload\n", count,
+              count * kStride / 1048576.);
+
+  const Isometryf pose = Isometryf::FromTranslation({1.f, 2.f, 3.f}) *
+                         Isometryf::FromEulerAngles(0.1f, 0.2f, 0.3f);
+  PointCloud3f out;
+  const double naive = bestOf(kRepetitions, [&]() {
+    doNotOptimize(parseNaively(path).back());
+  });
+  printRow("naive ifstream parse", gigabytes / naive, "GB/s");
+  const double naive_transform = bestOf(kRepetitions, [&]() {
+    const PointCloud3f cloud(parseNaively(path));
+    pose.transform(cloud, out);
+    doNotOptimize(out.x()[0]);
+  });
+  printRow("naive parse + transform", gigabytes / naive_transform, "GB/s");
+  const double mapped = bestOf(kRepetitions, [&]() {
+    const MappedPointFile file(path);
+    const PointView3f points = file.points<float>();
+    float sum = 0.f;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      sum += points.x[i];
+    }
+    doNotOptimize(sum);
+  });
+  printRow("map + read x", gigabytes / mapped, "GB/s");
+  const double mapped_transform = bestOf(kRepetitions, [&]() {
+    const MappedPointFile file(path);
+    pose.transform(file.points<float>(), out);
+    doNotOptimize(out.x()[0]);
+  });
+  printRow("map + transform", gigabytes / mapped_transform, "GB/s");
+  printRow("speedup, with transform", naive_transform / mapped_transform,
+           "x");
+
+  const PointCloud3f cloud = out;
+  const double written = bestOf(kRepetitions, [&]() {
+    PointFileWriter<float> writer(path, PointFileFormat::kPly);
+    writer.write(cloud.view());
+    writer.close();
+  });
+  printRow("streaming writer", count * 3 * sizeof(float) * 1e-9 / written,
+           "GB/s");
+  std::remove(path.c_str());
+  return 0;
+}
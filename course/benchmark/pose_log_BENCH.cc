@@ -0,0 +1,112 @@
+// Pose log size and speed on a 100 Hz trajectory of a vehicle driving at
+// about 1 m/s, with the default options (0.1 mm translation step, 16-bit
+// quaternion components, 1024-pose chunks). Poses are generated and encoded
+// a batch at a time; decoding goes a chunk at a time into a buffer that
+// stays in cache, the way a consumer would stream the log.
+//
+// Usage: pose_log_BENCH [poses (10M)]
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "benchmark.h"
+#include "pose_log.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const int kRepetitions{3};
+const std::size_t kBatch{4096};
+
+template <typename T> IsometryT<T> poseAt(std::size_t i) {
+  const double t = 0.01 * i;
+  return (Isometry::FromTranslation(
+              {20. * std::sin(0.05 * t), 15. * std::cos(0.03 * t), 0.1 * t}) *
+          Isometry::FromEulerAngles(0.02 * std::sin(2. * t),
+                                    0.01 * std::cos(3. * t), 0.05 * t))
+      .template cast<T>();
+}
+
+template <typename T>
+double decodeAll(const PoseLogDecoder &decoder, std::size_t count) {
+  const std::size_t chunk = decoder.options().chunk_size;
+  std::vector<IsometryT<T>> poses(chunk);
+  return bestOf(kRepetitions, [&]() {
+    for (std::size_t first = 0; first < count; first += chunk) {
+      const std::size_t size = std::min(chunk, count - first);
+      decoder.decode(first, size, poses.data());
+      doNotOptimize(poses[size - 1]);
+    }
+  });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+
+  PoseLogEncoder encoder;
+  std::vector<Isometry> batch(kBatch);
+  double encoding = 0.;
+  for (std::size_t first = 0; first < count; first += kBatch) {
+    const std::size_t size = std::min(kBatch, count - first);
+    for (std::size_t i = 0; i < size; ++i) {
+      batch[i] = poseAt<double>(first + i);
+    }
+    encoding += bestOf(1, [&]() { encoder.append(batch.data(), size); });
+  }
+  const std::vector<std::uint8_t> log = encoder.finish();
+  const PoseLogDecoder decoder(log);
+
+  std::printf("%zu poses, log %.1f MiB\n", count, log.size() / 1048576.);
+  printRow("bytes per pose", double(log.size()) / count, "B");
+  printRow("size reduction vs 12 doubles",
+           double(count * sizeof(Isometry)) / log.size(), "x");
+  printRow("encode", encoding * 1e9 / count, "ns/pose");
+  const double decoding = decodeAll<double>(decoder, count);
+  printRow("decode to Isometry", count * 1e-6 / decoding, "Mposes/s");
+  const double decodingf = decodeAll<float>(decoder, count);
+  printRow("decode to Isometryf", count * 1e-6 / decodingf, "Mposes/s");
+  const double random_access = bestOf(kRepetitions, [&]() {
+    std::size_t index = 12345;
+    for (int i = 0; i < 10000; ++i) {
+      index = (index * 2654435761u + 1) % count;
+      doNotOptimize(decoder.at<double>(index));
+    }
+  });
+  printRow("random access at()", random_access * 1e9 / 10000, "ns/pose");
+
+  double max_translation = 0.;
+  double max_rotation = 0.;
+  const std::size_t stride = std::max<std::size_t>(count / 100000, 1);
+  for (std::size_t i = 0; i < count; i += stride) {
+    const Isometry original = poseAt<double>(i);
+    const Isometry decoded = decoder.at<double>(i);
+    for (int k = 0; k < 3; ++k) {
+      max_translation =
+          std::max(max_translation, std::abs(original.translation()[k] -
+                                             decoded.translation()[k]));
+    }
+    double trace = 0.;
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        trace += original.rotation()(r, c) * decoded.rotation()(r, c);
+      }
+    }
+    max_rotation = std::max(
+        max_rotation, std::acos(std::min(1., std::max(-1., (trace - 1) / 2))));
+  }
+  printRow("max translation error", max_translation * 1e3, "mm");
+  printRow("max rotation error", max_rotation * 1e6, "urad");
+  return 0;
+}
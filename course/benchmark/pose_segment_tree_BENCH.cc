@@ -0,0 +1,95 @@
+// PoseSegmentTree over a long odometry sequence: build time, memory, range
+// compositions against a linear fold, and point updates.
+//
+// Usage: pose_segment_tree_BENCH [increments (10M)]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "benchmark.h"
+#include "pose_segment_tree.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const std::size_t kQueries{1 << 16};
+// The linear fold takes milliseconds per long range; keep it to a few.
+const std::size_t kLinearQueries{16};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+
+  std::vector<Isometry> increments;
+  increments.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    increments.push_back(
+        Isometry::FromTranslation({0.01, 0.001 * std::sin(0.1 * i), 0.}) *
+        Isometry::FromEulerAngles(1e-3, 2e-3, 1e-2 * std::cos(0.01 * i)));
+  }
+  std::printf("%zu increments\n", count);
+
+  const auto start = std::chrono::steady_clock::now();
+  PoseSegmentTree tree(increments);
+  const std::chrono::duration<double> build =
+      std::chrono::steady_clock::now() - start;
+  printRow("build", build.count() * 1e3, "ms");
+  printRow("increments", count * sizeof(Isometry) / 1048576., "MiB");
+  printRow("tree, increments included", tree.memoryBytes() / 1048576., "MiB");
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<std::size_t> index(0, count);
+  std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  for (std::size_t i = 0; i < kQueries; ++i) {
+    std::size_t begin = index(generator), end = index(generator);
+    ranges.emplace_back(std::min(begin, end), std::max(begin, end));
+  }
+
+  printRow("compose, random range",
+           bestOf(5,
+                  [&]() {
+                    for (const auto &range : ranges) {
+                      doNotOptimize(tree.compose(range.first, range.second));
+                    }
+                  }) *
+               1e9 / kQueries,
+           "ns");
+  printRow("linear fold, random range",
+           bestOf(1,
+                  [&]() {
+                    for (std::size_t q = 0; q < kLinearQueries; ++q) {
+                      Isometry composed;
+                      for (std::size_t i = ranges[q].first;
+                           i < ranges[q].second; ++i) {
+                        composed = composed * increments[i];
+                      }
+                      doNotOptimize(composed);
+                    }
+                  }) *
+               1e9 / kLinearQueries,
+           "ns");
+  printRow("update",
+           bestOf(5,
+                  [&]() {
+                    for (std::size_t i = 0; i < kQueries; ++i) {
+                      const std::size_t k = ranges[i].first % count;
+                      tree.update(k, increments[k]);
+                    }
+                  }) *
+               1e9 / kQueries,
+           "ns");
+  return 0;
+}
@@ -0,0 +1,109 @@
+// Time to estimate a rigid transform from matched point pairs, as every ICP
+// iteration or RANSAC hypothesis does, with and without weights and from
+// contiguous and interleaved (strided) coordinates. The pairs run on the
+// backend picked by kernels::activeBackend(); set
+// CPPCOURSE_SIMD_BACKEND=scalar to compare with the plain C++ loop.
+//
+// Usage: registration_BENCH [pairs (100k)]
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "benchmark.h"
+#include "registration.h"
+#include "transform_kernels.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const int kRepetitions{20};
+
+// Noisy pairs related by a fixed pose, and per-pair weights.
+template <typename T>
+void randomPairs(std::size_t count, PointCloud3T<T> &source,
+                 PointCloud3T<T> &target, std::vector<T> &weights) {
+  std::mt19937 generator(13);
+  std::uniform_real_distribution<double> coordinate(-20., 20.);
+  std::normal_distribution<double> noise(0., 0.02);
+  std::uniform_real_distribution<double> weight(0., 1.);
+  const Isometry pose = Isometry::FromTranslation({0.5, -0.3, 0.1}) *
+                        Isometry::FromEulerAngles(0.02, -0.01, 0.1);
+  for (std::size_t i = 0; i < count; ++i) {
+    const Vector3 point(coordinate(generator), coordinate(generator),
+                        coordinate(generator));
+    const Vector3 moved = pose * point;
+    source.push_back(point.cast<T>());
+    target.push_back(Vector3(moved[0] + noise(generator),
+                             moved[1] + noise(generator),
+                             moved[2] + noise(generator))
+                         .cast<T>());
+    weights.push_back(static_cast<T>(weight(generator)));
+  }
+}
+
+// The same coordinates as x, y, z records.
+template <typename T>
+PointView3T<T> interleave(const PointCloud3T<T> &cloud,
+                          std::vector<T> &records) {
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    for (int k = 0; k < 3; ++k) {
+      records.push_back(cloud[i][k]);
+    }
+  }
+  const std::size_t stride = 3 * sizeof(T);
+  return PointView3T<T>{StridedSpan<T>(&records[0], cloud.size(), stride),
+                        StridedSpan<T>(&records[1], cloud.size(), stride),
+                        StridedSpan<T>(&records[2], cloud.size(), stride)};
+}
+
+template <typename T> void run(const char *type, std::size_t count) {
+  PointCloud3T<T> source, target;
+  std::vector<T> weights;
+  randomPairs(count, source, target, weights);
+  std::vector<T> source_records, target_records;
+  const PointView3T<T> source_strided = interleave(source, source_records);
+  const PointView3T<T> target_strided = interleave(target, target_records);
+
+  const struct {
+    const char *name;
+    PointView3T<T> source, target;
+    const T *weights;
+  } cases[] = {
+      {"contiguous", source.view(), target.view(), nullptr},
+      {"contiguous weighted", source.view(), target.view(), weights.data()},
+      {"strided", source_strided, target_strided, nullptr},
+      {"strided weighted", source_strided, target_strided, weights.data()},
+  };
+  char name[64];
+  for (const auto &c : cases) {
+    const double seconds = bestOf(kRepetitions, [&]() {
+      doNotOptimize(c.weights
+                        ? estimateRigidTransform(c.source, c.target, c.weights)
+                        : estimateRigidTransform(c.source, c.target));
+    });
+    std::snprintf(name, sizeof(name), "estimateRigidTransform %s %s", type,
+                  c.name);
+    printRow(name, seconds * 1e6, "us");
+    std::snprintf(name, sizeof(name), "  pairs");
+    printRow(name, count * 1e-6 / seconds, "M/s");
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  std::printf("%zu pairs, %s backend\n", count,
+              kernels::backendName(kernels::activeBackend()));
+  run<double>("double", count);
+  run<float>("float", count);
+  return 0;
+}
@@ -0,0 +1,64 @@
+// Composed motion over the last K increments at every tick: the sliding
+// window composer against re-composing the K increments each time.
+//
+// Usage: sliding_window_BENCH [window (100)]
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#include "benchmark.h"
+#include "sliding_window.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const std::size_t kTicks{1 << 16};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t window =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100;
+
+  std::vector<Isometry> increments;
+  for (std::size_t i = 0; i < kTicks; ++i) {
+    increments.push_back(
+        Isometry::FromTranslation({0.01, 0.001 * std::sin(0.1 * i), 0.}) *
+        Isometry::FromEulerAngles(1e-3, 2e-3, 1e-2 * std::cos(0.01 * i)));
+  }
+
+  printRow("window", window, "increments");
+  printRow("sliding window, per tick",
+           bestOf(5,
+                  [&]() {
+                    SlidingWindowComposer composer(window);
+                    for (const Isometry &increment : increments) {
+                      composer.push(increment);
+                      doNotOptimize(composer.windowComposition());
+                    }
+                  }) *
+               1e9 / kTicks,
+           "ns");
+  printRow("recomposition, per tick",
+           bestOf(5,
+                  [&]() {
+                    for (std::size_t tick = 0; tick < kTicks; ++tick) {
+                      Isometry composed;
+                      const std::size_t first =
+                          tick + 1 > window ? tick + 1 - window : 0;
+                      for (std::size_t i = first; i <= tick; ++i) {
+                        composed = composed * increments[i];
+                      }
+                      doNotOptimize(composed);
+                    }
+                  }) *
+               1e9 / kTicks,
+           "ns");
+  return 0;
+}
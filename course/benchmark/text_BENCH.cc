@@ -0,0 +1,106 @@
+// Text throughput for poses written as 12 numbers per line: iostreams with
+// round-trip precision against the to_chars/from_chars bulk calls. The
+// Isometry operator<< is timed too, though it prints only 9 digits.
+//
+// Usage: text_BENCH [poses (200k)]
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "text.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const int kRepetitions{3};
+
+void writeStream(std::ostream &out, const Isometry &pose) {
+  for (int i = 0; i < 3; ++i) {
+    out << pose.rotation()(i, 0) << ' ' << pose.rotation()(i, 1) << ' '
+        << pose.rotation()(i, 2) << ' ' << pose.translation()[i]
+        << (i < 2 ? ' ' : '\n');
+  }
+}
+
+Isometry readStream(std::istream &in) {
+  double v[12];
+  for (double &value : v) {
+    in >> value;
+  }
+  return Isometry(Vector3(v[3], v[7], v[11]),
+                  Matrix3{v[0], v[1], v[2], v[4], v[5], v[6], v[8], v[9],
+                          v[10]});
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  std::vector<Isometry> poses;
+  for (std::size_t i = 0; i < count; ++i) {
+    poses.push_back(Isometry::FromTranslation({0.01 * i, 1.5, -2.}) *
+                    Isometry::FromEulerAngles(1e-3 * i, 0.2, -0.3));
+  }
+
+  std::string stream_text;
+  const double stream_format = bestOf(kRepetitions, [&]() {
+    std::ostringstream out;
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (const Isometry &pose : poses) {
+      writeStream(out, pose);
+    }
+    stream_text = out.str();
+  });
+  const double printer = bestOf(kRepetitions, [&]() {
+    std::ostringstream out;
+    for (const Isometry &pose : poses) {
+      out << pose << '\n';
+    }
+    doNotOptimize(out.str().size());
+  });
+  std::vector<char> buffer(count * text::maxChars<Isometry>());
+  text::FormatResult formatted{};
+  const double fast_format = bestOf(kRepetitions, [&]() {
+    formatted = text::formatLines(buffer.data(), buffer.data() + buffer.size(),
+                                  poses.data(), poses.size());
+    doNotOptimize(formatted.ptr);
+  });
+  const double megabytes = (formatted.ptr - buffer.data()) * 1e-6;
+  std::printf("%zu poses, %.1f MB of text\n", count, megabytes);
+  printRow("format, operator<< (9 digits)", count / printer * 1e-6,
+           "M poses/s");
+  printRow("format, iostream", count / stream_format * 1e-6, "M poses/s");
+  printRow("format, to_chars", count / fast_format * 1e-6, "M poses/s");
+  printRow("format speedup", stream_format / fast_format, "x");
+
+  std::vector<Isometry> parsed(count);
+  const double stream_parse = bestOf(kRepetitions, [&]() {
+    std::istringstream in(stream_text);
+    for (std::size_t i = 0; i < count; ++i) {
+      parsed[i] = readStream(in);
+    }
+    doNotOptimize(parsed.back());
+  });
+  const double fast_parse = bestOf(kRepetitions, [&]() {
+    const text::ParseResult result = text::parseLines(
+        buffer.data(), formatted.ptr, parsed.data(), parsed.size());
+    doNotOptimize(result.count);
+  });
+  printRow("parse, iostream", count / stream_parse * 1e-6, "M poses/s");
+  printRow("parse, from_chars", count / fast_parse * 1e-6, "M poses/s");
+  printRow("parse speedup", stream_parse / fast_parse, "x");
+  return 0;
+}
@@ -0,0 +1,75 @@
+// Trajectory accumulation from odometry increments: serial prefix
+// composition against the blocked scan on 1..N threads, with and without
+// periodic re-orthonormalization.
+//
+// Usage: trajectory_BENCH [max threads (hardware concurrency)]
+//                         [increments (4M)]
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark.h"
+#include "trajectory.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const int kRepetitions{5};
+const std::size_t kReorthonormalizeEvery{256};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t max_threads =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+               : std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t count =
+      argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::size_t{1} << 22;
+
+  std::vector<Isometry> increments;
+  increments.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    increments.push_back(
+        Isometry::FromTranslation({0.01, 0.001 * std::sin(0.1 * i), 0.}) *
+        Isometry::FromEulerAngles(1e-3, 2e-3, 1e-2 * std::cos(0.01 * i)));
+  }
+  std::vector<Isometry> poses(count);
+
+  std::printf("%zu increments, up to %zu threads\n", count, max_threads);
+  const double serial = bestOf(kRepetitions, [&]() {
+    trajectory::inclusiveScan(increments.data(), poses.data(), count);
+    doNotOptimize(poses.back());
+  });
+  printRow("serial", serial * 1e3, "ms");
+  printRow("serial, reorthonormalized",
+           bestOf(kRepetitions,
+                  [&]() {
+                    trajectory::inclusiveScan(increments.data(), poses.data(),
+                                              count, Isometry(),
+                                              kReorthonormalizeEvery);
+                    doNotOptimize(poses.back());
+                  }) *
+               1e3,
+           "ms");
+  for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+    ThreadPool pool(threads);
+    const double seconds = bestOf(kRepetitions, [&]() {
+      trajectory::inclusiveScan(increments.data(), poses.data(), count, pool);
+      doNotOptimize(poses.back());
+    });
+    const std::string name = "blocked, " + std::to_string(threads) + " threads";
+    printRow(name.c_str(), seconds * 1e3, "ms");
+    printRow(name.c_str(), serial / seconds, "x speedup");
+  }
+  return 0;
+}
@@ -0,0 +1,127 @@
+// Reading KITTI and TUM trajectory files: a naive ifstream parser that
+// loads the whole trajectory into a std::vector<Isometry> against the
+// chunked reader, both summing the translations. Memory is what each one
+// holds on to, not counting the stream's own buffer. Files are in the page
+// cache (they were just written).
+//
+// Usage: trajectory_file_BENCH [poses (1M)] [directory (/tmp)]
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "quaternion.h"
+#include "trajectory_file.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const int kRepetitions{3};
+
+std::vector<Isometry> loadNaively(const std::string &path,
+                                  TrajectoryFormat format) {
+  std::ifstream in(path);
+  std::vector<Isometry> poses;
+  if (format == TrajectoryFormat::kKitti) {
+    double v[12];
+    while (in >> v[0] >> v[1] >> v[2] >> v[3] >> v[4] >> v[5] >> v[6] >>
+           v[7] >> v[8] >> v[9] >> v[10] >> v[11]) {
+      poses.emplace_back(Vector3(v[3], v[7], v[11]),
+                         Matrix3{v[0], v[1], v[2], v[4], v[5], v[6], v[8],
+                                 v[9], v[10]});
+    }
+  } else {
+    double stamp, v[7];
+    while (in >> stamp >> v[0] >> v[1] >> v[2] >> v[3] >> v[4] >> v[5] >>
+           v[6]) {
+      poses.emplace_back(
+          Vector3(v[0], v[1], v[2]),
+          Quaternion(v[6], v[3], v[4], v[5]).normalized().toRotation());
+    }
+  }
+  return poses;
+}
+
+void run(const char *name, const std::string &path, TrajectoryFormat format,
+         std::size_t count) {
+  std::ifstream size_probe(path, std::ios::binary | std::ios::ate);
+  const double megabytes = size_probe.tellg() * 1e-6;
+  std::printf("%s: %.1f MB\n", name, megabytes);
+
+  std::size_t naive_bytes = 0;
+  const double naive = bestOf(kRepetitions, [&]() {
+    const std::vector<Isometry> poses = loadNaively(path, format);
+    Vector3 sum;
+    for (const Isometry &pose : poses) {
+      sum = sum + pose.translation();
+    }
+    naive_bytes = poses.capacity() * sizeof(Isometry);
+    doNotOptimize(sum);
+  });
+  std::size_t reader_bytes = 0;
+  const double chunked = bestOf(kRepetitions, [&]() {
+    TrajectoryReader<double> reader(path, format);
+    Vector3 sum;
+    while (reader.next()) {
+      for (const Isometry &pose : reader.poses()) {
+        sum = sum + pose.translation();
+      }
+    }
+    reader_bytes = reader.memoryBytes();
+    doNotOptimize(sum);
+  });
+  printRow("  naive ifstream load", megabytes / naive, "MB/s");
+  printRow("  chunked reader", megabytes / chunked, "MB/s");
+  printRow("  chunked reader", chunked * 1e9 / count, "ns/pose");
+  printRow("  speedup", naive / chunked, "x");
+  printRow("  naive memory", naive_bytes / 1048576., "MiB");
+  printRow("  chunked reader memory", reader_bytes / 1048576., "MiB");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::size_t count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  const std::string directory = argc > 2 ? argv[2] : "/tmp";
+  const std::string kitti = directory + "/trajectory_file_BENCH.txt";
+  const std::string tum = directory + "/trajectory_file_BENCH.tum";
+
+  // Written a batch at a time, the way a long recording would be.
+  const std::size_t batch = 4096;
+  std::vector<Isometry> poses(batch);
+  std::vector<double> stamps(batch);
+  TrajectoryWriter<double> kitti_writer(kitti, TrajectoryFormat::kKitti);
+  TrajectoryWriter<double> tum_writer(tum, TrajectoryFormat::kTum);
+  const double written = bestOf(1, [&]() {
+    for (std::size_t first = 0; first < count; first += batch) {
+      const std::size_t size = std::min(batch, count - first);
+      for (std::size_t i = 0; i < size; ++i) {
+        const std::size_t n = first + i;
+        stamps[i] = 1305031102.175304 + 0.033 * n;
+        poses[i] = Isometry::FromTranslation({0.01 * n, 1.5, -2.}) *
+                   Isometry::FromEulerAngles(1e-3 * n, 0.2, -0.3);
+      }
+      kitti_writer.write(poses.data(), size);
+      tum_writer.write(stamps.data(), poses.data(), size);
+    }
+    kitti_writer.close();
+    tum_writer.close();
+  });
+  std::printf("%zu poses\n", count);
+  printRow("write both files", written * 1e9 / count, "ns/pose");
+
+  run("KITTI", kitti, TrajectoryFormat::kKitti, count);
+  run("TUM", tum, TrajectoryFormat::kTum, count);
+  std::remove(kitti.c_str());
+  std::remove(tum.c_str());
+  return 0;
+}
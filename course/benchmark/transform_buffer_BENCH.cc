@@ -0,0 +1,99 @@
+// TransformBuffer lookups against a std::map<double, Isometry> buffer
+// interpolating the same way: random queries, queries near the latest sample
+// and a sorted batch.
+
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "benchmark.h"
+#include "quaternion.h"
+#include "transform_buffer.h"
+
+using namespace cppcourse;
+using cppcourse::benchmark::bestOf;
+using cppcourse::benchmark::doNotOptimize;
+using cppcourse::benchmark::printRow;
+
+namespace {
+
+const std::size_t kSamples{1000};
+const std::size_t kQueries{1 << 14};
+const int kRepetitions{20};
+const double kPeriod{0.005};
+
+Isometry poseAt(double stamp) {
+  return Isometry::FromTranslation({stamp, 0.5 * stamp, 1.}) *
+         Isometry::RotateAround(Vector3::kUnitZ, 0.3 * stamp);
+}
+
+Isometry mapLookup(const std::map<double, Isometry> &buffer, double stamp) {
+  auto after = buffer.lower_bound(stamp);
+  if (after->first == stamp) {
+    return after->second;
+  }
+  const auto before = std::prev(after);
+  const double t = (stamp - before->first) / (after->first - before->first);
+  return IsometryQ(before->second)
+      .interpolate(IsometryQ(after->second), t)
+      .toIsometry();
+}
+
+template <typename Fn> double nanosecondsPerQuery(Fn fn) {
+  return bestOf(kRepetitions, fn) * 1e9 / kQueries;
+}
+
+} // namespace
+
+int main() {
+  TransformBuffer buffer(kSamples);
+  std::map<double, Isometry> map_buffer;
+  for (std::size_t i = 0; i < kSamples; ++i) {
+    buffer.insert(i * kPeriod, poseAt(i * kPeriod));
+    map_buffer.emplace(i * kPeriod, poseAt(i * kPeriod));
+  }
+  const double latest = (kSamples - 1) * kPeriod;
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> anywhere(0., latest);
+  std::uniform_real_distribution<double> recent(latest - kPeriod, latest);
+  std::vector<double> random_stamps, recent_stamps, sorted_stamps;
+  for (std::size_t i = 0; i < kQueries; ++i) {
+    random_stamps.push_back(anywhere(generator));
+    recent_stamps.push_back(recent(generator));
+    sorted_stamps.push_back(latest * i / kQueries);
+  }
+  std::vector<Isometry> poses(kQueries);
+
+  const auto buffer_loop = [&](const std::vector<double> &stamps) {
+    return nanosecondsPerQuery([&]() {
+      for (std::size_t i = 0; i < kQueries; ++i) {
+        poses[i] = buffer.lookup(stamps[i]);
+      }
+      doNotOptimize(poses.data());
+    });
+  };
+  const auto map_loop = [&](const std::vector<double> &stamps) {
+    return nanosecondsPerQuery([&]() {
+      for (std::size_t i = 0; i < kQueries; ++i) {
+        poses[i] = mapLookup(map_buffer, stamps[i]);
+      }
+      doNotOptimize(poses.data());
+    });
+  };
+
+  printRow("random, TransformBuffer", buffer_loop(random_stamps), "ns/query");
+  printRow("random, std::map", map_loop(random_stamps), "ns/query");
+  printRow("near latest, TransformBuffer", buffer_loop(recent_stamps),
+           "ns/query");
+  printRow("near latest, std::map", map_loop(recent_stamps), "ns/query");
+  printRow("sorted batch, TransformBuffer", nanosecondsPerQuery([&]() {
+             buffer.lookup(sorted_stamps.data(), poses.data(), kQueries);
+             doNotOptimize(poses.data());
+           }),
+           "ns/query");
+  printRow("sorted, std::map", map_loop(sorted_stamps), "ns/query");
+  return 0;
+}
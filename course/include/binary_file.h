@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "isometry.h"
+#include "mapped_file.h"
+#include "span.h"
+
+namespace cppcourse {
+
+// Binary array files of Vector3, Matrix3 or Isometry, float or double, that
+// load by memory-mapping instead of parsing.
+//
+// Layout, all integers little-endian:
+//   offset  0  char[8]   magic "CPPCARR\0"
+//           8  uint32    format version (kFormatVersion)
+//          12  uint32    ElementType
+//          16  uint32    scalar size in bytes (4 or 8)
+//          20  uint32    element size in bytes
+//          24  uint64    element count
+//          32  uint64    data offset, a multiple of kDataAlignment
+//          40  zeros up to the data offset
+// followed by the elements as packed little-endian IEEE-754 scalars in
+// memory order: x, y, z for vectors, row-major for matrices, and the
+// rotation followed by the translation for isometries.
+namespace binary {
+
+const std::uint32_t kFormatVersion{1};
+const std::size_t kHeaderSize{64};
+const std::size_t kDataAlignment{64};
+
+enum class ElementType : std::uint32_t {
+  kVector3f = 1,
+  kVector3d = 2,
+  kMatrix3f = 3,
+  kMatrix3d = 4,
+  kIsometryf = 5,
+  kIsometryd = 6,
+};
+
+template <typename Element> struct ElementTraits;
+#define CPPCOURSE_BINARY_ELEMENT(Type, Scalar, Value)                          \
+  template <> struct ElementTraits<Type> {                                     \
+    static constexpr ElementType kType = ElementType::Value;                   \
+    static constexpr std::size_t kScalars = sizeof(Type) / sizeof(Scalar);     \
+    typedef Scalar ScalarType;                                                 \
+  }
+CPPCOURSE_BINARY_ELEMENT(Vector3f, float, kVector3f);
+CPPCOURSE_BINARY_ELEMENT(Vector3, double, kVector3d);
+CPPCOURSE_BINARY_ELEMENT(Matrix3f, float, kMatrix3f);
+CPPCOURSE_BINARY_ELEMENT(Matrix3, double, kMatrix3d);
+CPPCOURSE_BINARY_ELEMENT(Isometryf, float, kIsometryf);
+CPPCOURSE_BINARY_ELEMENT(Isometry, double, kIsometryd);
+#undef CPPCOURSE_BINARY_ELEMENT
+
+// The elements are mapped in place, so they must be exactly their scalars.
+static_assert(sizeof(Vector3) == 3 * sizeof(double), "Vector3 is padded.");
+static_assert(sizeof(Matrix3) == 9 * sizeof(double), "Matrix3 is padded.");
+static_assert(sizeof(Isometry) == 12 * sizeof(double), "Isometry is padded.");
+static_assert(sizeof(Isometryf) == 12 * sizeof(float), "Isometryf is padded.");
+
+// Writes a complete file to `out`. Throws std::runtime_error if the stream
+// fails.
+template <typename Element>
+void writeArray(std::ostream &out, const Element *data, std::size_t count);
+// Same, creating or truncating the file at `path`.
+template <typename Element>
+void writeArray(const std::string &path, const Element *data,
+                std::size_t count);
+template <typename Element>
+void writeArray(const std::string &path, const std::vector<Element> &data) {
+  writeArray(path, data.data(), data.size());
+}
+
+// Read-only memory mapping of an array file. Opening only reads the header;
+// pages of the data are loaded when first touched, so the cost does not
+// grow with the file size. Spans from view() are valid while the
+// MappedArrayFile lives.
+class MappedArrayFile {
+public:
+  // Throws std::runtime_error if the file cannot be opened or mapped and
+  // std::invalid_argument if it is not a valid array file of a version up
+  // to kFormatVersion.
+  explicit MappedArrayFile(const std::string &path);
+
+  std::uint32_t version() const { return version_; }
+  ElementType elementType() const { return type_; }
+  std::size_t size() const { return count_; }
+
+  // The elements, without copying. Throws std::invalid_argument unless the
+  // file holds `Element`s.
+  template <typename Element> Span<const Element> view() const {
+    if (ElementTraits<Element>::kType != type_) {
+      throw std::invalid_argument("Array file holds another element type.");
+    }
+    return Span<const Element>(
+        reinterpret_cast<const Element *>(file_.data() + data_offset_),
+        count_);
+  }
+
+private:
+  MappedFile file_;
+  std::uint32_t version_{};
+  ElementType type_{};
+  std::size_t count_{};
+  std::size_t data_offset_{};
+};
+
+} // namespace binary
+
+} // namespace cppcourse
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "isometry.h"
+#include "point_cloud.h"
+
+namespace cppcourse {
+
+// Eigendecomposition of symmetric 3x3 matrices and singular value
+// decomposition of general ones, e.g. for normal estimation, PCA or point
+// set registration. Both run a fixed number of cyclic Jacobi sweeps with
+// no data-dependent branches, so the batch versions below decompose several
+// matrices per SIMD register. Instantiated for float and double in
+// decomposition.cc. Matrices must be finite.
+//
+// The accuracy picks the number of sweeps. With |m| the largest absolute
+// element of the matrix:
+// - kFast runs three. On a million random matrices (decomposition_BENCH)
+//   eigenvector residuals |m v - lambda v| and SVD reconstruction errors
+//   stay below about 2e-5 |m|; the tests allow 1e-4 |m|. Plenty for e.g.
+//   surface normals.
+// - kAccurate runs four, which takes matrices to rounding error:
+//   residuals of a few epsilon |m|.
+enum class DecompositionAccuracy { kFast, kAccurate };
+
+template <typename T> struct SymmetricEigenT {
+  typedef T Scalar;
+
+  // In ascending order.
+  Vector3T<T> values;
+  // Rotation whose column i is the unit eigenvector of values[i].
+  Matrix3T<T> vectors;
+};
+
+// m == u * diag(singular_values) * v^T with u and v rotations. Singular
+// values are sorted by decreasing magnitude and only the last one can be
+// negative, when det(m) < 0; u * v^T is then always the rotation nearest
+// to m, as the Kabsch algorithm needs. Each singular value is accurate to a
+// few epsilon |m|, so small ones lose relative accuracy.
+template <typename T> struct SvdT {
+  typedef T Scalar;
+
+  Matrix3T<T> u;
+  Vector3T<T> singular_values;
+  Matrix3T<T> v;
+};
+
+typedef SymmetricEigenT<double> SymmetricEigen;
+typedef SymmetricEigenT<float> SymmetricEigenf;
+typedef SvdT<double> Svd;
+typedef SvdT<float> Svdf;
+
+// Structure-of-arrays container of 3x3 matrices: element (row, col) of
+// every matrix lives in its own contiguous array, so batch routines load
+// the same element of consecutive matrices into one register.
+template <typename T> class Matrix3ArrayT {
+public:
+  typedef T Scalar;
+
+  Matrix3ArrayT() {}
+  explicit Matrix3ArrayT(std::size_t size);
+  Matrix3ArrayT(const std::vector<Matrix3T<T>> &matrices);
+
+  std::size_t size() const { return elements_[0].size(); }
+  bool empty() const { return elements_[0].empty(); }
+  void resize(std::size_t size);
+
+  Matrix3T<T> operator[](std::size_t index) const;
+  void set(std::size_t index, const Matrix3T<T> &matrix);
+
+  // Element (row, col) of every matrix.
+  T *element(int row, int col) { return elements_[3 * row + col].data(); }
+  const T *element(int row, int col) const {
+    return elements_[3 * row + col].data();
+  }
+
+private:
+  std::vector<T> elements_[9];
+};
+
+typedef Matrix3ArrayT<double> Matrix3Array;
+typedef Matrix3ArrayT<float> Matrix3Arrayf;
+
+// Reads only the upper triangle of `m`.
+template <typename T>
+SymmetricEigenT<T> symmetricEigen(
+    const Matrix3T<T> &m,
+    DecompositionAccuracy accuracy = DecompositionAccuracy::kAccurate);
+template <typename T>
+SvdT<T> svd(const Matrix3T<T> &m,
+            DecompositionAccuracy accuracy = DecompositionAccuracy::kAccurate);
+
+// The same for every matrix of `matrices`, using the vector backends that
+// kernels::activeBackend() allows. Results are bit-exact with the functions
+// above. The outputs are resized to the number of matrices; values[i] is
+// the eigenvalues or singular values of matrix i.
+template <typename T>
+void symmetricEigen(
+    const Matrix3ArrayT<T> &matrices, PointCloud3T<T> &values,
+    Matrix3ArrayT<T> &vectors,
+    DecompositionAccuracy accuracy = DecompositionAccuracy::kAccurate);
+template <typename T>
+void svd(const Matrix3ArrayT<T> &matrices, Matrix3ArrayT<T> &u,
+         PointCloud3T<T> &singular_values, Matrix3ArrayT<T> &v,
+         DecompositionAccuracy accuracy = DecompositionAccuracy::kAccurate);
+
+} // namespace cppcourse
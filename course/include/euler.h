@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cppcourse {
+
+// Included by isometry.h, which defines these.
+template <typename T> class Vector3T;
+template <typename T> class Matrix3T;
+
+// Axis sequence of an Euler angle triplet (first, second, third): kXYZ is
+// R = Rx(first) * Ry(second) * Rz(third), i.e. intrinsic X-Y'-Z'' or
+// extrinsic z-y-x. The first six are Tait-Bryan conventions, the last six
+// proper Euler conventions.
+enum class EulerConvention {
+  kXYZ,
+  kXZY,
+  kYXZ,
+  kYZX,
+  kZXY,
+  kZYX,
+  kXYX,
+  kXZX,
+  kYXY,
+  kYZY,
+  kZXZ,
+  kZYZ,
+};
+
+// Closed-form conversions between Euler angles, stored in a Vector3T as
+// (first, second, third), and rotation matrices. Instantiated for float and
+// double in euler.cc.
+namespace euler {
+
+// One sin/cos pair per angle and no matrix products.
+template <typename T>
+Matrix3T<T> toRotation(const Vector3T<T> &angles, EulerConvention convention);
+
+// Angles of an orthonormal `rotation`. The second angle is in
+// [-pi/2, pi/2] for Tait-Bryan and [0, pi] for proper Euler conventions; the
+// others are in [-pi, pi]. At gimbal lock only first + third (or
+// first - third) is defined, so the first angle is set to zero.
+template <typename T>
+Vector3T<T> fromRotation(const Matrix3T<T> &rotation,
+                         EulerConvention convention);
+
+// Array in, array out versions of the above; the convention is decoded once
+// per call.
+template <typename T>
+void toRotationBatch(const Vector3T<T> *angles, Matrix3T<T> *rotations,
+                     std::size_t count, EulerConvention convention);
+template <typename T>
+void fromRotationBatch(const Matrix3T<T> *rotations, Vector3T<T> *angles,
+                       std::size_t count, EulerConvention convention);
+
+} // namespace euler
+
+} // namespace cppcourse
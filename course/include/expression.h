@@ -0,0 +1,336 @@
+#pragma once
+
+#include <cmath>
+#include <initializer_list>
+#include <iostream>
+#include <type_traits>
+
+namespace cppcourse {
+namespace expr {
+
+// Lazy element-wise arithmetic for Vector3T and Matrix3T. Operators return
+// lightweight expression nodes instead of vectors or matrices; the whole tree
+// is evaluated in a single pass, coefficient by coefficient, when it is
+// converted to a Vector3T or Matrix3T. Leaves (Vector3T, Matrix3T) are held
+// by reference and inner nodes by value, so an expression must be evaluated
+// within the full-expression that creates it: assign it to a Vector3T or
+// Matrix3T, never to `auto`.
+
+template <typename L, typename R> class VectorCross;
+
+// CRTP base of every vector expression: a 3-vector with coefficients
+// derived()[i].
+template <typename E> class VectorExpr {
+public:
+  constexpr const E &derived() const { return static_cast<const E &>(*this); }
+
+  constexpr auto x() const { return derived()[0]; }
+  constexpr auto y() const { return derived()[1]; }
+  constexpr auto z() const { return derived()[2]; }
+
+  template <typename R> constexpr auto dot(const VectorExpr<R> &other) const {
+    return derived()[0] * other.derived()[0] +
+           derived()[1] * other.derived()[1] +
+           derived()[2] * other.derived()[2];
+  }
+  auto norm() const { return std::sqrt(dot(*this)); }
+  template <typename R>
+  constexpr VectorCross<E, R> cross(const VectorExpr<R> &other) const {
+    return VectorCross<E, R>(derived(), other.derived());
+  }
+};
+
+// CRTP base of every matrix expression: a 3x3 matrix with coefficients
+// derived()(i, j).
+template <typename E> class MatrixExpr {
+public:
+  constexpr const E &derived() const { return static_cast<const E &>(*this); }
+};
+
+struct Add {
+  template <typename T> static constexpr T apply(const T &a, const T &b) {
+    return a + b;
+  }
+};
+struct Sub {
+  template <typename T> static constexpr T apply(const T &a, const T &b) {
+    return a - b;
+  }
+};
+struct Mul {
+  template <typename T> static constexpr T apply(const T &a, const T &b) {
+    return a * b;
+  }
+};
+struct Div {
+  template <typename T> static constexpr T apply(const T &a, const T &b) {
+    return a / b;
+  }
+};
+
+template <typename L, typename R> struct SameScalar {
+  static_assert(std::is_same<typename L::Scalar, typename R::Scalar>::value,
+                "Mixed scalar types, use cast<U>() first.");
+  typedef typename L::Scalar type;
+};
+
+// Element-wise binary operation between two vector expressions.
+template <typename L, typename R, typename Op>
+class VectorBinary : public VectorExpr<VectorBinary<L, R, Op>> {
+public:
+  typedef typename SameScalar<L, R>::type Scalar;
+  typedef VectorBinary Nested;
+
+  constexpr VectorBinary(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {}
+  constexpr Scalar operator[](const int index) const {
+    return Op::apply(Scalar(lhs_[index]), Scalar(rhs_[index]));
+  }
+
+private:
+  typename L::Nested lhs_;
+  typename R::Nested rhs_;
+};
+
+// Vector expression times a scalar.
+template <typename E> class VectorScale : public VectorExpr<VectorScale<E>> {
+public:
+  typedef typename E::Scalar Scalar;
+  typedef VectorScale Nested;
+
+  constexpr VectorScale(const E &expr, const Scalar &factor)
+      : expr_(expr), factor_(factor) {}
+  constexpr Scalar operator[](const int index) const {
+    return expr_[index] * factor_;
+  }
+
+private:
+  typename E::Nested expr_;
+  Scalar factor_;
+};
+
+template <typename E> class VectorNegate : public VectorExpr<VectorNegate<E>> {
+public:
+  typedef typename E::Scalar Scalar;
+  typedef VectorNegate Nested;
+
+  constexpr explicit VectorNegate(const E &expr) : expr_(expr) {}
+  constexpr Scalar operator[](const int index) const { return -expr_[index]; }
+
+private:
+  typename E::Nested expr_;
+};
+
+template <typename L, typename R>
+class VectorCross : public VectorExpr<VectorCross<L, R>> {
+public:
+  typedef typename SameScalar<L, R>::type Scalar;
+  typedef VectorCross Nested;
+
+  constexpr VectorCross(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {}
+  constexpr Scalar operator[](const int index) const {
+    return lhs_[(index + 1) % 3] * rhs_[(index + 2) % 3] -
+           lhs_[(index + 2) % 3] * rhs_[(index + 1) % 3];
+  }
+
+private:
+  typename L::Nested lhs_;
+  typename R::Nested rhs_;
+};
+
+// Element-wise binary operation between two matrix expressions.
+template <typename L, typename R, typename Op>
+class MatrixBinary : public MatrixExpr<MatrixBinary<L, R, Op>> {
+public:
+  typedef typename SameScalar<L, R>::type Scalar;
+  typedef MatrixBinary Nested;
+
+  constexpr MatrixBinary(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {}
+  constexpr Scalar operator()(const int row, const int col) const {
+    return Op::apply(Scalar(lhs_(row, col)), Scalar(rhs_(row, col)));
+  }
+
+private:
+  typename L::Nested lhs_;
+  typename R::Nested rhs_;
+};
+
+// Matrix expression times a scalar.
+template <typename E> class MatrixScale : public MatrixExpr<MatrixScale<E>> {
+public:
+  typedef typename E::Scalar Scalar;
+  typedef MatrixScale Nested;
+
+  constexpr MatrixScale(const E &expr, const Scalar &factor)
+      : expr_(expr), factor_(factor) {}
+  constexpr Scalar operator()(const int row, const int col) const {
+    return expr_(row, col) * factor_;
+  }
+
+private:
+  typename E::Nested expr_;
+  Scalar factor_;
+};
+
+// Row `i` of the matrix expression scaled by coefficient `i` of the vector
+// expression.
+template <typename M, typename V>
+class MatrixRowScale : public MatrixExpr<MatrixRowScale<M, V>> {
+public:
+  typedef typename SameScalar<M, V>::type Scalar;
+  typedef MatrixRowScale Nested;
+
+  constexpr MatrixRowScale(const M &matrix, const V &vector)
+      : matrix_(matrix), vector_(vector) {}
+  constexpr Scalar operator()(const int row, const int col) const {
+    return matrix_(row, col) * vector_[row];
+  }
+
+private:
+  typename M::Nested matrix_;
+  typename V::Nested vector_;
+};
+
+template <typename L, typename R>
+constexpr VectorBinary<L, R, Add> operator+(const VectorExpr<L> &lhs,
+                                            const VectorExpr<R> &rhs) {
+  return VectorBinary<L, R, Add>(lhs.derived(), rhs.derived());
+}
+
+template <typename L, typename R>
+constexpr VectorBinary<L, R, Sub> operator-(const VectorExpr<L> &lhs,
+                                            const VectorExpr<R> &rhs) {
+  return VectorBinary<L, R, Sub>(lhs.derived(), rhs.derived());
+}
+
+template <typename L, typename R>
+constexpr VectorBinary<L, R, Mul> operator*(const VectorExpr<L> &lhs,
+                                            const VectorExpr<R> &rhs) {
+  return VectorBinary<L, R, Mul>(lhs.derived(), rhs.derived());
+}
+
+template <typename L, typename R>
+constexpr VectorBinary<L, R, Div> operator/(const VectorExpr<L> &lhs,
+                                            const VectorExpr<R> &rhs) {
+  return VectorBinary<L, R, Div>(lhs.derived(), rhs.derived());
+}
+
+template <typename E>
+constexpr VectorScale<E> operator*(const VectorExpr<E> &lhs,
+                                   const typename E::Scalar &rhs) {
+  return VectorScale<E>(lhs.derived(), rhs);
+}
+
+template <typename E>
+constexpr VectorScale<E> operator*(const typename E::Scalar &lhs,
+                                   const VectorExpr<E> &rhs) {
+  return VectorScale<E>(rhs.derived(), lhs);
+}
+
+template <typename E>
+constexpr VectorNegate<E> operator-(const VectorExpr<E> &expr) {
+  return VectorNegate<E>(expr.derived());
+}
+
+template <typename L, typename R>
+constexpr bool operator==(const VectorExpr<L> &lhs, const VectorExpr<R> &rhs) {
+  return lhs.derived()[0] == rhs.derived()[0] &&
+         lhs.derived()[1] == rhs.derived()[1] &&
+         lhs.derived()[2] == rhs.derived()[2];
+}
+
+template <typename L, typename R>
+constexpr bool operator!=(const VectorExpr<L> &lhs, const VectorExpr<R> &rhs) {
+  return !(lhs == rhs);
+}
+
+template <typename E>
+constexpr bool
+operator==(const VectorExpr<E> &lhs,
+           const std::initializer_list<typename E::Scalar> &rhs) {
+  return rhs.size() == 3 && lhs.derived()[0] == rhs.begin()[0] &&
+         lhs.derived()[1] == rhs.begin()[1] &&
+         lhs.derived()[2] == rhs.begin()[2];
+}
+
+template <typename E>
+constexpr bool
+operator!=(const VectorExpr<E> &lhs,
+           const std::initializer_list<typename E::Scalar> &rhs) {
+  return !(lhs == rhs);
+}
+
+template <typename E>
+inline std::ostream &operator<<(std::ostream &ss, const VectorExpr<E> &vec) {
+  return ss << "(x: " << vec.x() << ", y: " << vec.y() << ", z: " << vec.z()
+            << ")";
+}
+
+template <typename L, typename R>
+constexpr MatrixBinary<L, R, Add> operator+(const MatrixExpr<L> &lhs,
+                                            const MatrixExpr<R> &rhs) {
+  return MatrixBinary<L, R, Add>(lhs.derived(), rhs.derived());
+}
+
+template <typename L, typename R>
+constexpr MatrixBinary<L, R, Sub> operator-(const MatrixExpr<L> &lhs,
+                                            const MatrixExpr<R> &rhs) {
+  return MatrixBinary<L, R, Sub>(lhs.derived(), rhs.derived());
+}
+
+template <typename L, typename R>
+constexpr MatrixBinary<L, R, Mul> operator*(const MatrixExpr<L> &lhs,
+                                            const MatrixExpr<R> &rhs) {
+  return MatrixBinary<L, R, Mul>(lhs.derived(), rhs.derived());
+}
+
+template <typename L, typename R>
+constexpr MatrixBinary<L, R, Div> operator/(const MatrixExpr<L> &lhs,
+                                            const MatrixExpr<R> &rhs) {
+  return MatrixBinary<L, R, Div>(lhs.derived(), rhs.derived());
+}
+
+template <typename E>
+constexpr MatrixScale<E> operator*(const MatrixExpr<E> &lhs,
+                                   const typename E::Scalar &rhs) {
+  return MatrixScale<E>(lhs.derived(), rhs);
+}
+
+template <typename E>
+constexpr MatrixScale<E> operator*(const typename E::Scalar &lhs,
+                                   const MatrixExpr<E> &rhs) {
+  return MatrixScale<E>(rhs.derived(), lhs);
+}
+
+template <typename M, typename V>
+constexpr MatrixRowScale<M, V> operator*(const MatrixExpr<M> &lhs,
+                                         const VectorExpr<V> &rhs) {
+  return MatrixRowScale<M, V>(lhs.derived(), rhs.derived());
+}
+
+template <typename L, typename R>
+constexpr bool operator==(const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs) {
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      if (lhs.derived()(i, j) != rhs.derived()(i, j)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename L, typename R>
+constexpr bool operator!=(const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs) {
+  return !(lhs == rhs);
+}
+
+template <typename E>
+inline std::ostream &operator<<(std::ostream &ss, const MatrixExpr<E> &expr) {
+  const E &m = expr.derived();
+  return ss << "[[" << m(0, 0) << ", " << m(0, 1) << ", " << m(0, 2) << "],"
+            << " [" << m(1, 0) << ", " << m(1, 1) << ", " << m(1, 2) << "],"
+            << " [" << m(2, 0) << ", " << m(2, 1) << ", " << m(2, 2) << "]]";
+}
+
+} // namespace expr
+} // namespace cppcourse
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "isometry.h"
+
+namespace cppcourse {
+
+// Tree of named coordinate frames joined by parent_T_child edges. Every frame
+// memoizes root_T_frame, so once the cache is warm lookup() is two cache hits,
+// an inverse and a product regardless of the depth of the tree. Changing an
+// edge only invalidates the subtree below it.
+//
+// lookup() fills the cache lazily and is therefore not safe to call
+// concurrently, even though it is const, unless resolveAll() was called after
+// the last edit. SharedFrameGraph publishes resolved snapshots to readers.
+class FrameGraph {
+public:
+  typedef std::size_t FrameId;
+
+  // Adds a root frame. Throws std::invalid_argument if it already exists.
+  FrameId addFrame(const std::string &name);
+  // Sets the edge parent_T_child, adding `child` if it does not exist and
+  // re-parenting it if it does. Throws std::out_of_range for an unknown
+  // `parent` and std::invalid_argument if the edge would close a cycle.
+  FrameId setTransform(const std::string &parent, const std::string &child,
+                       const Isometry &parent_T_child);
+  // Updates the edge to the current parent of `child`, e.g. a joint motion.
+  void setTransform(FrameId child, const Isometry &parent_T_child);
+
+  bool hasFrame(const std::string &name) const;
+  // Throws std::out_of_range for unknown frames.
+  FrameId id(const std::string &name) const;
+  const std::string &name(FrameId frame) const;
+  // The frame itself for roots.
+  FrameId parent(FrameId frame) const;
+  std::size_t size() const { return frames_.size(); }
+
+  // to_T_from: maps points expressed in `from` into `to`. Throws
+  // std::out_of_range for unknown frames and std::invalid_argument if they
+  // belong to different trees.
+  Isometry lookup(const std::string &from, const std::string &to) const;
+  Isometry lookup(FrameId from, FrameId to) const;
+
+  // Fills the cache of every frame. Until the next edit lookup() and
+  // commonAncestor() only read, so concurrent readers are safe.
+  void resolveAll() const;
+
+  // Deepest frame that is an ancestor of (or equal to) both frames. Throws
+  // std::invalid_argument if they belong to different trees.
+  FrameId commonAncestor(FrameId first, FrameId second) const;
+
+private:
+  struct Frame {
+    std::string name;
+    FrameId parent;
+    std::size_t depth;
+    std::vector<FrameId> children;
+    Isometry parent_T_frame;
+    // Valid while `cached`.
+    mutable Isometry root_T_frame;
+    mutable FrameId root;
+    mutable bool cached;
+  };
+
+  const Frame &frame(FrameId id) const;
+  // Marks the cache of `id` and all its descendants stale and updates their
+  // depths.
+  void invalidate(FrameId id);
+  // Fills the cache of `id` and its stale ancestors.
+  const Isometry &rootTransform(FrameId id) const;
+
+  std::vector<Frame> frames_;
+  std::unordered_map<std::string, FrameId> ids_;
+};
+
+} // namespace cppcourse
@@ -1,170 +1,317 @@
 #pragma once
 
 #include <cmath>
-#include <iomanip> // std::setprecision
+#include <initializer_list>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+
+#include "euler.h"
+#include "expression.h"
 
 namespace cppcourse {
 
-class Vector3 {
+template <typename T> class PointCloud3T;
+template <typename T> struct PointView3T;
+class ThreadPool;
+
+namespace detail {
+
+// Element `index` of `list`, which must hold exactly `size` values.
+template <typename T>
+constexpr T checkedElement(const std::initializer_list<T> &list,
+                           std::size_t size, std::size_t index) {
+  return list.size() == size
+             ? list.begin()[index]
+             : throw std::invalid_argument("Wrong initializer list size.");
+}
+
+} // namespace detail
+
+// Vector3T, Matrix3T and IsometryT are explicitly instantiated for float and
+// double in isometry.cc. They are literal, trivially copyable and
+// standard-layout types, so they can be constexpr and copied as raw bytes.
+template <typename T> class Vector3T : public expr::VectorExpr<Vector3T<T>> {
 public:
-  Vector3(const std::initializer_list<double> &rhs);
-  Vector3(const double &x = 0., const double &y = 0., const double &z = 0.)
-      : x_(x), y_(y), z_(z){};
-  Vector3 operator+(const Vector3 &other) const;
-  Vector3 operator-(const Vector3 &other) const;
-  Vector3 operator/(const Vector3 &other) const;
-  Vector3 operator*(const double &other) const;
-  Vector3 operator*(const Vector3 &other) const;
-  bool operator!=(const Vector3 &other) const { return (!(*this == other)); }
-  bool operator==(const Vector3 &other) const;
-  bool operator==(const std::initializer_list<double> &rhs) const;
-  double &operator[](const int index);
-  const double &operator[](const int index) const;
-
-  double dot(const Vector3 &other) const;
-  Vector3 cross(const Vector3 &other) const;
-  double norm() const;
-  double &x() { return x_; }
-  const double &x() const { return x_; }
-  double &y() { return y_; }
-  const double &y() const { return y_; }
-  double &z() { return z_; }
-  const double &z() const { return z_; }
-
-  static const Vector3 kUnitX;
-  static const Vector3 kUnitY;
-  static const Vector3 kUnitZ;
-  static const Vector3 kZero;
+  typedef T Scalar;
+  typedef const Vector3T &Nested;
+
+  constexpr Vector3T(const std::initializer_list<T> &rhs)
+      : data_{detail::checkedElement(rhs, 3, 0),
+              detail::checkedElement(rhs, 3, 1),
+              detail::checkedElement(rhs, 3, 2)} {}
+  constexpr Vector3T(const T &x = 0., const T &y = 0., const T &z = 0.)
+      : data_{x, y, z} {}
+  // Evaluates an expression such as `(a + b) * s - c` in a single pass.
+  template <typename E>
+  constexpr Vector3T(const expr::VectorExpr<E> &rhs)
+      : data_{rhs.derived()[0], rhs.derived()[1], rhs.derived()[2]} {}
+  constexpr T &operator[](const int index) { return data_[index]; }
+  constexpr const T &operator[](const int index) const { return data_[index]; }
+
+  constexpr T &x() { return data_[0]; }
+  constexpr const T &x() const { return data_[0]; }
+  constexpr T &y() { return data_[1]; }
+  constexpr const T &y() const { return data_[1]; }
+  constexpr T &z() { return data_[2]; }
+  constexpr const T &z() const { return data_[2]; }
+
+  template <typename U> constexpr Vector3T<U> cast() const {
+    return Vector3T<U>(static_cast<U>(data_[0]), static_cast<U>(data_[1]),
+                       static_cast<U>(data_[2]));
+  }
+
+  static const Vector3T kUnitX;
+  static const Vector3T kUnitY;
+  static const Vector3T kUnitZ;
+  static const Vector3T kZero;
 
 private:
-  double x_, y_, z_;
+  T data_[3];
 };
 
-inline Vector3 operator*(const double &lhs, const Vector3 &rhs) {
-  return (rhs * lhs);
-}
-
-inline std::ostream &operator<<(std::ostream &ss,
-                                const cppcourse::Vector3 &vec) {
-  return ss << "(x: " << vec.x() << ", y: " << vec.y() << ", z: " << vec.z()
-            << ")";
-}
+template <typename T> constexpr Vector3T<T> Vector3T<T>::kUnitX{1., 0., 0.};
+template <typename T> constexpr Vector3T<T> Vector3T<T>::kUnitY{0., 1., 0.};
+template <typename T> constexpr Vector3T<T> Vector3T<T>::kUnitZ{0., 0., 1.};
+template <typename T> constexpr Vector3T<T> Vector3T<T>::kZero{0., 0., 0.};
 
-class Matrix3 {
+template <typename T> class Matrix3T : public expr::MatrixExpr<Matrix3T<T>> {
 public:
-  Matrix3() {}
-  Matrix3(const std::initializer_list<double> &rhs);
-  Matrix3(const Matrix3 &rhs);
-  Matrix3(const Vector3 &first, const Vector3 &second, const Vector3 &third) {
-    rows_[0] = first;
-    rows_[1] = second;
-    rows_[2] = third;
-  }
-  Matrix3(Matrix3 &&rhs) {
-    rows_[0] = std::move(rhs.rows_[0]);
-    rows_[1] = std::move(rhs.rows_[1]);
-    rows_[2] = std::move(rhs.rows_[2]);
-  }
-  Matrix3 operator-(const Matrix3 &other) const;
-  Matrix3 operator+(const Matrix3 &other) const;
-  Matrix3 operator*(const double &other) const;
-  Matrix3 operator*(const Matrix3 &other) const;
-  Matrix3 operator*(const Vector3 &other) const;
-  Matrix3 operator/(const Matrix3 &other) const;
-  Matrix3 product(const Matrix3 &rhs) const;
-  Vector3 product(const Vector3 &rhs) const;
-  Matrix3 &operator-=(const Matrix3 &rhs);
-  Matrix3 &operator+=(const Matrix3 &rhs);
-  Matrix3 &operator=(const Matrix3 &rhs) {
-    this->rows_[0] = rhs.row(0);
-    this->rows_[1] = rhs.row(1);
-    this->rows_[2] = rhs.row(2);
-    return *this;
-  };
-  Matrix3 inverse() const;
-  Matrix3 &operator=(const Matrix3 &&rhs)
-  {
-    this->rows_[0] = std::move(rhs.rows_[0]);
-    this->rows_[1] = std::move(rhs.rows_[1]);
-    this->rows_[2] = std::move(rhs.rows_[2]);
-    return *this;
+  typedef T Scalar;
+  typedef const Matrix3T &Nested;
+
+  constexpr Matrix3T() : rows_{} {}
+  constexpr Matrix3T(const std::initializer_list<T> &rhs)
+      : rows_{Vector3T<T>(detail::checkedElement(rhs, 9, 0),
+                          detail::checkedElement(rhs, 9, 1),
+                          detail::checkedElement(rhs, 9, 2)),
+              Vector3T<T>(detail::checkedElement(rhs, 9, 3),
+                          detail::checkedElement(rhs, 9, 4),
+                          detail::checkedElement(rhs, 9, 5)),
+              Vector3T<T>(detail::checkedElement(rhs, 9, 6),
+                          detail::checkedElement(rhs, 9, 7),
+                          detail::checkedElement(rhs, 9, 8))} {}
+  constexpr Matrix3T(const Vector3T<T> &first, const Vector3T<T> &second,
+                     const Vector3T<T> &third)
+      : rows_{first, second, third} {}
+  // Evaluates an element-wise expression such as `2. * a - b` in one pass.
+  template <typename E>
+  constexpr Matrix3T(const expr::MatrixExpr<E> &rhs)
+      : rows_{Vector3T<T>(rhs.derived()(0, 0), rhs.derived()(0, 1),
+                          rhs.derived()(0, 2)),
+              Vector3T<T>(rhs.derived()(1, 0), rhs.derived()(1, 1),
+                          rhs.derived()(1, 2)),
+              Vector3T<T>(rhs.derived()(2, 0), rhs.derived()(2, 1),
+                          rhs.derived()(2, 2))} {}
+  constexpr Matrix3T product(const Matrix3T &rhs) const {
+    Matrix3T output;
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        output[i][j] = row(i).dot(rhs.col(j));
+      }
+    }
+    return output;
+  }
+  constexpr Vector3T<T> product(const Vector3T<T> &rhs) const {
+    return Vector3T<T>(rows_[0].dot(rhs), rows_[1].dot(rhs),
+                       rows_[2].dot(rhs));
+  }
+  template <typename E> Matrix3T &operator-=(const expr::MatrixExpr<E> &rhs) {
+    return (*this = *this - rhs);
+  }
+  template <typename E> Matrix3T &operator+=(const expr::MatrixExpr<E> &rhs) {
+    return (*this = *this + rhs);
+  }
+  // General inverse through the adjugate; the matrix must not be singular.
+  Matrix3T inverse() const;
+  constexpr Matrix3T transpose() const {
+    return Matrix3T(col(0), col(1), col(2));
+  }
+  // True when the rows are unit length and mutually orthogonal within
+  // `tolerance`, i.e. when transpose() is the inverse.
+  bool isOrthonormal(const T &tolerance) const;
+  // Nearest-looking rotation to a matrix that drifted from orthonormality,
+  // e.g. after a long chain of products. The orthogonality error of the
+  // first two rows is split evenly between them before completing an
+  // orthonormal basis with cross products.
+  Matrix3T orthonormalized() const;
+  constexpr Vector3T<T> &operator[](const int row_n) { return row(row_n); };
+  constexpr const Vector3T<T> &operator[](const int row_n) const {
+    return row(row_n);
   };
-  Vector3 &operator[](const int row_n) { return row(row_n); };
-  const Vector3 &operator[](const int row_n) const { return row(row_n); };
 
-  const Vector3 &row(int index) const { return rows_[index]; }
-  Vector3 &row(int index) { return rows_[index]; }
-  Vector3 col(int index) const {
-    return Vector3(rows_[0][index], rows_[1][index], rows_[2][index]);
+  constexpr const T &operator()(const int row_n, const int col_n) const {
+    return rows_[row_n][col_n];
+  }
+
+  constexpr const Vector3T<T> &row(int index) const { return rows_[index]; }
+  constexpr Vector3T<T> &row(int index) { return rows_[index]; }
+  constexpr Vector3T<T> col(int index) const {
+    return Vector3T<T>(rows_[0][index], rows_[1][index], rows_[2][index]);
+  }
+  static const Matrix3T kIdentity;
+  static const Matrix3T kZero;
+  static const Matrix3T kOnes;
+  T det() const;
+
+  template <typename U> constexpr Matrix3T<U> cast() const {
+    return Matrix3T<U>(rows_[0].template cast<U>(),
+                       rows_[1].template cast<U>(),
+                       rows_[2].template cast<U>());
   }
-  bool operator==(const Matrix3 &other) const;
-  static const Matrix3 kIdentity;
-  static const Matrix3 kZero;
-  static const Matrix3 kOnes;
-  double det() const;
 
 private:
-  Vector3 rows_[3];
+  Vector3T<T> rows_[3];
 };
 
-inline Matrix3 operator*(const double &lhs, const Matrix3 &rhs) {
-  return (rhs * lhs);
-}
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::kIdentity{Vector3T<T>::kUnitX,
+                                             Vector3T<T>::kUnitY,
+                                             Vector3T<T>::kUnitZ};
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::kOnes{1., 1., 1., 1., 1., 1., 1., 1., 1.};
+template <typename T>
+constexpr Matrix3T<T> Matrix3T<T>::kZero{0., 0., 0., 0., 0., 0., 0., 0., 0.};
 
-inline std::ostream &operator<<(std::ostream &ss, const Matrix3 &vec) {
-  return ss << "[[" << vec.row(0)[0] << ", " << vec.row(0)[1] << ", "
-            << vec.row(0)[2] << "],"
-            << " [" << vec.row(1)[0] << ", " << vec.row(1)[1] << ", "
-            << vec.row(1)[2] << "],"
-            << " [" << vec.row(2)[0] << ", " << vec.row(2)[1] << ", "
-            << vec.row(2)[2] << "]]";
+namespace detail {
+
+// Rodrigues form I + a [k]x + b [k]x^2. With a unit `k`, a = sin(angle) and
+// b = 1 - cos(angle) it is the rotation of `angle` around `k`; the SO(3)
+// exponential and Jacobians in lie.h share it with other coefficients.
+template <typename T>
+constexpr Matrix3T<T> rodrigues(const Vector3T<T> &k, const T &a, const T &b) {
+  const T xx = k.x() * k.x(), yy = k.y() * k.y(), zz = k.z() * k.z();
+  const T xy = k.x() * k.y(), xz = k.x() * k.z(), yz = k.y() * k.z();
+  return Matrix3T<T>(
+      Vector3T<T>(1 - b * (yy + zz), b * xy - a * k.z(), b * xz + a * k.y()),
+      Vector3T<T>(b * xy + a * k.z(), 1 - b * (xx + zz), b * yz - a * k.x()),
+      Vector3T<T>(b * xz - a * k.y(), b * yz + a * k.x(), 1 - b * (xx + yy)));
 }
 
-class Isometry {
+} // namespace detail
+
+// Parallel cloud transforms hand out chunks of this many points: 8192
+// doubles per coordinate in and out is 384 KiB, about one core's L2.
+const std::size_t kCloudChunk{8192};
+// Default number of points below which a parallel transform stays on the
+// calling thread.
+const std::size_t kCloudSerialCutoff{4 * kCloudChunk};
+
+template <typename T> class IsometryT {
 public:
-  Isometry() {
-    rotation_ = Matrix3::kIdentity;
-    translation_ = Vector3::kZero;
-  }
-  Isometry(const Vector3 &trans, const Matrix3 &rot) {
-    translation_ = trans;
-    rotation_ = rot;
-  }
+  typedef T Scalar;
 
-  static Isometry FromTranslation(const Vector3 &vec);
+  constexpr IsometryT()
+      : rotation_(Matrix3T<T>::kIdentity), translation_(Vector3T<T>::kZero) {}
+  constexpr IsometryT(const Vector3T<T> &trans, const Matrix3T<T> &rot)
+      : rotation_(rot), translation_(trans) {}
 
-  Vector3 operator*(const Vector3 &rhs) const {
+  static IsometryT FromTranslation(const Vector3T<T> &vec);
+
+  Vector3T<T> operator*(const Vector3T<T> &rhs) const {
     return (rotation_.product(rhs) + translation_);
   }
-  Isometry operator*(const Isometry &rhs) const {
-    return (Isometry{rotation_.product(rhs.translation_) + translation_,
-                     (rotation_.product(rhs.rotation_))});
+  IsometryT operator*(const IsometryT &rhs) const {
+    return (IsometryT{rotation_.product(rhs.translation_) + translation_,
+                      (rotation_.product(rhs.rotation_))});
+  }
+  // An isometry's rotation is orthonormal, so its inverse is the transpose.
+  constexpr IsometryT inverse() const {
+    return IsometryT{rotation_.transpose().product(translation_) * -1,
+                     rotation_.transpose()};
+  }
+  // Inverse for a `rotation()` that is not orthonormal (e.g. it carries scale
+  // or shear), through the general Matrix3T::inverse().
+  IsometryT inverseGeneral() const {
+    const Matrix3T<T> inverse_rotation = rotation_.inverse();
+    return IsometryT{inverse_rotation.product(translation_) * -1,
+                     inverse_rotation};
   }
-  Isometry inverse() const {
-    return (Isometry{
-        (rotation_.inverse().product(translation_)) * -1, rotation_.inverse() });
+  IsometryT compose(const IsometryT &rhs) const { return (*this * rhs); }
+  // Same translation with the rotation re-orthonormalized.
+  IsometryT orthonormalized() const {
+    return IsometryT{translation_, rotation_.orthonormalized()};
   }
-  Isometry compose(const Isometry &rhs) const { return (*this * rhs); }
-  Vector3 transform(const Vector3 &rhs) const { return (*this * rhs); }
-  bool operator==(const Isometry &rhs) const {
+  Vector3T<T> transform(const Vector3T<T> &rhs) const { return (*this * rhs); }
+  // Applies the isometry to every point of `in` and stores the result in
+  // `out`, which is resized to match. `in` and `out` may be the same cloud.
+  void transform(const PointCloud3T<T> &in, PointCloud3T<T> &out) const;
+  // Same, split into cache-sized chunks across `pool`. Clouds of fewer than
+  // `min_parallel_points` points, too small to amortize the dispatch, are
+  // transformed on the calling thread.
+  void transform(const PointCloud3T<T> &in, PointCloud3T<T> &out,
+                 ThreadPool &pool,
+                 std::size_t min_parallel_points = kCloudSerialCutoff) const;
+  // Reads the points straight from `in`, e.g. a mapped file, without first
+  // copying them into a cloud. `out` is resized to match.
+  void transform(const PointView3T<T> &in, PointCloud3T<T> &out) const;
+  void transform(const PointView3T<T> &in, PointCloud3T<T> &out,
+                 ThreadPool &pool,
+                 std::size_t min_parallel_points = kCloudSerialCutoff) const;
+  bool operator==(const IsometryT &rhs) const {
     return ((rotation_ == rhs.rotation_) && (translation_ == rhs.translation_));
   }
-  const Matrix3 rotation() const { return rotation_; }
-  const Vector3 &translation() const { return translation_; }
-  static Isometry RotateAround(const Vector3 &direction, const double &value);
-  static Isometry FromEulerAngles(const double &roll, const double &pitch,
-                                  const double &yaw);
+  constexpr const Matrix3T<T> &rotation() const { return rotation_; }
+  constexpr const Vector3T<T> &translation() const { return translation_; }
+  static IsometryT RotateAround(const Vector3T<T> &direction, const T &value);
+  // Rx(roll) * Ry(pitch) * Rz(yaw); euler.h covers the other conventions.
+  static IsometryT FromEulerAngles(const T &roll, const T &pitch, const T &yaw);
+
+  // Converts to another scalar type, e.g. to apply a pose composed in double
+  // precision to single precision points.
+  template <typename U> constexpr IsometryT<U> cast() const {
+    return IsometryT<U>(translation_.template cast<U>(),
+                        rotation_.template cast<U>());
+  }
 
 private:
-  Matrix3 rotation_;
-  Vector3 translation_;
+  Matrix3T<T> rotation_;
+  Vector3T<T> translation_;
 };
 
-inline std::ostream &operator<<(std::ostream &ss,
-                                const cppcourse::Isometry &iso) {
-  ss << std::setprecision(9);
-  return ss << "[T: " << iso.translation() << ", R:" << iso.rotation() << "]";
+template <typename T>
+inline std::ostream &operator<<(std::ostream &ss, const IsometryT<T> &iso) {
+  // Printed with 9 significant digits; the caller's precision is restored.
+  const std::streamsize precision = ss.precision(9);
+  ss << "[T: " << iso.translation() << ", R:" << iso.rotation() << "]";
+  ss.precision(precision);
+  return ss;
 }
+
+#define CPPCOURSE_ASSERT_POD_LIKE(Type)                                        \
+  static_assert(std::is_trivially_copyable<Type>::value,                       \
+                #Type " must be trivially copyable.");                         \
+  static_assert(std::is_standard_layout<Type>::value,                          \
+                #Type " must be standard layout.")
+CPPCOURSE_ASSERT_POD_LIKE(Vector3T<float>);
+CPPCOURSE_ASSERT_POD_LIKE(Vector3T<double>);
+CPPCOURSE_ASSERT_POD_LIKE(Matrix3T<float>);
+CPPCOURSE_ASSERT_POD_LIKE(Matrix3T<double>);
+CPPCOURSE_ASSERT_POD_LIKE(IsometryT<float>);
+CPPCOURSE_ASSERT_POD_LIKE(IsometryT<double>);
+#undef CPPCOURSE_ASSERT_POD_LIKE
+
+typedef Vector3T<double> Vector3;
+typedef Matrix3T<double> Matrix3;
+typedef IsometryT<double> Isometry;
+typedef Vector3T<float> Vector3f;
+typedef Matrix3T<float> Matrix3f;
+typedef IsometryT<float> Isometryf;
+
+#ifndef CPPCOURSE_ISOMETRY_HEADER_ONLY
+extern template class Vector3T<float>;
+extern template class Vector3T<double>;
+extern template class Matrix3T<float>;
+extern template class Matrix3T<double>;
+extern template class IsometryT<float>;
+extern template class IsometryT<double>;
+#endif
+
 } // namespace cppcourse
+
+// Built with -DCPPCOURSE_ISOMETRY_HEADER_ONLY=ON every member is visible to,
+// and can be inlined into, the caller.
+#ifdef CPPCOURSE_ISOMETRY_HEADER_ONLY
+#include "isometry_impl.h"
+#endif
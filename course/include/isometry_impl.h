@@ -0,0 +1,189 @@
+#pragma once
+
+// Out-of-line members of Vector3T, Matrix3T and IsometryT. isometry.cc
+// instantiates them for float and double; when CPPCOURSE_ISOMETRY_HEADER_ONLY
+// is defined isometry.h includes this file so every caller can inline them.
+
+#include "isometry.h"
+#include "point_cloud.h"
+#include "thread_pool.h"
+#include "transform_kernels.h"
+
+namespace cppcourse {
+
+template <typename T>
+Matrix3T<T> Matrix3T<T>::inverse() const {
+  Matrix3T<T> output;
+  output[0][0] = rows_[1][1] * rows_[2][2] - rows_[1][2] * rows_[2][1];
+  output[0][1] = rows_[0][2] * rows_[2][1] - rows_[0][1] * rows_[2][2];
+  output[0][2] = rows_[0][1] * rows_[1][2] - rows_[0][2] * rows_[1][1];
+
+  output[1][0] = rows_[1][2] * rows_[2][0] - rows_[1][0] * rows_[2][2];
+  output[1][1] = rows_[0][0] * rows_[2][2] - rows_[0][2] * rows_[2][0];
+  output[1][2] = rows_[0][2] * rows_[1][0] - rows_[0][0] * rows_[1][2];
+
+  output[2][0] = rows_[1][0] * rows_[2][1] - rows_[1][1] * rows_[2][0];
+  output[2][1] = rows_[0][1] * rows_[2][0] - rows_[0][0] * rows_[2][1];
+  output[2][2] = rows_[0][0] * rows_[1][1] - rows_[0][1] * rows_[1][0];
+  return (output * (1 / det()));
+}
+
+template <typename T>
+bool Matrix3T<T>::isOrthonormal(const T &tolerance) const {
+  for (int i = 0; i < 3; ++i) {
+    for (int j = i; j < 3; ++j) {
+      const T expected = i == j ? T(1) : T(0);
+      if (std::abs(rows_[i].dot(rows_[j]) - expected) > tolerance) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <typename T>
+Matrix3T<T> Matrix3T<T>::orthonormalized() const {
+  const T error = rows_[0].dot(rows_[1]) / 2;
+  const Vector3T<T> x = rows_[0] - rows_[1] * error;
+  const Vector3T<T> y = rows_[1] - rows_[0] * error;
+  const Vector3T<T> z = x.cross(y);
+  Matrix3T output;
+  output[0] = x * (T(1) / x.norm());
+  output[2] = z * (T(1) / z.norm());
+  // Splitting the error only removes it to first order; rebuilding the
+  // second row from the other two makes the result exact to rounding.
+  output[1] = Vector3T<T>(output[2].cross(output[0]));
+  return output;
+}
+
+template <typename T>
+T Matrix3T<T>::det() const {
+  return (
+      rows_[0][0] * (rows_[1][1] * rows_[2][2] - rows_[1][2] * rows_[2][1]) -
+      rows_[0][1] * (rows_[1][0] * rows_[2][2] - rows_[1][2] * rows_[2][0]) +
+      rows_[0][2] * (rows_[1][0] * rows_[2][1] - rows_[1][1] * rows_[2][0]));
+}
+
+template <typename T>
+IsometryT<T> IsometryT<T>::FromTranslation(const Vector3T<T> &vec) {
+  return IsometryT<T>{vec, Matrix3T<T>::kIdentity};
+}
+
+namespace detail {
+
+// Row-major [R|t] of `pose` for the transform kernels.
+template <typename T>
+kernels::AffineCoefficients<T> affineCoefficients(const IsometryT<T> &pose) {
+  kernels::AffineCoefficients<T> coefficients;
+  for (int i = 0; i < 3; ++i) {
+    coefficients.m[4 * i + 0] = pose.rotation()[i][0];
+    coefficients.m[4 * i + 1] = pose.rotation()[i][1];
+    coefficients.m[4 * i + 2] = pose.rotation()[i][2];
+    coefficients.m[4 * i + 3] = pose.translation()[i];
+  }
+  return coefficients;
+}
+
+// Transforms points [begin, end) of `in` into the same range of the output
+// arrays. Contiguous coordinates go through the batch kernels, strided ones
+// through a scalar loop.
+template <typename T>
+void transformView(const kernels::AffineCoefficients<T> &c,
+                   const PointView3T<T> &in, std::size_t begin,
+                   std::size_t end, T *ox, T *oy, T *oz) {
+  const PointView3T<T> part = in.subview(begin, end - begin);
+  if (part.x.isContiguous() && part.y.isContiguous() &&
+      part.z.isContiguous()) {
+    kernels::transformPoints(
+        c, reinterpret_cast<const T *>(part.x.data()),
+        reinterpret_cast<const T *>(part.y.data()),
+        reinterpret_cast<const T *>(part.z.data()), ox + begin, oy + begin,
+        oz + begin, part.size());
+    return;
+  }
+  for (std::size_t i = 0; i < part.size(); ++i) {
+    const T px = part.x[i];
+    const T py = part.y[i];
+    const T pz = part.z[i];
+    ox[begin + i] = c.m[0] * px + c.m[1] * py + c.m[2] * pz + c.m[3];
+    oy[begin + i] = c.m[4] * px + c.m[5] * py + c.m[6] * pz + c.m[7];
+    oz[begin + i] = c.m[8] * px + c.m[9] * py + c.m[10] * pz + c.m[11];
+  }
+}
+
+} // namespace detail
+
+template <typename T>
+void IsometryT<T>::transform(const PointCloud3T<T> &in,
+                             PointCloud3T<T> &out) const {
+  out.resize(in.size());
+  kernels::transformPoints(detail::affineCoefficients(*this), in.x(), in.y(),
+                           in.z(), out.x(), out.y(), out.z(), in.size());
+}
+
+template <typename T>
+void IsometryT<T>::transform(const PointCloud3T<T> &in, PointCloud3T<T> &out,
+                             ThreadPool &pool,
+                             std::size_t min_parallel_points) const {
+  if (in.size() < min_parallel_points || pool.threads() == 1) {
+    transform(in, out);
+    return;
+  }
+  out.resize(in.size());
+  const kernels::AffineCoefficients<T> coefficients =
+      detail::affineCoefficients(*this);
+  const T *x = in.x(), *y = in.y(), *z = in.z();
+  T *ox = out.x(), *oy = out.y(), *oz = out.z();
+  pool.parallelFor(in.size(), kCloudChunk,
+                   [&](std::size_t begin, std::size_t end) {
+                     kernels::transformPoints(coefficients, x + begin,
+                                              y + begin, z + begin,
+                                              ox + begin, oy + begin,
+                                              oz + begin, end - begin);
+                   });
+}
+
+template <typename T>
+void IsometryT<T>::transform(const PointView3T<T> &in,
+                             PointCloud3T<T> &out) const {
+  out.resize(in.size());
+  detail::transformView(detail::affineCoefficients(*this), in, 0, in.size(),
+                        out.x(), out.y(), out.z());
+}
+
+template <typename T>
+void IsometryT<T>::transform(const PointView3T<T> &in, PointCloud3T<T> &out,
+                             ThreadPool &pool,
+                             std::size_t min_parallel_points) const {
+  if (in.size() < min_parallel_points || pool.threads() == 1) {
+    transform(in, out);
+    return;
+  }
+  out.resize(in.size());
+  const kernels::AffineCoefficients<T> coefficients =
+      detail::affineCoefficients(*this);
+  T *ox = out.x(), *oy = out.y(), *oz = out.z();
+  pool.parallelFor(in.size(), kCloudChunk,
+                   [&](std::size_t begin, std::size_t end) {
+                     detail::transformView(coefficients, in, begin, end, ox,
+                                           oy, oz);
+                   });
+}
+
+template <typename T>
+IsometryT<T> IsometryT<T>::RotateAround(const Vector3T<T> &direction,
+                                        const T &value) {
+  return IsometryT<T>(Vector3T<T>::kZero,
+                      detail::rodrigues(direction, std::sin(value),
+                                        1 - std::cos(value)));
+}
+
+template <typename T>
+IsometryT<T> IsometryT<T>::FromEulerAngles(const T &roll, const T &pitch,
+                                           const T &yaw) {
+  return IsometryT<T>(Vector3T<T>::kZero,
+                      euler::toRotation(Vector3T<T>(roll, pitch, yaw),
+                                        EulerConvention::kXYZ));
+}
+
+} // namespace cppcourse
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "isometry.h"
+#include "point_cloud.h"
+
+namespace cppcourse {
+
+class ThreadPool;
+
+template <typename T> struct NeighborT {
+  typedef T Scalar;
+
+  // Position of the point in the set the tree was built from.
+  std::size_t index;
+  T squared_distance;
+};
+
+typedef NeighborT<double> Neighbor;
+typedef NeighborT<float> Neighborf;
+
+// Static KD-tree over a 3D point set for nearest-neighbor and radius
+// queries, e.g. for scan matching or outlier removal.
+//
+// Implicit layout: the tree is one flat array of (point, index) entries in
+// tree order, with no node objects. A node is a range [begin, end) of
+// entries; unless it holds at most kLeafSize entries, its median entry
+// mid = begin + (end - begin) / 2 on the widest side of its box splits it
+// into a left child [begin, mid) at or below that entry and a right child
+// [mid + 1, end) at or above it. Leaves are scanned linearly, and queries
+// skip subtrees whose box is farther than the current bound. Instantiated
+// for float and double in kd_tree.cc.
+//
+// There can be at most 2^30 points and they must be finite. Squared
+// distances are computed in T. Ties between equidistant points are broken
+// arbitrarily.
+template <typename T> class KdTreeT {
+public:
+  typedef T Scalar;
+
+  static const std::size_t kLeafSize = 16;
+
+  KdTreeT() = default;
+  explicit KdTreeT(const PointView3T<T> &points);
+  explicit KdTreeT(const std::vector<Vector3T<T>> &points);
+  // Builds the subtrees of large nodes in parallel; the result is the same
+  // tree as without the pool.
+  KdTreeT(const PointView3T<T> &points, ThreadPool &pool);
+
+  std::size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  // Bytes held by the tree, the copy of the points included.
+  std::size_t memoryBytes() const {
+    return entries_.capacity() * sizeof(Entry);
+  }
+
+  // Closest point to `query`. Throws std::out_of_range if the tree is empty.
+  NeighborT<T> nearest(const Vector3T<T> &query) const;
+  // Writes the min(k, size()) closest points to `neighbors`, which has room
+  // for k, by increasing distance and returns how many it wrote.
+  std::size_t nearest(const Vector3T<T> &query, std::size_t k,
+                      NeighborT<T> *neighbors) const;
+  // Replaces `neighbors` with the points at most `radius` away from `query`,
+  // in no particular order. Throws std::invalid_argument if `radius` is
+  // negative or NaN.
+  void radiusSearch(const Vector3T<T> &query, T radius,
+                    std::vector<NeighborT<T>> &neighbors) const;
+
+  // Batch versions. For the k-NN query `neighbors` is resized to
+  // queries.size() * min(k, size()) and query i owns the i-th run of
+  // min(k, size()) entries. For the radius query `offsets` gets
+  // queries.size() + 1 entries and the neighbors of query i are
+  // [offsets[i], offsets[i + 1]) of `neighbors`.
+  void nearest(const PointView3T<T> &queries, std::size_t k,
+               std::vector<NeighborT<T>> &neighbors) const;
+  void nearest(const PointView3T<T> &queries, std::size_t k,
+               std::vector<NeighborT<T>> &neighbors, ThreadPool &pool) const;
+  void radiusSearch(const PointView3T<T> &queries, T radius,
+                    std::vector<std::size_t> &offsets,
+                    std::vector<NeighborT<T>> &neighbors) const;
+  void radiusSearch(const PointView3T<T> &queries, T radius,
+                    std::vector<std::size_t> &offsets,
+                    std::vector<NeighborT<T>> &neighbors,
+                    ThreadPool &pool) const;
+
+private:
+  // An internal node's split dimension sits in the top bits of the key of
+  // its median entry, so visiting the node touches a single entry.
+  static const int kIndexBits = 30;
+  static const std::uint32_t kIndexMask = (1u << kIndexBits) - 1;
+  struct Entry {
+    T point[3];
+    // Index of the point, and the split dimension above kIndexBits.
+    std::uint32_t key;
+  };
+
+  void build(const PointView3T<T> &points, ThreadPool *pool);
+  void buildNode(std::size_t begin, std::size_t end, Vector3T<T> low,
+                 Vector3T<T> high, ThreadPool *pool);
+  // Calls visitor.add(entry, squared_distance) for every entry that
+  // may beat visitor.bound(), which may shrink along the way. `offset` is
+  // the per-axis distance from the query to the node's box and
+  // `box_distance` its squared norm.
+  template <typename Visitor>
+  void search(std::size_t begin, std::size_t end, const T *query, T *offset,
+              T box_distance, Visitor &visitor) const;
+  void radiusRange(const PointView3T<T> &queries, std::size_t begin,
+                   std::size_t end, T radius, std::size_t *counts,
+                   std::vector<NeighborT<T>> &neighbors) const;
+
+  std::vector<Entry> entries_;
+};
+
+typedef KdTreeT<double> KdTree;
+typedef KdTreeT<float> KdTreef;
+
+extern template class KdTreeT<float>;
+extern template class KdTreeT<double>;
+
+} // namespace cppcourse
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+
+#include "isometry.h"
+
+namespace cppcourse {
+
+// Element of se(3): `rho` is the translational part and `phi` the rotation
+// vector (axis times angle, in radians).
+template <typename T> struct TwistT {
+  typedef T Scalar;
+
+  constexpr TwistT() : rho(), phi() {}
+  constexpr TwistT(const Vector3T<T> &rho_, const Vector3T<T> &phi_)
+      : rho(rho_), phi(phi_) {}
+
+  constexpr TwistT operator+(const TwistT &rhs) const {
+    return TwistT(rho + rhs.rho, phi + rhs.phi);
+  }
+  constexpr TwistT operator-(const TwistT &rhs) const {
+    return TwistT(rho - rhs.rho, phi - rhs.phi);
+  }
+  constexpr TwistT operator*(const T &factor) const {
+    return TwistT(rho * factor, phi * factor);
+  }
+  constexpr bool operator==(const TwistT &rhs) const {
+    return rho == rhs.rho && phi == rhs.phi;
+  }
+
+  Vector3T<T> rho;
+  Vector3T<T> phi;
+};
+
+template <typename T>
+inline std::ostream &operator<<(std::ostream &ss, const TwistT<T> &twist) {
+  return ss << "[rho: " << twist.rho << ", phi: " << twist.phi << "]";
+}
+
+// 6x6 linear map on twists, stored as 3x3 blocks acting on (rho, phi).
+template <typename T> struct Matrix6T {
+  typedef T Scalar;
+
+  constexpr TwistT<T> operator*(const TwistT<T> &rhs) const {
+    return TwistT<T>(
+        Vector3T<T>(top_left.product(rhs.rho) + top_right.product(rhs.phi)),
+        Vector3T<T>(bottom_left.product(rhs.rho) +
+                    bottom_right.product(rhs.phi)));
+  }
+
+  Matrix3T<T> top_left;
+  Matrix3T<T> top_right;
+  Matrix3T<T> bottom_left;
+  Matrix3T<T> bottom_right;
+};
+
+static_assert(std::is_trivially_copyable<TwistT<double>>::value,
+              "TwistT must be trivially copyable.");
+
+typedef TwistT<double> Twist;
+typedef TwistT<float> Twistf;
+typedef Matrix6T<double> Matrix6;
+typedef Matrix6T<float> Matrix6f;
+
+// Exponential and logarithm maps of the rotation group and their Jacobians,
+// instantiated for float and double in lie.cc. Angles below a small
+// threshold switch to Taylor expansions of the Rodrigues coefficients, so
+// every function is smooth and exact through zero.
+namespace so3 {
+
+// Skew-symmetric matrix with hat(v) * w == v.cross(w).
+template <typename T> constexpr Matrix3T<T> hat(const Vector3T<T> &v) {
+  return Matrix3T<T>(Vector3T<T>(0, -v.z(), v.y()),
+                     Vector3T<T>(v.z(), 0, -v.x()),
+                     Vector3T<T>(-v.y(), v.x(), 0));
+}
+// Inverse of hat() on the skew-symmetric part of `m`.
+template <typename T> constexpr Vector3T<T> vee(const Matrix3T<T> &m) {
+  return Vector3T<T>((m(2, 1) - m(1, 2)) / 2, (m(0, 2) - m(2, 0)) / 2,
+                     (m(1, 0) - m(0, 1)) / 2);
+}
+
+// Rotation of |phi| radians around phi / |phi|.
+template <typename T> Matrix3T<T> exp(const Vector3T<T> &phi);
+// Rotation vector of an orthonormal `rotation`, with an angle in [0, pi].
+template <typename T> Vector3T<T> log(const Matrix3T<T> &rotation);
+
+// Jacobians relating a perturbation of phi to the resulting rotation
+// perturbation on the left (exp(phi + d) ~ exp(Jl d) exp(phi)) or the right
+// (exp(phi + d) ~ exp(phi) exp(Jr d)).
+template <typename T> Matrix3T<T> leftJacobian(const Vector3T<T> &phi);
+template <typename T> Matrix3T<T> rightJacobian(const Vector3T<T> &phi);
+template <typename T> Matrix3T<T> leftJacobianInverse(const Vector3T<T> &phi);
+template <typename T> Matrix3T<T> rightJacobianInverse(const Vector3T<T> &phi);
+
+// exp() of `count` rotation vectors.
+template <typename T>
+void expBatch(const Vector3T<T> *phi, Matrix3T<T> *rotations,
+              std::size_t count);
+
+} // namespace so3
+
+// Exponential and logarithm maps of rigid transforms, with twists ordered as
+// (rho, phi). Instantiated for float and double in lie.cc.
+namespace se3 {
+
+template <typename T> IsometryT<T> exp(const TwistT<T> &twist);
+template <typename T> TwistT<T> log(const IsometryT<T> &pose);
+
+// Maps twists expressed in the frame of `pose` to its parent frame:
+// exp(adjoint(pose) * xi) == pose * exp(xi) * pose.inverse().
+template <typename T> Matrix6T<T> adjoint(const IsometryT<T> &pose);
+
+// Right perturbation `pose * exp(delta)` and its inverse, so that
+// boxplus(pose, boxminus(other, pose)) == other.
+template <typename T>
+IsometryT<T> boxplus(const IsometryT<T> &pose, const TwistT<T> &delta);
+template <typename T>
+TwistT<T> boxminus(const IsometryT<T> &other, const IsometryT<T> &pose);
+
+// exp() and log() of `count` elements. The loops have no data-dependent
+// branches besides the log() angle checks.
+template <typename T>
+void expBatch(const TwistT<T> *twists, IsometryT<T> *poses, std::size_t count);
+template <typename T>
+void logBatch(const IsometryT<T> *poses, TwistT<T> *twists, std::size_t count);
+
+} // namespace se3
+
+} // namespace cppcourse
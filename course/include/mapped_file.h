@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace cppcourse {
+
+// Read-only, private memory mapping of a whole file. Pages are read from
+// disk when first touched.
+class MappedFile {
+public:
+  MappedFile() = default;
+  // Throws std::runtime_error if the file cannot be opened or mapped.
+  explicit MappedFile(const std::string &path);
+  MappedFile(MappedFile &&other);
+  MappedFile &operator=(MappedFile &&other);
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile();
+
+  // Null for an empty file.
+  const unsigned char *data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  void unmap();
+
+  const unsigned char *data_{};
+  std::size_t size_{};
+};
+
+} // namespace cppcourse
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "isometry.h"
+#include "span.h"
+
+namespace cppcourse {
+
+// Coordinates of points stored elsewhere, e.g. interleaved with other fields
+// in a memory-mapped file, as three strided views of the same length.
+template <typename T> struct PointView3T {
+  typedef T Scalar;
+
+  std::size_t size() const { return x.size(); }
+  bool empty() const { return x.empty(); }
+  Vector3T<T> operator[](std::size_t index) const {
+    return Vector3T<T>(x[index], y[index], z[index]);
+  }
+  // Points [offset, offset + count).
+  PointView3T subview(std::size_t offset, std::size_t count) const {
+    return PointView3T{x.subspan(offset, count), y.subspan(offset, count),
+                       z.subspan(offset, count)};
+  }
+
+  StridedSpan<T> x, y, z;
+};
+
+typedef PointView3T<double> PointView3;
+typedef PointView3T<float> PointView3f;
+
+// Structure-of-arrays container of 3D points: x, y and z coordinates live in
+// three separate contiguous arrays so batch operations stream through memory
+// with unit stride. Instantiated for float and double in point_cloud.cc.
+template <typename T> class PointCloud3T {
+public:
+  typedef T Scalar;
+
+  PointCloud3T() {}
+  explicit PointCloud3T(std::size_t size) : x_(size), y_(size), z_(size) {}
+  PointCloud3T(const std::vector<Vector3T<T>> &points);
+
+  std::size_t size() const { return x_.size(); }
+  bool empty() const { return x_.empty(); }
+  void resize(std::size_t size);
+  void reserve(std::size_t capacity);
+  void clear();
+  void push_back(const Vector3T<T> &point);
+
+  Vector3T<T> operator[](std::size_t index) const {
+    return Vector3T<T>(x_[index], y_[index], z_[index]);
+  }
+  void set(std::size_t index, const Vector3T<T> &point);
+  std::vector<Vector3T<T>> toVector() const;
+  PointView3T<T> view() const {
+    return PointView3T<T>{StridedSpan<T>(x(), size()),
+                          StridedSpan<T>(y(), size()),
+                          StridedSpan<T>(z(), size())};
+  }
+
+  T *x() { return x_.data(); }
+  const T *x() const { return x_.data(); }
+  T *y() { return y_.data(); }
+  const T *y() const { return y_.data(); }
+  T *z() { return z_.data(); }
+  const T *z() const { return z_.data(); }
+
+private:
+  std::vector<T> x_, y_, z_;
+};
+
+typedef PointCloud3T<double> PointCloud3;
+typedef PointCloud3T<float> PointCloud3f;
+
+// Applies a double precision pose, e.g. the result of composing a chain of
+// double precision poses, to a single precision cloud. The pose is rounded to
+// float once, so the per-point work runs at float width.
+void transform(const Isometry &pose, const PointCloud3f &in, PointCloud3f &out);
+
+} // namespace cppcourse
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mapped_file.h"
+#include "point_cloud.h"
+#include "span.h"
+
+namespace cppcourse {
+
+enum class PointFileFormat { kPly, kPcd };
+
+// One field of the point records of a PLY or PCD file.
+struct PointField {
+  std::string name;
+  // Bytes from the start of a record.
+  std::size_t offset;
+  // Bytes of one value.
+  std::size_t size;
+  // 'F' floating point, 'I' signed or 'U' unsigned integer, as in PCD.
+  char type;
+  // Values in the field; PLY fields always hold one.
+  std::size_t count;
+};
+
+// Memory-mapped binary PLY (binary_little_endian) or PCD (DATA binary)
+// point file. The points are not parsed: fields are exposed as strided views
+// straight into the mapping, which stay valid while the MappedPointFile
+// lives, and can be handed to IsometryT::transform() as they are.
+//
+// PLY files may have elements before the vertex element as long as they
+// have no list properties; elements after it are ignored.
+class MappedPointFile {
+public:
+  // Throws std::runtime_error if the file cannot be mapped and
+  // std::invalid_argument if it is not a supported file, or its x, y and z
+  // fields are missing or not all float or all double.
+  explicit MappedPointFile(const std::string &path);
+
+  PointFileFormat format() const { return format_; }
+  std::size_t size() const { return count_; }
+  // Bytes per point record.
+  std::size_t stride() const { return stride_; }
+  // Bytes of each of the x, y and z values, 4 or 8.
+  std::size_t scalarSize() const { return scalar_size_; }
+  const std::vector<PointField> &fields() const { return fields_; }
+  // Throws std::out_of_range if there is no field called `name`.
+  const PointField &field(const std::string &name) const;
+
+  // First value of field `name` of every point. Throws std::out_of_range if
+  // there is no such field and std::invalid_argument if it does not hold
+  // values of type S.
+  template <typename S> StridedSpan<S> values(const std::string &name) const {
+    static_assert(std::is_arithmetic<S>::value, "Fields hold numbers.");
+    const char type = std::is_floating_point<S>::value
+                          ? 'F'
+                          : (std::is_signed<S>::value ? 'I' : 'U');
+    const PointField &f = checkedField(name, type, sizeof(S));
+    return StridedSpan<S>(file_.data() + data_offset_ + f.offset, count_,
+                          stride_);
+  }
+  // Throws std::invalid_argument unless sizeof(T) == scalarSize().
+  template <typename T> PointView3T<T> points() const {
+    return PointView3T<T>{values<T>("x"), values<T>("y"), values<T>("z")};
+  }
+
+private:
+  const PointField &checkedField(const std::string &name, char type,
+                                 std::size_t size) const;
+  void parsePly(const std::string &path);
+  void parsePcd(const std::string &path);
+
+  MappedFile file_;
+  PointFileFormat format_{};
+  std::size_t count_{};
+  std::size_t stride_{};
+  std::size_t scalar_size_{};
+  std::size_t data_offset_{};
+  std::vector<PointField> fields_;
+};
+
+// Streams x, y, z points of scalar type T to a binary PLY or PCD file as
+// they arrive, without holding them. The header is written up front with
+// room for the point count, which close() fills in.
+template <typename T> class PointFileWriter {
+public:
+  // Throws std::runtime_error if the file cannot be created.
+  PointFileWriter(const std::string &path, PointFileFormat format);
+  // Closes the file if close() was not called, ignoring errors.
+  ~PointFileWriter();
+  PointFileWriter(const PointFileWriter &) = delete;
+  PointFileWriter &operator=(const PointFileWriter &) = delete;
+
+  void write(const Vector3T<T> *points, std::size_t count);
+  // E.g. a PointCloud3T through view(), or another file's points().
+  void write(const PointView3T<T> &points);
+  // Throws std::runtime_error if anything failed to be written. Later
+  // calls do nothing.
+  void close();
+
+  // Points written so far.
+  std::size_t size() const { return count_; }
+
+private:
+  void flush();
+
+  std::ofstream out_;
+  std::size_t count_{};
+  // Where the header keeps the point count, padded with spaces.
+  std::vector<std::streampos> count_positions_;
+  std::vector<T> buffer_;
+};
+
+extern template class PointFileWriter<float>;
+extern template class PointFileWriter<double>;
+
+} // namespace cppcourse
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "isometry.h"
+
+namespace cppcourse {
+
+// Compressed pose logs: sequences of Isometry, e.g. a robot's trajectory
+// sampled at 100 Hz, stored in a few bytes per pose instead of 96.
+//
+// Each pose becomes seven integers: its translation quantized to
+// `translation_step`, and its rotation in smallest-three form, i.e. the
+// unit quaternion with its largest component made positive and dropped,
+// the other three quantized to `rotation_bits`, plus the index of the
+// dropped one. Poses are grouped in chunks of `chunk_size`. Within a chunk,
+// each integer is stored as its deltas from pose to pose, offset by their
+// minimum and bit-packed at the width of the largest, so slow motion costs
+// only a few bits per pose.
+//
+// Layout, all integers little-endian:
+//   offset  0  char[8]   magic "CPPCPLOG"
+//           8  uint32    format version (kPoseLogVersion)
+//          12  uint32    rotation bits
+//          16  float64   translation step
+//          24  uint64    pose count
+//          32  uint64    chunk size
+//          40  uint64    index offset
+//          48  zeros up to 64
+// followed by the chunks and, at the index offset, the offset of each
+// chunk as a uint64. A chunk starts with, per integer, its value before
+// the chunk's first pose and its minimum delta as zigzag varints, then its
+// delta width in bits as a byte. Then come, per integer in turn, its
+// deltas minus the minimum, the first delta being the minimum itself,
+// packed in groups of 8 that take exactly `width` bytes each, zero-padded.
+const std::uint32_t kPoseLogVersion{1};
+const std::size_t kPoseLogHeaderSize{64};
+
+struct PoseLogOptions {
+  // Each translation coordinate decodes within half a step of the original.
+  double translation_step{1e-4};
+  // Bits per quaternion component, from 4 to 30.
+  int rotation_bits{16};
+  // Poses per chunk, the unit of random access.
+  std::size_t chunk_size{1024};
+
+  double maxTranslationError() const { return translation_step / 2; }
+  // Bound, in radians, on the angle between the original and the decoded
+  // rotation: about 4.9 / (2^rotation_bits - 1).
+  double maxRotationError() const;
+};
+
+// Builds a pose log in memory. Poses are quantized as they are appended;
+// a chunk is encoded each time one fills up.
+class PoseLogEncoder {
+public:
+  // Throws std::invalid_argument if the options are out of range.
+  explicit PoseLogEncoder(const PoseLogOptions &options = PoseLogOptions());
+
+  // Throws std::invalid_argument if a translation coordinate is not finite
+  // or more than 2^51 steps from the origin.
+  void append(const Isometry *poses, std::size_t count);
+  void append(const Isometryf *poses, std::size_t count);
+
+  // Poses appended since construction or the last finish().
+  std::size_t size() const { return count_; }
+
+  // Encodes the last, partial chunk and returns the complete log, e.g. to
+  // be written to a file. The encoder then starts over with a new log.
+  std::vector<std::uint8_t> finish();
+
+private:
+  template <typename T>
+  void appendPoses(const IsometryT<T> *poses, std::size_t count);
+  void encodeChunk();
+
+  PoseLogOptions options_;
+  std::vector<std::uint8_t> bytes_;
+  std::vector<std::uint64_t> chunk_offsets_;
+  // The integers of the poses of the chunk being filled, one array of
+  // chunk_size per integer.
+  std::vector<std::int64_t> pending_;
+  std::size_t pending_count_{};
+  std::size_t count_{};
+};
+
+// Random-access reader of a pose log held in memory, e.g. finish()'s
+// output or a MappedFile. It does not copy the log, which must outlive it.
+class PoseLogDecoder {
+public:
+  // Checks the header and the chunk index. Throws std::invalid_argument if
+  // they are malformed.
+  PoseLogDecoder(const void *data, std::size_t size);
+  explicit PoseLogDecoder(const std::vector<std::uint8_t> &bytes)
+      : PoseLogDecoder(bytes.data(), bytes.size()) {}
+
+  std::size_t size() const { return count_; }
+  std::size_t chunkCount() const { return chunk_count_; }
+  const PoseLogOptions &options() const { return options_; }
+
+  // Decodes poses [first, first + count) into `out`, touching only the
+  // chunks that hold them. Throws std::out_of_range if they are not all in
+  // the log and std::invalid_argument if a chunk is malformed.
+  template <typename T>
+  void decode(std::size_t first, std::size_t count, IsometryT<T> *out) const;
+  // A single pose, decoding the start of its chunk.
+  template <typename T> IsometryT<T> at(std::size_t index) const {
+    IsometryT<T> pose;
+    decode(index, 1, &pose);
+    return pose;
+  }
+
+private:
+  // Decodes poses [begin, end) of a chunk, counted from its start.
+  template <typename T>
+  void decodeChunk(std::size_t chunk, std::size_t begin, std::size_t end,
+                   IsometryT<T> *out) const;
+
+  const std::uint8_t *data_;
+  std::size_t size_;
+  PoseLogOptions options_;
+  std::size_t count_;
+  std::size_t chunk_count_;
+  std::size_t index_offset_;
+};
+
+} // namespace cppcourse
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "isometry.h"
+
+namespace cppcourse {
+
+// Composition of any contiguous range of a sequence of pose increments in
+// O(log n), e.g. the relative pose between two odometry stamps: with
+// absolute poses P_k = P_0 * inc[1] * ... * inc[k], P_i^-1 * P_j is
+// compose(i + 1, j + 1). Increments can be replaced one at a time, also in
+// O(log n).
+//
+// Bottom-up segment tree in a single array of 2n poses: the increments sit
+// in the second half and node k holds node(2k) * node(2k + 1). Composition
+// is not commutative, so queries keep the products of the left and right
+// boundaries apart and join them at the end.
+template <typename T> class PoseSegmentTreeT {
+public:
+  typedef T Scalar;
+
+  PoseSegmentTreeT() = default;
+  PoseSegmentTreeT(const IsometryT<T> *increments, std::size_t count);
+  explicit PoseSegmentTreeT(const std::vector<IsometryT<T>> &increments)
+      : PoseSegmentTreeT(increments.data(), increments.size()) {}
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  // Bytes held by the tree, the copy of the increments included.
+  std::size_t memoryBytes() const {
+    return nodes_.capacity() * sizeof(IsometryT<T>);
+  }
+
+  // Throws std::out_of_range if `index` >= size().
+  const IsometryT<T> &increment(std::size_t index) const;
+  void update(std::size_t index, const IsometryT<T> &increment);
+
+  // increments[begin] * ... * increments[end - 1], identity for an empty
+  // range. Throws std::out_of_range unless begin <= end <= size().
+  IsometryT<T> compose(std::size_t begin, std::size_t end) const;
+
+private:
+  std::size_t size_{};
+  std::vector<IsometryT<T>> nodes_;
+};
+
+typedef PoseSegmentTreeT<double> PoseSegmentTree;
+typedef PoseSegmentTreeT<float> PoseSegmentTreef;
+
+extern template class PoseSegmentTreeT<float>;
+extern template class PoseSegmentTreeT<double>;
+
+} // namespace cppcourse
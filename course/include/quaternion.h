@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+
+#include "isometry.h"
+
+namespace cppcourse {
+
+// Rotation quaternion w + xi + yj + zk. Instantiated for float and double in
+// quaternion.cc. Rotations are represented by unit quaternions; operations
+// that build one from scratch return it normalized, while composition
+// preserves the norm up to rounding (see normalized()).
+template <typename T> class QuaternionT {
+public:
+  typedef T Scalar;
+
+  constexpr QuaternionT(const T &w = 1., const T &x = 0., const T &y = 0.,
+                        const T &z = 0.)
+      : data_{w, x, y, z} {}
+
+  // Rotation of `angle` radians around the unit vector `axis`.
+  static QuaternionT FromAxisAngle(const Vector3T<T> &axis, const T &angle) {
+    const T half = angle / 2;
+    const T s = std::sin(half);
+    return QuaternionT(std::cos(half), axis.x() * s, axis.y() * s,
+                       axis.z() * s);
+  }
+  // Quaternion of an orthonormal rotation matrix (Shepperd's method).
+  static QuaternionT FromRotation(const Matrix3T<T> &rotation);
+
+  constexpr const T &w() const { return data_[0]; }
+  constexpr const T &x() const { return data_[1]; }
+  constexpr const T &y() const { return data_[2]; }
+  constexpr const T &z() const { return data_[3]; }
+  constexpr Vector3T<T> vec() const {
+    return Vector3T<T>(data_[1], data_[2], data_[3]);
+  }
+
+  // Hamilton product: rotates by `rhs` first, then by *this. 16 multiplies.
+  constexpr QuaternionT operator*(const QuaternionT &rhs) const {
+    return QuaternionT(w() * rhs.w() - x() * rhs.x() - y() * rhs.y() -
+                           z() * rhs.z(),
+                       w() * rhs.x() + x() * rhs.w() + y() * rhs.z() -
+                           z() * rhs.y(),
+                       w() * rhs.y() - x() * rhs.z() + y() * rhs.w() +
+                           z() * rhs.x(),
+                       w() * rhs.z() + x() * rhs.y() - y() * rhs.x() +
+                           z() * rhs.w());
+  }
+  QuaternionT compose(const QuaternionT &rhs) const { return (*this * rhs); }
+  // Inverse rotation for unit quaternions.
+  constexpr QuaternionT conjugate() const {
+    return QuaternionT(w(), -x(), -y(), -z());
+  }
+  constexpr T squaredNorm() const {
+    return w() * w() + x() * x() + y() * y() + z() * z();
+  }
+  T norm() const { return std::sqrt(squaredNorm()); }
+  QuaternionT normalized() const {
+    const T inverse_norm = T(1) / norm();
+    return QuaternionT(w() * inverse_norm, x() * inverse_norm,
+                       y() * inverse_norm, z() * inverse_norm);
+  }
+
+  // Constant angular velocity interpolation from *this (t = 0) to `other`
+  // (t = 1) along the shorter arc. Both must be unit quaternions.
+  QuaternionT slerp(const QuaternionT &other, const T &t) const;
+
+  // Rotates `v`, assuming a unit quaternion: v + w t + q x t, t = 2 q x v.
+  constexpr Vector3T<T> rotate(const Vector3T<T> &v) const {
+    const Vector3T<T> q = vec();
+    const Vector3T<T> t = q.cross(v) * T(2);
+    return v + t * w() + q.cross(t);
+  }
+  constexpr Vector3T<T> operator*(const Vector3T<T> &v) const {
+    return rotate(v);
+  }
+
+  constexpr Matrix3T<T> toRotation() const {
+    const T xx = x() * x(), yy = y() * y(), zz = z() * z();
+    const T xy = x() * y(), xz = x() * z(), yz = y() * z();
+    const T wx = w() * x(), wy = w() * y(), wz = w() * z();
+    return Matrix3T<T>(
+        Vector3T<T>(1 - 2 * (yy + zz), 2 * (xy - wz), 2 * (xz + wy)),
+        Vector3T<T>(2 * (xy + wz), 1 - 2 * (xx + zz), 2 * (yz - wx)),
+        Vector3T<T>(2 * (xz - wy), 2 * (yz + wx), 1 - 2 * (xx + yy)));
+  }
+
+  constexpr bool operator==(const QuaternionT &rhs) const {
+    return w() == rhs.w() && x() == rhs.x() && y() == rhs.y() &&
+           z() == rhs.z();
+  }
+  constexpr bool operator!=(const QuaternionT &rhs) const {
+    return !(*this == rhs);
+  }
+
+  template <typename U> constexpr QuaternionT<U> cast() const {
+    return QuaternionT<U>(static_cast<U>(w()), static_cast<U>(x()),
+                          static_cast<U>(y()), static_cast<U>(z()));
+  }
+
+  static const QuaternionT kIdentity;
+
+private:
+  T data_[4];
+};
+
+template <typename T>
+constexpr QuaternionT<T> QuaternionT<T>::kIdentity{1., 0., 0., 0.};
+
+template <typename T>
+inline std::ostream &operator<<(std::ostream &ss, const QuaternionT<T> &q) {
+  return ss << "(w: " << q.w() << ", x: " << q.x() << ", y: " << q.y()
+            << ", z: " << q.z() << ")";
+}
+
+// Rigid transform storing its rotation as a unit quaternion: 7 scalars
+// instead of IsometryT's 12, and 16 multiplies per rotation composition
+// instead of 27. Prefer it for long pose chains and pose logs; convert with
+// toIsometry() before applying it to many points.
+template <typename T> class IsometryQT {
+public:
+  typedef T Scalar;
+
+  constexpr IsometryQT() : rotation_(), translation_() {}
+  constexpr IsometryQT(const Vector3T<T> &trans, const QuaternionT<T> &rot)
+      : rotation_(rot), translation_(trans) {}
+  explicit IsometryQT(const IsometryT<T> &iso)
+      : rotation_(QuaternionT<T>::FromRotation(iso.rotation())),
+        translation_(iso.translation()) {}
+
+  constexpr Vector3T<T> operator*(const Vector3T<T> &rhs) const {
+    return rotation_.rotate(rhs) + translation_;
+  }
+  constexpr IsometryQT operator*(const IsometryQT &rhs) const {
+    return IsometryQT(rotation_.rotate(rhs.translation_) + translation_,
+                      rotation_ * rhs.rotation_);
+  }
+  constexpr IsometryQT inverse() const {
+    return IsometryQT(rotation_.conjugate().rotate(translation_) * T(-1),
+                      rotation_.conjugate());
+  }
+  IsometryQT compose(const IsometryQT &rhs) const { return (*this * rhs); }
+  Vector3T<T> transform(const Vector3T<T> &rhs) const { return (*this * rhs); }
+  // Renormalizes the rotation, e.g. every few thousand compositions.
+  IsometryQT normalized() const {
+    return IsometryQT(translation_, rotation_.normalized());
+  }
+  // Slerp of the rotation and linear interpolation of the translation.
+  IsometryQT interpolate(const IsometryQT &other, const T &t) const {
+    return IsometryQT(translation_ + (other.translation_ - translation_) * t,
+                      rotation_.slerp(other.rotation_, t));
+  }
+
+  constexpr IsometryT<T> toIsometry() const {
+    return IsometryT<T>(translation_, rotation_.toRotation());
+  }
+
+  constexpr bool operator==(const IsometryQT &rhs) const {
+    return rotation_ == rhs.rotation_ && translation_ == rhs.translation_;
+  }
+  constexpr const QuaternionT<T> &rotation() const { return rotation_; }
+  constexpr const Vector3T<T> &translation() const { return translation_; }
+
+  template <typename U> constexpr IsometryQT<U> cast() const {
+    return IsometryQT<U>(translation_.template cast<U>(),
+                         rotation_.template cast<U>());
+  }
+
+private:
+  QuaternionT<T> rotation_;
+  Vector3T<T> translation_;
+};
+
+template <typename T>
+inline std::ostream &operator<<(std::ostream &ss, const IsometryQT<T> &iso) {
+  return ss << "[T: " << iso.translation() << ", R:" << iso.rotation() << "]";
+}
+
+static_assert(std::is_trivially_copyable<IsometryQT<double>>::value,
+              "IsometryQT must be trivially copyable.");
+static_assert(sizeof(IsometryQT<double>) == 7 * sizeof(double),
+              "IsometryQT must be 7 packed scalars.");
+
+typedef QuaternionT<double> Quaternion;
+typedef QuaternionT<float> Quaternionf;
+typedef IsometryQT<double> IsometryQ;
+typedef IsometryQT<float> IsometryQf;
+
+extern template class QuaternionT<float>;
+extern template class QuaternionT<double>;
+extern template class IsometryQT<float>;
+extern template class IsometryQT<double>;
+
+} // namespace cppcourse
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "isometry.h"
+#include "point_cloud.h"
+
+namespace cppcourse {
+
+// Rigid registration of matched point pairs (Kabsch, i.e. Umeyama without
+// scale): the pose minimizing sum_i w_i |pose * source[i] - target[i]|^2,
+// so that target[i] ~ pose * source[i].
+//
+// One pass over the points accumulates, in double precision, the weighted
+// centroids and cross-covariance relative to the first pair, which keeps
+// points far from the origin (e.g. UTM coordinates) accurate. The pass
+// runs an AVX2 kernel when kernels::activeBackend() allows it, copying
+// strided coordinates to the stack a block at a time; its fused
+// multiply-adds may change the last bits of the result. The rotation comes
+// from svd() of the 3x3 cross-covariance and is always proper, also when
+// the best orthogonal fit is a reflection. Nothing is allocated.
+// Instantiated for float and double in registration.cc.
+//
+// When the points do not pin the rotation down, e.g. they are collinear,
+// one of the optimal poses is returned.
+//
+// Throws std::invalid_argument if the views differ in size, are empty, or
+// the weights do not add up to a positive number.
+template <typename T>
+IsometryT<T> estimateRigidTransform(const PointView3T<T> &source,
+                                    const PointView3T<T> &target);
+// `weights` holds source.size() non-negative weights.
+template <typename T>
+IsometryT<T> estimateRigidTransform(const PointView3T<T> &source,
+                                    const PointView3T<T> &target,
+                                    const T *weights);
+
+} // namespace cppcourse
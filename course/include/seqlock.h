@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "isometry.h"
+
+namespace cppcourse {
+
+// Single-writer, multi-reader cell for a trivially copyable value. Readers
+// never lock and never make the writer wait: they copy the value and retry
+// if a store overlapped the copy. The value is held as atomic 64-bit words,
+// so torn reads are detected rather than being data races.
+//
+// store() must not be called concurrently with itself; serialize writers
+// externally if there is more than one.
+template <typename T> class Seqlock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Seqlock needs a trivially copyable type.");
+
+public:
+  explicit Seqlock(const T &value = T()) { store(value); }
+  Seqlock(const Seqlock &) = delete;
+  Seqlock &operator=(const Seqlock &) = delete;
+
+  void store(const T &value) {
+    std::uint64_t words[kWords] = {};
+    std::memcpy(words, &value, sizeof(T));
+    const std::uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    // An odd sequence marks a store in progress.
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < kWords; ++i) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  T load() const {
+    std::uint64_t words[kWords];
+    for (;;) {
+      const std::uint64_t before = sequence_.load(std::memory_order_acquire);
+      if (before & 1) {
+        continue;
+      }
+      for (std::size_t i = 0; i < kWords; ++i) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == before) {
+        break;
+      }
+    }
+    T value;
+    std::memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+  // Number of completed stores, the constructor's included.
+  std::uint64_t version() const {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+private:
+  static const std::size_t kWords = (sizeof(T) + 7) / 8;
+
+  std::atomic<std::uint64_t> sequence_{0};
+  std::atomic<std::uint64_t> words_[kWords];
+};
+
+// Latest pose of a frame, published by one thread and read by many.
+typedef Seqlock<Isometry> PoseCell;
+
+} // namespace cppcourse
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "frame_graph.h"
+
+namespace cppcourse {
+
+// Publishes immutable FrameGraph snapshots to concurrent readers, RCU style.
+// Readers pin the current snapshot with a couple of atomic operations and
+// never lock or wait for the writer; publish() swaps in a new snapshot and
+// frees the previous one once the readers that may hold it are gone.
+//
+// Readers are counted per epoch parity: a reader increments the counter of
+// the current epoch and re-checks the epoch before touching the snapshot.
+// publish() swaps the pointer, advances the epoch and waits for the counter
+// of the previous epoch to drain.
+class SharedFrameGraph {
+public:
+  // A pinned snapshot. Keep it short-lived: publish() waits for it.
+  class Reader {
+  public:
+    Reader(Reader &&other);
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+    ~Reader();
+
+    const FrameGraph &operator*() const { return *graph_; }
+    const FrameGraph *operator->() const { return graph_; }
+
+  private:
+    friend class SharedFrameGraph;
+    Reader(const FrameGraph *graph, std::atomic<std::int64_t> *readers)
+        : graph_(graph), readers_(readers) {}
+
+    const FrameGraph *graph_;
+    std::atomic<std::int64_t> *readers_;
+  };
+
+  explicit SharedFrameGraph(const FrameGraph &graph = FrameGraph());
+  SharedFrameGraph(const SharedFrameGraph &) = delete;
+  SharedFrameGraph &operator=(const SharedFrameGraph &) = delete;
+  // No Reader may outlive the SharedFrameGraph.
+  ~SharedFrameGraph();
+
+  // Lock-free for readers; safe to call from any number of threads.
+  Reader read() const;
+
+  // Publishes a copy of `graph`, with every cached transform resolved so the
+  // snapshot is never written again. Concurrent publishers are serialized;
+  // each blocks until no reader can still see the snapshot it replaced.
+  void publish(const FrameGraph &graph);
+
+private:
+  std::atomic<const FrameGraph *> current_;
+  std::atomic<std::uint64_t> epoch_{0};
+  mutable std::atomic<std::int64_t> readers_[2];
+  std::mutex publish_mutex_;
+};
+
+} // namespace cppcourse
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "isometry.h"
+
+namespace cppcourse {
+
+// Composition of the last `capacity` pose increments, oldest first,
+// maintained in O(1) amortized time per push or pop, e.g. the motion over
+// the last K odometry ticks. Storage is allocated once in the constructor.
+//
+// Two-stack queue in a single ring buffer: the newer part of the window
+// holds the raw increments plus their running product, the older part
+// holds for every slot the product from it to the end of that part. Popping
+// from an empty older part first turns the newer part into an older one,
+// which touches every increment once, so each increment is composed a
+// constant number of times overall.
+template <typename T> class SlidingWindowComposerT {
+public:
+  typedef T Scalar;
+
+  // Throws std::invalid_argument if `capacity` is 0.
+  explicit SlidingWindowComposerT(std::size_t capacity);
+
+  // Appends the newest increment, dropping the oldest one when full.
+  void push(const IsometryT<T> &increment);
+  // Drops the oldest increment. Throws std::out_of_range when empty.
+  void pop();
+  void clear();
+
+  std::size_t size() const { return size_; }
+  std::size_t capacity() const { return slots_.size(); }
+  bool empty() const { return size_ == 0; }
+  bool full() const { return size_ == slots_.size(); }
+
+  // Product of the increments in the window, oldest first; identity when
+  // empty. O(1).
+  IsometryT<T> windowComposition() const;
+
+private:
+  std::size_t slot(std::size_t index) const {
+    const std::size_t position = head_ + index;
+    return position < slots_.size() ? position : position - slots_.size();
+  }
+  // Turns the newer part of the window into the older one.
+  void flip();
+
+  std::vector<IsometryT<T>> slots_;
+  // Slot of the oldest increment.
+  std::size_t head_{};
+  std::size_t size_{};
+  // The first `older_` increments are stored as suffix products.
+  std::size_t older_{};
+  // Product of the raw increments after the first `older_`.
+  IsometryT<T> newer_product_;
+};
+
+typedef SlidingWindowComposerT<double> SlidingWindowComposer;
+typedef SlidingWindowComposerT<float> SlidingWindowComposerf;
+
+extern template class SlidingWindowComposerT<float>;
+extern template class SlidingWindowComposerT<double>;
+
+} // namespace cppcourse
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace cppcourse {
+
+// Non-owning view of `size()` contiguous elements, e.g. an array inside a
+// memory-mapped file. Whoever owns the memory must outlive the span.
+template <typename T> class Span {
+public:
+  typedef T element_type;
+  typedef T *iterator;
+
+  constexpr Span() : data_(nullptr), size_(0) {}
+  constexpr Span(T *data, std::size_t size) : data_(data), size_(size) {}
+
+  constexpr T *data() const { return data_; }
+  constexpr std::size_t size() const { return size_; }
+  constexpr bool empty() const { return size_ == 0; }
+  constexpr T *begin() const { return data_; }
+  constexpr T *end() const { return data_ + size_; }
+
+  // Unchecked, like std::vector::operator[].
+  constexpr T &operator[](std::size_t index) const { return data_[index]; }
+  // Throws std::out_of_range if `index` >= size().
+  T &at(std::size_t index) const {
+    if (index >= size_) {
+      throw std::out_of_range("Span index out of range.");
+    }
+    return data_[index];
+  }
+  // Elements [offset, offset + count). Throws std::out_of_range if that is
+  // not inside the span.
+  Span subspan(std::size_t offset, std::size_t count) const {
+    if (offset > size_ || count > size_ - offset) {
+      throw std::out_of_range("Subspan out of range.");
+    }
+    return Span(data_ + offset, count);
+  }
+
+private:
+  T *data_;
+  std::size_t size_;
+};
+
+// Read-only view of `size()` values of type T placed `stride()` bytes
+// apart, e.g. one field of interleaved records. The values need not be
+// aligned, so they are returned by value.
+template <typename T> class StridedSpan {
+public:
+  typedef T value_type;
+
+  constexpr StridedSpan() : data_(nullptr), size_(0), stride_(sizeof(T)) {}
+  StridedSpan(const void *data, std::size_t size, std::size_t stride)
+      : data_(static_cast<const unsigned char *>(data)), size_(size),
+        stride_(stride) {}
+  // A dense array.
+  StridedSpan(const T *data, std::size_t size)
+      : StridedSpan(static_cast<const void *>(data), size, sizeof(T)) {}
+
+  const unsigned char *data() const { return data_; }
+  std::size_t size() const { return size_; }
+  std::size_t stride() const { return stride_; }
+  bool empty() const { return size_ == 0; }
+  // True when the values are adjacent and aligned, i.e. usable as a T*.
+  bool isContiguous() const {
+    return stride_ == sizeof(T) &&
+           reinterpret_cast<std::uintptr_t>(data_) % alignof(T) == 0;
+  }
+
+  // Unchecked.
+  T operator[](std::size_t index) const {
+    T value;
+    std::memcpy(&value, data_ + index * stride_, sizeof(T));
+    return value;
+  }
+  // Values [offset, offset + count). Throws std::out_of_range if that is
+  // not inside the span.
+  StridedSpan subspan(std::size_t offset, std::size_t count) const {
+    if (offset > size_ || count > size_ - offset) {
+      throw std::out_of_range("Subspan out of range.");
+    }
+    return StridedSpan(data_ + offset * stride_, count, stride_);
+  }
+
+private:
+  const unsigned char *data_;
+  std::size_t size_;
+  std::size_t stride_;
+};
+
+} // namespace cppcourse
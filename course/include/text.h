@@ -0,0 +1,109 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <system_error>
+
+#include "isometry.h"
+
+namespace cppcourse {
+
+// Plain-text Vector3, Matrix3 and Isometry values built on std::to_chars and
+// std::from_chars: the shortest text that parses back to the exact same
+// value, independent of the locale, and without touching any stream.
+//
+// An element is written as its scalars separated by `separator`: x y z for
+// vectors, the nine coefficients row-major for matrices, and the 3x4 [R|t]
+// row-major for isometries (r00 r01 r02 tx r10 ... tz, as in KITTI pose
+// files). Parsers skip blanks and separators between scalars.
+namespace text {
+
+template <typename Element> struct ElementScalars;
+template <typename T> struct ElementScalars<Vector3T<T>> {
+  typedef T Scalar;
+  static constexpr std::size_t kCount = 3;
+};
+template <typename T> struct ElementScalars<Matrix3T<T>> {
+  typedef T Scalar;
+  static constexpr std::size_t kCount = 9;
+};
+template <typename T> struct ElementScalars<IsometryT<T>> {
+  typedef T Scalar;
+  static constexpr std::size_t kCount = 12;
+};
+
+// Longest shortest-round-trip text of a scalar, e.g. -2.2250738585072014e-308.
+template <typename T> constexpr std::size_t maxScalarChars() {
+  return sizeof(T) == 4 ? 15 : 24;
+}
+// Upper bound of what format() writes for one element, plus one character
+// for the line break of formatLines().
+template <typename Element> constexpr std::size_t maxChars() {
+  return ElementScalars<Element>::kCount *
+         (maxScalarChars<typename ElementScalars<Element>::Scalar>() + 1);
+}
+
+// Writes `value` to [first, last) like std::to_chars: on success returns the
+// end of the text, otherwise {last, std::errc::value_too_large}.
+template <typename Element>
+std::to_chars_result format(char *first, char *last, const Element &value,
+                            char separator = ' ');
+// Reads one element like std::from_chars, after skipping leading blanks.
+// std::errc::invalid_argument means a scalar is missing or malformed and
+// std::errc::result_out_of_range that it does not fit the scalar type; `ptr`
+// is then where that scalar starts.
+template <typename Element>
+std::from_chars_result parse(const char *first, const char *last,
+                             Element &value, char separator = ' ');
+
+// The scalar-level calls behind format() and parse(), for records that mix
+// scalar types or are not one of the elements above, e.g. stamped poses.
+template <typename T>
+std::to_chars_result formatScalars(char *first, char *last, const T *scalars,
+                                   std::size_t count, char separator = ' ');
+template <typename T>
+std::from_chars_result parseScalars(const char *first, const char *last,
+                                    T *scalars, std::size_t count,
+                                    char separator = ' ');
+
+// Outcome of the bulk calls: where they stopped, how many elements they
+// handled and std::errc() if nothing went wrong.
+struct FormatResult {
+  char *ptr;
+  std::size_t count;
+  std::errc ec;
+};
+struct ParseResult {
+  const char *ptr;
+  std::size_t count;
+  std::errc ec;
+};
+
+// Writes one element per line into the caller's buffer. If it fills up,
+// stops after the last whole line with std::errc::value_too_large;
+// count * maxChars<Element>() bytes are always enough.
+template <typename Element>
+FormatResult formatLines(char *first, char *last, const Element *values,
+                         std::size_t count, char separator = ' ');
+// Reads up to `capacity` elements, one per line, skipping empty lines and
+// lines that start with '#'. Stops at `last`, at the first line that does
+// not hold exactly one element (with its error, `ptr` at that line) or once
+// `capacity` elements are read (`ptr` after the last one's line break). The
+// last line may lack its line break; "\r\n" line breaks are accepted.
+template <typename Element>
+ParseResult parseLines(const char *first, const char *last, Element *values,
+                       std::size_t capacity, char separator = ' ');
+
+// format() into a string, e.g. for logging.
+template <typename Element>
+std::string toString(const Element &value, char separator = ' ') {
+  char buffer[maxChars<Element>()];
+  return std::string(buffer,
+                     format(buffer, buffer + sizeof(buffer), value, separator)
+                         .ptr);
+}
+
+} // namespace text
+
+} // namespace cppcourse
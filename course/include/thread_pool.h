@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cppcourse {
+
+// Fixed set of worker threads with one task deque each. Workers pop from the
+// back of their own deque and, when it runs dry, steal from the front of the
+// others, so uneven chunks balance themselves. The thread that calls
+// parallelFor() works on the chunks too instead of sleeping, which also makes
+// nested parallelFor() calls from inside a chunk safe.
+class ThreadPool {
+public:
+  // `threads` is the parallelism of parallelFor(), the calling thread
+  // included: ThreadPool(1) starts no workers and runs everything on the
+  // caller. 0 picks std::thread::hardware_concurrency().
+  explicit ThreadPool(std::size_t threads = 0);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ~ThreadPool();
+
+  std::size_t threads() const { return queue_count_ + 1; }
+
+  // Runs `fn(begin, end)` over chunks of at most `grain` indices covering
+  // [0, count) and returns once all of them are done. If `fn` throws, the
+  // remaining chunks still run and the first exception is rethrown here.
+  void parallelFor(std::size_t count, std::size_t grain,
+                   const std::function<void(std::size_t, std::size_t)> &fn);
+
+  // Process-wide pool with hardware_concurrency() threads, created on first
+  // use, for library routines that are not handed a pool.
+  static ThreadPool &global();
+
+private:
+  struct Job;
+  struct Task {
+    Job *job;
+    std::size_t begin;
+    std::size_t end;
+  };
+  struct Queue {
+    std::mutex mutex;
+    std::vector<Task> tasks;
+    // Tasks before `front` were stolen.
+    std::size_t front{};
+  };
+
+  void workerLoop(std::size_t index);
+  // Own deque first (from the back), then steals from the others.
+  bool tryPop(std::size_t first_queue, Task &task);
+  static void run(const Task &task);
+
+  // One deque per worker; fixed before the first worker starts.
+  std::size_t queue_count_;
+  std::unique_ptr<Queue[]> queues_;
+  std::vector<std::thread> workers_;
+  // Queued but not yet popped tasks; workers sleep while it is zero.
+  std::atomic<std::size_t> queued_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  bool stop_{false};
+};
+
+} // namespace cppcourse
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+
+#include "isometry.h"
+#include "thread_pool.h"
+
+namespace cppcourse {
+
+// Prefix composition of relative pose increments into absolute poses, e.g.
+// odometry into a trajectory. Composition is associative, so the pooled
+// overloads run a blocked scan: every block first reduces its increments
+// to one pose, the block totals are scanned on the calling thread, and then
+// every block composes its own range starting from its offset.
+//
+// Long products of rotations slowly drift away from orthonormality. With a
+// nonzero `reorthonormalize_every` the running pose is re-orthonormalized
+// after every that many increments, counted from the start of the sequence.
+//
+// `poses` may alias `increments`. Results of the pooled overloads match the
+// serial ones up to rounding.
+namespace trajectory {
+
+// poses[i] = origin * increments[0] * ... * increments[i].
+template <typename T>
+void inclusiveScan(const IsometryT<T> *increments, IsometryT<T> *poses,
+                   std::size_t count,
+                   const IsometryT<T> &origin = IsometryT<T>(),
+                   std::size_t reorthonormalize_every = 0);
+template <typename T>
+void inclusiveScan(const IsometryT<T> *increments, IsometryT<T> *poses,
+                   std::size_t count, ThreadPool &pool,
+                   const IsometryT<T> &origin = IsometryT<T>(),
+                   std::size_t reorthonormalize_every = 0);
+
+// poses[0] = origin and poses[i] = origin * increments[0] * ... *
+// increments[i - 1]; the last increment only affects the returned pose,
+// which is the inclusive end of the trajectory.
+template <typename T>
+IsometryT<T> exclusiveScan(const IsometryT<T> *increments, IsometryT<T> *poses,
+                           std::size_t count,
+                           const IsometryT<T> &origin = IsometryT<T>(),
+                           std::size_t reorthonormalize_every = 0);
+template <typename T>
+IsometryT<T> exclusiveScan(const IsometryT<T> *increments, IsometryT<T> *poses,
+                           std::size_t count, ThreadPool &pool,
+                           const IsometryT<T> &origin = IsometryT<T>(),
+                           std::size_t reorthonormalize_every = 0);
+
+} // namespace trajectory
+
+} // namespace cppcourse
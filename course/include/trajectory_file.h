@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "isometry.h"
+#include "span.h"
+
+namespace cppcourse {
+
+// Text trajectory formats, one pose per line:
+// - kTum: "timestamp tx ty tz qx qy qz qw", as in the TUM RGB-D benchmark.
+// - kKitti: the 3x4 [R|t] row-major, as in the KITTI odometry benchmark.
+// Empty lines and lines starting with '#' are skipped when reading.
+enum class TrajectoryFormat { kTum, kKitti };
+
+// Reads a trajectory file in chunks of at most chunkSize() poses, so memory
+// stays the same however long the file is: a read buffer and one chunk.
+// Pull the next chunk with next() and look at it through poses() and
+// stamps() until the following call:
+//
+//   TrajectoryReader<double> reader(path, TrajectoryFormat::kKitti);
+//   while (reader.next()) {
+//     for (const Isometry &pose : reader.poses()) { ... }
+//   }
+//
+// TUM quaternions are normalized before being turned into rotations; a
+// zero or non-finite one makes the record malformed.
+template <typename T> class TrajectoryReader {
+public:
+  static const std::size_t kDefaultChunkSize = 4096;
+
+  // Throws std::runtime_error if the file cannot be opened and
+  // std::invalid_argument if `chunk_size` is 0.
+  TrajectoryReader(const std::string &path, TrajectoryFormat format,
+                   std::size_t chunk_size = kDefaultChunkSize);
+  TrajectoryReader(const TrajectoryReader &) = delete;
+  TrajectoryReader &operator=(const TrajectoryReader &) = delete;
+
+  // Replaces the current chunk with the next poses of the file. Returns
+  // false, with an empty chunk, once there are none left. Throws
+  // std::invalid_argument, naming the file and line, at a malformed record
+  // and std::runtime_error if reading fails.
+  bool next();
+
+  Span<const IsometryT<T>> poses() const {
+    return Span<const IsometryT<T>>(poses_.data(), size_);
+  }
+  // Timestamps of poses(); empty for KITTI files, which have none.
+  Span<const double> stamps() const {
+    return Span<const double>(stamps_.data(),
+                              format_ == TrajectoryFormat::kTum ? size_ : 0);
+  }
+  std::size_t chunkSize() const { return poses_.size(); }
+  // Poses read so far, the current chunk included.
+  std::size_t count() const { return count_; }
+  // Bytes held by the reader, for the read buffer and the chunk.
+  std::size_t memoryBytes() const;
+
+private:
+  // End of the last whole line in the buffer, or of the data at the end of
+  // the file.
+  const char *recordsEnd() const;
+  // Moves the unread data to the front and reads more after it, growing the
+  // buffer if a single line does not fit.
+  void fill();
+  const char *parseTum(const char *first, const char *last);
+  [[noreturn]] void throwMalformed(const char *where) const;
+
+  std::string path_;
+  std::ifstream in_;
+  TrajectoryFormat format_;
+  std::vector<char> buffer_;
+  // Unread data is buffer_[begin_, end_).
+  std::size_t begin_{};
+  std::size_t end_{};
+  bool eof_{false};
+  // Line breaks before buffer_[0], for error messages.
+  std::size_t lines_{};
+  std::vector<IsometryT<T>> poses_;
+  std::vector<double> stamps_;
+  std::size_t size_{};
+  std::size_t count_{};
+};
+
+// Writes a trajectory file through a large buffer, a batch of poses at a
+// time, without holding the trajectory.
+template <typename T> class TrajectoryWriter {
+public:
+  // Throws std::runtime_error if the file cannot be created.
+  TrajectoryWriter(const std::string &path, TrajectoryFormat format);
+  // Closes the file if close() was not called, ignoring errors.
+  ~TrajectoryWriter();
+  TrajectoryWriter(const TrajectoryWriter &) = delete;
+  TrajectoryWriter &operator=(const TrajectoryWriter &) = delete;
+
+  // TUM records need timestamps: throws std::invalid_argument for TUM files.
+  void write(const IsometryT<T> *poses, std::size_t count);
+  // `stamps` is ignored for KITTI files.
+  void write(const double *stamps, const IsometryT<T> *poses,
+             std::size_t count);
+  // Throws std::runtime_error if anything failed to be written. Later
+  // calls do nothing.
+  void close();
+
+  // Poses written so far.
+  std::size_t size() const { return count_; }
+
+private:
+  void flush();
+
+  std::ofstream out_;
+  TrajectoryFormat format_;
+  std::vector<char> buffer_;
+  std::size_t used_{};
+  std::size_t count_{};
+};
+
+extern template class TrajectoryReader<float>;
+extern template class TrajectoryReader<double>;
+extern template class TrajectoryWriter<float>;
+extern template class TrajectoryWriter<double>;
+
+} // namespace cppcourse
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "isometry.h"
+#include "quaternion.h"
+
+namespace cppcourse {
+
+// Fixed-capacity history of time-stamped poses of one frame-graph edge, with
+// interpolated lookups. Samples live in a ring buffer allocated once in the
+// constructor; when it is full the oldest sample is overwritten. Poses are
+// kept as IsometryQ so interpolation does not convert rotation matrices.
+class TransformBuffer {
+public:
+  // Throws std::invalid_argument if `capacity` is smaller than 2.
+  explicit TransformBuffer(std::size_t capacity);
+
+  // Appends a sample. Stamps must be strictly increasing, otherwise
+  // std::invalid_argument is thrown.
+  void insert(double stamp, const Isometry &pose);
+  void clear() { size_ = 0; }
+
+  std::size_t size() const { return size_; }
+  std::size_t capacity() const { return samples_.size(); }
+  bool empty() const { return size_ == 0; }
+  // Precondition: !empty().
+  double oldestStamp() const { return sample(0).stamp; }
+  double latestStamp() const { return sample(size_ - 1).stamp; }
+
+  // Pose at `stamp`: slerp of the rotations and linear interpolation of the
+  // translations of the two neighbouring samples. Queries at or after the
+  // second newest sample take O(1), the rest a binary search. Throws
+  // std::out_of_range outside [oldestStamp(), latestStamp()].
+  Isometry lookup(double stamp) const;
+  // lookup() of `count` stamps into `poses`. Sorted stamps are answered with
+  // a single forward scan of the buffer.
+  void lookup(const double *stamps, Isometry *poses, std::size_t count) const;
+
+private:
+  struct Sample {
+    double stamp;
+    IsometryQ pose;
+  };
+
+  // The `index`-th oldest sample.
+  const Sample &sample(std::size_t index) const {
+    const std::size_t slot = head_ + index;
+    return samples_[slot < samples_.size() ? slot : slot - samples_.size()];
+  }
+  // Index of the newest sample not after `stamp`, which must be in range,
+  // clamped so that it always has a successor.
+  std::size_t segment(double stamp) const;
+  Isometry interpolate(std::size_t index, double stamp) const;
+  void checkRange(double stamp) const;
+
+  std::vector<Sample> samples_;
+  // Slot of the oldest sample.
+  std::size_t head_{};
+  std::size_t size_{};
+};
+
+} // namespace cppcourse
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+namespace cppcourse {
+namespace kernels {
+
+// Instruction sets the batch point kernels are written for, from the most
+// portable to the widest.
+enum class Backend { kScalar, kSse42, kAvx2, kAvx512 };
+
+// Environment variable that pins the backend, e.g. CPPCOURSE_SIMD_BACKEND=avx2.
+// Accepted values are the ones returned by backendName(). Unknown or
+// unsupported values are ignored and the best supported backend is used.
+extern const char *const kBackendEnvVar;
+
+// Affine map applied by the kernels, stored row-major as [R | t]:
+// {r00, r01, r02, tx, r10, r11, r12, ty, r20, r21, r22, tz}.
+template <typename T> struct AffineCoefficients {
+  T m[12];
+};
+
+// The vector backends use fused multiply-adds where available, so their
+// results may differ from the scalar backend. For each output coordinate the
+// difference is bounded by
+// tolerance<T>() * (|r0 * x| + |r1 * y| + |r2 * z| + |t|).
+// The SSE4.2 backend is bit-exact with the scalar one.
+template <typename T> constexpr T tolerance() {
+  return 8 * std::numeric_limits<T>::epsilon();
+}
+
+const char *backendName(Backend backend);
+// Returns false and leaves `backend` untouched when `name` is not known.
+bool parseBackend(const char *name, Backend *backend);
+bool isSupported(Backend backend);
+// Best supported backend, ignoring the environment override.
+Backend bestBackend();
+// Backend used by transformPoints(), selected once per process from the CPU
+// features and kBackendEnvVar.
+Backend activeBackend();
+
+// out = R * in + t for n points stored as separate coordinate arrays. The
+// output arrays may alias the input ones exactly (in-place transform).
+void transformPoints(const AffineCoefficients<double> &c, const double *x,
+                     const double *y, const double *z, double *ox, double *oy,
+                     double *oz, std::size_t n);
+void transformPoints(const AffineCoefficients<float> &c, const float *x,
+                     const float *y, const float *z, float *ox, float *oy,
+                     float *oz, std::size_t n);
+// Same, with an explicit backend. `backend` must be supported.
+void transformPoints(Backend backend, const AffineCoefficients<double> &c,
+                     const double *x, const double *y, const double *z,
+                     double *ox, double *oy, double *oz, std::size_t n);
+void transformPoints(Backend backend, const AffineCoefficients<float> &c,
+                     const float *x, const float *y, const float *z, float *ox,
+                     float *oy, float *oz, std::size_t n);
+
+} // namespace kernels
+} // namespace cppcourse
@@ -0,0 +1,177 @@
+#include "binary_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+
+namespace cppcourse {
+namespace binary {
+
+namespace {
+
+const char kMagic[8] = {'C', 'P', 'P', 'C', 'A', 'R', 'R', '\0'};
+// Elements byte-swapped per write() on big-endian hosts.
+const std::size_t kSwapChunk{4096};
+
+bool isLittleEndianHost() {
+  const std::uint32_t probe{1};
+  unsigned char first;
+  std::memcpy(&first, &probe, 1);
+  return first == 1;
+}
+
+template <typename Int> void storeLittle(unsigned char *bytes, Int value) {
+  for (std::size_t i = 0; i < sizeof(Int); ++i) {
+    bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+  }
+}
+
+template <typename Int> Int loadLittle(const unsigned char *bytes) {
+  Int value{};
+  for (std::size_t i = 0; i < sizeof(Int); ++i) {
+    value |= static_cast<Int>(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+// Element size in bytes of a known type, 0 for an unknown one.
+std::size_t elementSize(std::uint32_t type) {
+  switch (static_cast<ElementType>(type)) {
+  case ElementType::kVector3f:
+    return sizeof(Vector3f);
+  case ElementType::kVector3d:
+    return sizeof(Vector3);
+  case ElementType::kMatrix3f:
+    return sizeof(Matrix3f);
+  case ElementType::kMatrix3d:
+    return sizeof(Matrix3);
+  case ElementType::kIsometryf:
+    return sizeof(Isometryf);
+  case ElementType::kIsometryd:
+    return sizeof(Isometry);
+  }
+  return 0;
+}
+
+// Scalar size in bytes of a known type, 0 for an unknown one.
+std::size_t scalarSize(std::uint32_t type) {
+  switch (static_cast<ElementType>(type)) {
+  case ElementType::kVector3f:
+  case ElementType::kMatrix3f:
+  case ElementType::kIsometryf:
+    return sizeof(float);
+  case ElementType::kVector3d:
+  case ElementType::kMatrix3d:
+  case ElementType::kIsometryd:
+    return sizeof(double);
+  }
+  return 0;
+}
+
+std::runtime_error systemError(const std::string &what,
+                               const std::string &path) {
+  return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+template <typename Element>
+void writeArray(std::ostream &out, const Element *data, std::size_t count) {
+  typedef ElementTraits<Element> Traits;
+  typedef typename Traits::ScalarType Scalar;
+  unsigned char header[kHeaderSize] = {};
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  storeLittle<std::uint32_t>(header + 8, kFormatVersion);
+  storeLittle<std::uint32_t>(header + 12,
+                             static_cast<std::uint32_t>(Traits::kType));
+  storeLittle<std::uint32_t>(header + 16, sizeof(Scalar));
+  storeLittle<std::uint32_t>(header + 20, sizeof(Element));
+  storeLittle<std::uint64_t>(header + 24, count);
+  storeLittle<std::uint64_t>(header + 32, kHeaderSize);
+  out.write(reinterpret_cast<const char *>(header), kHeaderSize);
+
+  if (isLittleEndianHost()) {
+    out.write(reinterpret_cast<const char *>(data), count * sizeof(Element));
+  } else {
+    std::vector<unsigned char> swapped(kSwapChunk * sizeof(Element));
+    for (std::size_t first = 0; first < count; first += kSwapChunk) {
+      const std::size_t bytes =
+          std::min(kSwapChunk, count - first) * sizeof(Element);
+      std::memcpy(swapped.data(), data + first, bytes);
+      for (std::size_t s = 0; s < bytes; s += sizeof(Scalar)) {
+        std::reverse(swapped.begin() + s, swapped.begin() + s + sizeof(Scalar));
+      }
+      out.write(reinterpret_cast<const char *>(swapped.data()), bytes);
+    }
+  }
+  if (!out) {
+    throw std::runtime_error("Failed to write array file.");
+  }
+}
+
+template <typename Element>
+void writeArray(const std::string &path, const Element *data,
+                std::size_t count) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw systemError("Cannot create", path);
+  }
+  writeArray(out, data, count);
+  out.close();
+  if (!out) {
+    throw std::runtime_error("Failed to write " + path);
+  }
+}
+
+MappedArrayFile::MappedArrayFile(const std::string &path) {
+  if (!isLittleEndianHost()) {
+    throw std::runtime_error("Array files map only on little-endian hosts.");
+  }
+  file_ = MappedFile(path);
+  if (file_.size() < kHeaderSize) {
+    throw std::invalid_argument(path + " is too short for an array file.");
+  }
+
+  const unsigned char *header = file_.data();
+  version_ = loadLittle<std::uint32_t>(header + 8);
+  const std::uint32_t type = loadLittle<std::uint32_t>(header + 12);
+  const std::uint32_t scalar_size = loadLittle<std::uint32_t>(header + 16);
+  const std::uint32_t element_size = loadLittle<std::uint32_t>(header + 20);
+  const std::uint64_t count = loadLittle<std::uint64_t>(header + 24);
+  const std::uint64_t data_offset = loadLittle<std::uint64_t>(header + 32);
+  std::string problem;
+  if (std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+    problem = "is not an array file";
+  } else if (version_ == 0 || version_ > kFormatVersion) {
+    problem = "has unsupported format version " + std::to_string(version_);
+  } else if (elementSize(type) == 0 || elementSize(type) != element_size ||
+             scalarSize(type) != scalar_size) {
+    problem = "has an unknown element type";
+  } else if (data_offset < kHeaderSize || data_offset % kDataAlignment != 0 ||
+             data_offset > file_.size() ||
+             count > (file_.size() - data_offset) / element_size) {
+    problem = "is truncated or has a corrupt header";
+  }
+  if (!problem.empty()) {
+    throw std::invalid_argument(path + " " + problem + ".");
+  }
+  type_ = static_cast<ElementType>(type);
+  count_ = static_cast<std::size_t>(count);
+  data_offset_ = static_cast<std::size_t>(data_offset);
+}
+
+#define CPPCOURSE_INSTANTIATE_BINARY(Element)                                  \
+  template void writeArray(std::ostream &, const Element *, std::size_t);      \
+  template void writeArray(const std::string &, const Element *, std::size_t)
+CPPCOURSE_INSTANTIATE_BINARY(Vector3f);
+CPPCOURSE_INSTANTIATE_BINARY(Vector3);
+CPPCOURSE_INSTANTIATE_BINARY(Matrix3f);
+CPPCOURSE_INSTANTIATE_BINARY(Matrix3);
+CPPCOURSE_INSTANTIATE_BINARY(Isometryf);
+CPPCOURSE_INSTANTIATE_BINARY(Isometry);
+#undef CPPCOURSE_INSTANTIATE_BINARY
+
+} // namespace binary
+} // namespace cppcourse
@@ -0,0 +1,596 @@
+#include "decomposition.h"
+
+#include <cmath>
+#include <limits>
+
+#include "transform_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPPCOURSE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace cppcourse {
+
+template <typename T>
+Matrix3ArrayT<T>::Matrix3ArrayT(std::size_t size) {
+  resize(size);
+}
+
+template <typename T>
+Matrix3ArrayT<T>::Matrix3ArrayT(const std::vector<Matrix3T<T>> &matrices)
+    : Matrix3ArrayT(matrices.size()) {
+  for (std::size_t i = 0; i < matrices.size(); ++i) {
+    set(i, matrices[i]);
+  }
+}
+
+template <typename T> void Matrix3ArrayT<T>::resize(std::size_t size) {
+  for (std::vector<T> &element : elements_) {
+    element.resize(size);
+  }
+}
+
+template <typename T>
+Matrix3T<T> Matrix3ArrayT<T>::operator[](std::size_t index) const {
+  Matrix3T<T> output;
+  for (int k = 0; k < 9; ++k) {
+    output[k / 3][k % 3] = elements_[k][index];
+  }
+  return output;
+}
+
+template <typename T>
+void Matrix3ArrayT<T>::set(std::size_t index, const Matrix3T<T> &matrix) {
+  for (int k = 0; k < 9; ++k) {
+    elements_[k][index] = matrix(k / 3, k % 3);
+  }
+}
+
+namespace {
+
+int sweepCount(DecompositionAccuracy accuracy) {
+  return accuracy == DecompositionAccuracy::kFast ? 3 : 4;
+}
+
+// The kernels below are written once against these wrappers and run on one
+// matrix at a time (ScalarOps) or on one matrix per lane. None of them fuses
+// multiplies and adds, so every backend rounds the same way.
+template <typename T> struct ScalarOps {
+  typedef T Scalar;
+  typedef T Reg;
+  typedef bool Mask;
+  static const std::size_t kLanes = 1;
+  static Reg set1(T v) { return v; }
+  static Reg load(const T *p) { return *p; }
+  static void store(T *p, Reg v) { *p = v; }
+  static Reg add(Reg a, Reg b) { return a + b; }
+  static Reg sub(Reg a, Reg b) { return a - b; }
+  static Reg mul(Reg a, Reg b) { return a * b; }
+  static Reg div(Reg a, Reg b) { return a / b; }
+  static Reg sqrt(Reg a) { return std::sqrt(a); }
+  static Reg abs(Reg a) { return std::abs(a); }
+  // Same NaN and signed zero behavior as the vector max instructions.
+  static Reg max(Reg a, Reg b) { return a > b ? a : b; }
+  static Mask less(Reg a, Reg b) { return a < b; }
+  static Reg select(Mask m, Reg a, Reg b) { return m ? a : b; }
+};
+
+#ifdef CPPCOURSE_X86_KERNELS
+
+// Without "fma": GCC would otherwise contract the multiplies and adds of
+// the vector kernels and round differently from ScalarOps. flatten inlines
+// the generic kernels, and the wrappers they call, into the AVX2 drivers.
+#define CPPCOURSE_TARGET_AVX2 __attribute__((target("avx2")))
+#define CPPCOURSE_AVX2_DRIVER __attribute__((target("avx2"), flatten))
+
+template <typename T> struct Avx2Ops;
+template <> struct Avx2Ops<double> {
+  typedef double Scalar;
+  typedef __m256d Reg;
+  typedef __m256d Mask;
+  static const std::size_t kLanes = 4;
+  CPPCOURSE_TARGET_AVX2 static Reg set1(double v) { return _mm256_set1_pd(v); }
+  CPPCOURSE_TARGET_AVX2 static Reg load(const double *p) {
+    return _mm256_loadu_pd(p);
+  }
+  CPPCOURSE_TARGET_AVX2 static void store(double *p, Reg v) {
+    _mm256_storeu_pd(p, v);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg add(Reg a, Reg b) {
+    return _mm256_add_pd(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg sub(Reg a, Reg b) {
+    return _mm256_sub_pd(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg mul(Reg a, Reg b) {
+    return _mm256_mul_pd(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg div(Reg a, Reg b) {
+    return _mm256_div_pd(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg sqrt(Reg a) { return _mm256_sqrt_pd(a); }
+  CPPCOURSE_TARGET_AVX2 static Reg abs(Reg a) {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.), a);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg max(Reg a, Reg b) {
+    return _mm256_max_pd(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Mask less(Reg a, Reg b) {
+    return _mm256_cmp_pd(a, b, _CMP_LT_OQ);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg select(Mask m, Reg a, Reg b) {
+    return _mm256_blendv_pd(b, a, m);
+  }
+};
+template <> struct Avx2Ops<float> {
+  typedef float Scalar;
+  typedef __m256 Reg;
+  typedef __m256 Mask;
+  static const std::size_t kLanes = 8;
+  CPPCOURSE_TARGET_AVX2 static Reg set1(float v) { return _mm256_set1_ps(v); }
+  CPPCOURSE_TARGET_AVX2 static Reg load(const float *p) {
+    return _mm256_loadu_ps(p);
+  }
+  CPPCOURSE_TARGET_AVX2 static void store(float *p, Reg v) {
+    _mm256_storeu_ps(p, v);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg add(Reg a, Reg b) {
+    return _mm256_add_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg sub(Reg a, Reg b) {
+    return _mm256_sub_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg mul(Reg a, Reg b) {
+    return _mm256_mul_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg div(Reg a, Reg b) {
+    return _mm256_div_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg sqrt(Reg a) { return _mm256_sqrt_ps(a); }
+  CPPCOURSE_TARGET_AVX2 static Reg abs(Reg a) {
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg max(Reg a, Reg b) {
+    return _mm256_max_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Mask less(Reg a, Reg b) {
+    return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg select(Mask m, Reg a, Reg b) {
+    return _mm256_blendv_ps(b, a, m);
+  }
+};
+
+#endif // CPPCOURSE_X86_KERNELS
+
+// The generic kernels pass vector registers by value, which GCC notes as an
+// ABI change outside of AVX functions. They are only ever inlined into the
+// AVX2 drivers, so there is no call for the ABI to apply to.
+#ifdef CPPCOURSE_X86_KERNELS
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+// Two registers of Ops per value. A decomposition is one long chain of
+// divisions and square roots, so a single register of matrices leaves
+// those units idle most of the time; chains side by side fill the gaps.
+template <typename Ops> struct Interleaved {
+  typedef typename Ops::Scalar Scalar;
+  struct Reg {
+    typename Ops::Reg lo, hi;
+  };
+  struct Mask {
+    typename Ops::Mask lo, hi;
+  };
+  static const std::size_t kLanes = 2 * Ops::kLanes;
+  static Reg set1(Scalar v) { return Reg{Ops::set1(v), Ops::set1(v)}; }
+  static Reg load(const Scalar *p) {
+    return Reg{Ops::load(p), Ops::load(p + Ops::kLanes)};
+  }
+  static void store(Scalar *p, Reg v) {
+    Ops::store(p, v.lo);
+    Ops::store(p + Ops::kLanes, v.hi);
+  }
+  static Reg add(Reg a, Reg b) {
+    return Reg{Ops::add(a.lo, b.lo), Ops::add(a.hi, b.hi)};
+  }
+  static Reg sub(Reg a, Reg b) {
+    return Reg{Ops::sub(a.lo, b.lo), Ops::sub(a.hi, b.hi)};
+  }
+  static Reg mul(Reg a, Reg b) {
+    return Reg{Ops::mul(a.lo, b.lo), Ops::mul(a.hi, b.hi)};
+  }
+  static Reg div(Reg a, Reg b) {
+    return Reg{Ops::div(a.lo, b.lo), Ops::div(a.hi, b.hi)};
+  }
+  static Reg sqrt(Reg a) { return Reg{Ops::sqrt(a.lo), Ops::sqrt(a.hi)}; }
+  static Reg abs(Reg a) { return Reg{Ops::abs(a.lo), Ops::abs(a.hi)}; }
+  static Reg max(Reg a, Reg b) {
+    return Reg{Ops::max(a.lo, b.lo), Ops::max(a.hi, b.hi)};
+  }
+  static Mask less(Reg a, Reg b) {
+    return Mask{Ops::less(a.lo, b.lo), Ops::less(a.hi, b.hi)};
+  }
+  static Reg select(Mask m, Reg a, Reg b) {
+    return Reg{Ops::select(m.lo, a.lo, b.lo), Ops::select(m.hi, a.hi, b.hi)};
+  }
+};
+
+// Element arrays, row-major, of the matrices and results a kernel reads
+// and writes.
+template <typename T> struct EigenArrays {
+  const T *m[9];
+  T *values[3];
+  T *vectors[9];
+};
+template <typename T> struct SvdArrays {
+  const T *m[9];
+  T *u[9];
+  T *values[3];
+  T *v[9];
+};
+
+// Below this, squares may underflow and lose precision, so rotations
+// built from them would not be orthonormal. Matrices are scaled to a
+// largest element of 1 first, so smaller values are negligible.
+template <typename T> T tiny() {
+  return std::sqrt(std::numeric_limits<T>::min());
+}
+
+// Sets `scale` to the largest absolute value in `a` and divides `a` by it,
+// into [-1, 1]. A zero matrix stays zero.
+template <typename Ops, int N>
+inline void scaleInto(typename Ops::Reg (&a)[N], typename Ops::Reg &scale) {
+  typedef typename Ops::Scalar T;
+  scale = Ops::abs(a[0]);
+  for (int k = 1; k < N; ++k) {
+    scale = Ops::max(scale, Ops::abs(a[k]));
+  }
+  const typename Ops::Reg factor = Ops::div(
+      Ops::set1(1), Ops::max(scale, Ops::set1(std::numeric_limits<T>::min())));
+  for (int k = 0; k < N; ++k) {
+    a[k] = Ops::mul(a[k], factor);
+  }
+}
+
+// Jacobi rotation in the (p, q) plane zeroing `apq`, given the diagonal
+// elements app and aqq and the elements arp and arq of the third row. `v`
+// accumulates the rotations in its columns.
+template <typename Ops>
+inline void rotate(typename Ops::Reg &app, typename Ops::Reg &aqq,
+                   typename Ops::Reg &apq, typename Ops::Reg &arp,
+                   typename Ops::Reg &arq, typename Ops::Reg (&v)[9], int p,
+                   int q) {
+  typedef typename Ops::Reg Reg;
+  typedef typename Ops::Scalar T;
+  const Reg zero = Ops::set1(0), one = Ops::set1(1);
+  // Off-diagonal elements below epsilon (matrices are scaled to a largest
+  // element of 1) are within rounding error of the result. Leaving them be
+  // also keeps products of ever smaller elements from going subnormal,
+  // which is very slow on most CPUs.
+  const typename Ops::Mask rotates =
+      Ops::less(Ops::set1(std::numeric_limits<T>::epsilon()), Ops::abs(apq));
+  const Reg h = Ops::select(rotates, apq, zero);
+  // t = tan(angle) = numerator / root is the smaller root of
+  // t^2 + 2 t tau / h - 1 = 0, and c = cos(angle) = root / hypotenuse.
+  // One division serves t, c and s: divisions and square roots dominate
+  // the latency of a sweep.
+  const Reg tau = Ops::mul(Ops::sub(aqq, app), Ops::set1(0.5));
+  const Reg h2 = Ops::mul(h, h);
+  const Reg root =
+      Ops::add(Ops::abs(tau), Ops::sqrt(Ops::add(Ops::mul(tau, tau), h2)));
+  const Reg hypotenuse = Ops::sqrt(Ops::add(Ops::mul(root, root), h2));
+  const Reg numerator = Ops::select(Ops::less(tau, zero), Ops::sub(zero, h), h);
+  const Reg inverse = Ops::div(
+      one, Ops::max(Ops::mul(root, hypotenuse),
+                    Ops::set1(std::numeric_limits<T>::min())));
+  const Reg t = Ops::mul(Ops::mul(numerator, hypotenuse), inverse);
+  const Reg c =
+      Ops::select(rotates, Ops::mul(Ops::mul(root, root), inverse), one);
+  const Reg s = Ops::mul(Ops::mul(numerator, root), inverse);
+
+  const Reg shift = Ops::mul(t, h);
+  app = Ops::sub(app, shift);
+  aqq = Ops::add(aqq, shift);
+  apq = zero;
+  const Reg rp = arp, rq = arq;
+  arp = Ops::sub(Ops::mul(c, rp), Ops::mul(s, rq));
+  arq = Ops::add(Ops::mul(s, rp), Ops::mul(c, rq));
+  for (int k = 0; k < 3; ++k) {
+    const Reg vp = v[3 * k + p], vq = v[3 * k + q];
+    v[3 * k + p] = Ops::sub(Ops::mul(c, vp), Ops::mul(s, vq));
+    v[3 * k + q] = Ops::add(Ops::mul(s, vp), Ops::mul(c, vq));
+  }
+}
+
+// Cyclic Jacobi on the symmetric matrix with upper triangle
+// {a00, a01, a02, a11, a12, a22}: leaves its eigenvalues in `d` and the
+// eigenvectors in the columns of the rotation `v`, in no particular order.
+template <typename Ops>
+inline void jacobi(typename Ops::Reg (&a)[6], int sweeps,
+                   typename Ops::Reg (&d)[3], typename Ops::Reg (&v)[9]) {
+  for (int k = 0; k < 9; ++k) {
+    v[k] = Ops::set1(k % 4 == 0 ? 1 : 0);
+  }
+  d[0] = a[0];
+  d[1] = a[3];
+  d[2] = a[5];
+  for (int sweep = 0; sweep < sweeps; ++sweep) {
+    rotate<Ops>(d[0], d[1], a[1], a[2], a[4], v, 0, 1);
+    rotate<Ops>(d[0], d[2], a[2], a[1], a[4], v, 0, 2);
+    rotate<Ops>(d[1], d[2], a[4], a[1], a[2], v, 1, 2);
+  }
+}
+
+// Swaps eigenpairs i and j in the lanes where `swap` is set. Negating one
+// of the columns keeps `v` a rotation.
+template <typename Ops>
+inline void swapPairs(typename Ops::Mask swap, typename Ops::Reg (&d)[3],
+                      typename Ops::Reg (&v)[9], int i, int j) {
+  typedef typename Ops::Reg Reg;
+  const Reg di = d[i];
+  d[i] = Ops::select(swap, d[j], di);
+  d[j] = Ops::select(swap, di, d[j]);
+  for (int k = 0; k < 3; ++k) {
+    const Reg vi = v[3 * k + i];
+    v[3 * k + i] = Ops::select(swap, v[3 * k + j], vi);
+    v[3 * k + j] =
+        Ops::select(swap, Ops::sub(Ops::set1(0), vi), v[3 * k + j]);
+  }
+}
+
+// Givens rotation of rows p and q of `b` that zeroes b(q, col) and leaves
+// b(p, col) non-negative, accumulated into columns p and q of `u` so that
+// u * b does not change.
+template <typename Ops>
+inline void givens(typename Ops::Reg (&b)[9], typename Ops::Reg (&u)[9],
+                   int p, int q, int col) {
+  typedef typename Ops::Reg Reg;
+  typedef typename Ops::Scalar T;
+  const Reg x = b[3 * p + col], y = b[3 * q + col];
+  const Reg r = Ops::sqrt(Ops::add(Ops::mul(x, x), Ops::mul(y, y)));
+  const typename Ops::Mask rotates = Ops::less(Ops::set1(tiny<T>()), r);
+  const Reg inverse =
+      Ops::div(Ops::set1(1), Ops::max(r, Ops::set1(tiny<T>())));
+  const Reg c = Ops::select(rotates, Ops::mul(x, inverse), Ops::set1(1));
+  const Reg s = Ops::select(rotates, Ops::mul(y, inverse), Ops::set1(0));
+  for (int k = 0; k < 3; ++k) {
+    const Reg bp = b[3 * p + k], bq = b[3 * q + k];
+    b[3 * p + k] = Ops::add(Ops::mul(c, bp), Ops::mul(s, bq));
+    b[3 * q + k] = Ops::sub(Ops::mul(c, bq), Ops::mul(s, bp));
+    const Reg up = u[3 * k + p], uq = u[3 * k + q];
+    u[3 * k + p] = Ops::add(Ops::mul(c, up), Ops::mul(s, uq));
+    u[3 * k + q] = Ops::sub(Ops::mul(c, uq), Ops::mul(s, up));
+  }
+}
+
+// Decomposes matrices [i, i + Ops::kLanes).
+template <typename Ops>
+inline void eigenAt(const EigenArrays<typename Ops::Scalar> &arrays,
+                    std::size_t i, int sweeps) {
+  typedef typename Ops::Reg Reg;
+  Reg a[6] = {Ops::load(arrays.m[0] + i), Ops::load(arrays.m[1] + i),
+              Ops::load(arrays.m[2] + i), Ops::load(arrays.m[4] + i),
+              Ops::load(arrays.m[5] + i), Ops::load(arrays.m[8] + i)};
+  Reg scale;
+  scaleInto<Ops>(a, scale);
+  Reg d[3], v[9];
+  jacobi<Ops>(a, sweeps, d, v);
+  swapPairs<Ops>(Ops::less(d[1], d[0]), d, v, 0, 1);
+  swapPairs<Ops>(Ops::less(d[2], d[1]), d, v, 1, 2);
+  swapPairs<Ops>(Ops::less(d[1], d[0]), d, v, 0, 1);
+  for (int k = 0; k < 3; ++k) {
+    Ops::store(arrays.values[k] + i, Ops::mul(d[k], scale));
+  }
+  for (int k = 0; k < 9; ++k) {
+    Ops::store(arrays.vectors[k] + i, v[k]);
+  }
+}
+
+// McAdams et al., "Computing the singular value decomposition of 3x3
+// matrices with minimal branching and elementary floating point
+// operations": v diagonalizes m^T m, whose eigenvalues sort the columns of
+// b = m * v by decreasing norm, and a QR decomposition of b by Givens
+// rotations gives u and the singular values on the diagonal.
+template <typename Ops>
+inline void svdAt(const SvdArrays<typename Ops::Scalar> &arrays,
+                  std::size_t i, int sweeps) {
+  typedef typename Ops::Reg Reg;
+  Reg m[9];
+  for (int k = 0; k < 9; ++k) {
+    m[k] = Ops::load(arrays.m[k] + i);
+  }
+  Reg scale;
+  scaleInto<Ops>(m, scale);
+  Reg normal[6];
+  const int pairs[6][2] = {{0, 0}, {0, 1}, {0, 2}, {1, 1}, {1, 2}, {2, 2}};
+  for (int k = 0; k < 6; ++k) {
+    const int r = pairs[k][0], c = pairs[k][1];
+    normal[k] = Ops::add(Ops::add(Ops::mul(m[r], m[c]),
+                                  Ops::mul(m[3 + r], m[3 + c])),
+                         Ops::mul(m[6 + r], m[6 + c]));
+  }
+  Reg d[3], v[9];
+  jacobi<Ops>(normal, sweeps, d, v);
+  swapPairs<Ops>(Ops::less(d[0], d[1]), d, v, 0, 1);
+  swapPairs<Ops>(Ops::less(d[1], d[2]), d, v, 1, 2);
+  swapPairs<Ops>(Ops::less(d[0], d[1]), d, v, 0, 1);
+
+  Reg b[9], u[9];
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) {
+      b[3 * r + c] =
+          Ops::add(Ops::add(Ops::mul(m[3 * r], v[c]),
+                            Ops::mul(m[3 * r + 1], v[3 + c])),
+                   Ops::mul(m[3 * r + 2], v[6 + c]));
+      u[3 * r + c] = Ops::set1(r == c ? 1 : 0);
+    }
+  }
+  givens<Ops>(b, u, 0, 1, 0);
+  givens<Ops>(b, u, 0, 2, 0);
+  givens<Ops>(b, u, 1, 2, 1);
+  for (int k = 0; k < 3; ++k) {
+    Ops::store(arrays.values[k] + i, Ops::mul(b[4 * k], scale));
+  }
+  for (int k = 0; k < 9; ++k) {
+    Ops::store(arrays.u[k] + i, u[k]);
+    Ops::store(arrays.v[k] + i, v[k]);
+  }
+}
+
+// Decompose whole groups of Ops::kLanes of the first `n` matrices and
+// return how many they covered.
+template <typename Ops, typename Arrays>
+inline std::size_t eigenGroups(const Arrays &arrays, std::size_t n,
+                               int sweeps) {
+  std::size_t i = 0;
+  for (; i + Ops::kLanes <= n; i += Ops::kLanes) {
+    eigenAt<Ops>(arrays, i, sweeps);
+  }
+  return i;
+}
+template <typename Ops, typename Arrays>
+inline std::size_t svdGroups(const Arrays &arrays, std::size_t n,
+                             int sweeps) {
+  std::size_t i = 0;
+  for (; i + Ops::kLanes <= n; i += Ops::kLanes) {
+    svdAt<Ops>(arrays, i, sweeps);
+  }
+  return i;
+}
+
+#ifdef CPPCOURSE_X86_KERNELS
+#pragma GCC diagnostic pop
+
+// Four registers of matrices in flight. The AVX2 kernels also serve
+// AVX-512 machines: with AVX-512 enabled GCC fuses multiplies and adds,
+// and the results would no longer match the single-matrix functions.
+template <typename T>
+CPPCOURSE_AVX2_DRIVER std::size_t
+eigenAvx2(const EigenArrays<T> &arrays, std::size_t n, int sweeps) {
+  return eigenGroups<Interleaved<Interleaved<Avx2Ops<T>>>>(arrays, n, sweeps);
+}
+template <typename T>
+CPPCOURSE_AVX2_DRIVER std::size_t svdAvx2(const SvdArrays<T> &arrays,
+                                          std::size_t n, int sweeps) {
+  return svdGroups<Interleaved<Interleaved<Avx2Ops<T>>>>(arrays, n, sweeps);
+}
+
+#endif // CPPCOURSE_X86_KERNELS
+
+bool useAvx2() {
+#ifdef CPPCOURSE_X86_KERNELS
+  return kernels::activeBackend() >= kernels::Backend::kAvx2;
+#else
+  return false;
+#endif
+}
+
+} // namespace
+
+template <typename T>
+SymmetricEigenT<T> symmetricEigen(const Matrix3T<T> &m,
+                                  DecompositionAccuracy accuracy) {
+  SymmetricEigenT<T> output;
+  EigenArrays<T> arrays;
+  for (int k = 0; k < 9; ++k) {
+    arrays.m[k] = &m(k / 3, k % 3);
+    arrays.vectors[k] = &output.vectors[k / 3][k % 3];
+  }
+  for (int k = 0; k < 3; ++k) {
+    arrays.values[k] = &output.values[k];
+  }
+  eigenAt<ScalarOps<T>>(arrays, 0, sweepCount(accuracy));
+  return output;
+}
+
+template <typename T>
+SvdT<T> svd(const Matrix3T<T> &m, DecompositionAccuracy accuracy) {
+  SvdT<T> output;
+  SvdArrays<T> arrays;
+  for (int k = 0; k < 9; ++k) {
+    arrays.m[k] = &m(k / 3, k % 3);
+    arrays.u[k] = &output.u[k / 3][k % 3];
+    arrays.v[k] = &output.v[k / 3][k % 3];
+  }
+  for (int k = 0; k < 3; ++k) {
+    arrays.values[k] = &output.singular_values[k];
+  }
+  svdAt<ScalarOps<T>>(arrays, 0, sweepCount(accuracy));
+  return output;
+}
+
+template <typename T>
+void symmetricEigen(const Matrix3ArrayT<T> &matrices,
+                    PointCloud3T<T> &values, Matrix3ArrayT<T> &vectors,
+                    DecompositionAccuracy accuracy) {
+  const std::size_t n = matrices.size();
+  values.resize(n);
+  vectors.resize(n);
+  EigenArrays<T> arrays;
+  for (int k = 0; k < 9; ++k) {
+    arrays.m[k] = matrices.element(k / 3, k % 3);
+    arrays.vectors[k] = vectors.element(k / 3, k % 3);
+  }
+  arrays.values[0] = values.x();
+  arrays.values[1] = values.y();
+  arrays.values[2] = values.z();
+  const int sweeps = sweepCount(accuracy);
+  std::size_t i = 0;
+#ifdef CPPCOURSE_X86_KERNELS
+  if (useAvx2()) {
+    i = eigenAvx2(arrays, n, sweeps);
+  }
+#endif
+  for (; i < n; ++i) {
+    eigenAt<ScalarOps<T>>(arrays, i, sweeps);
+  }
+}
+
+template <typename T>
+void svd(const Matrix3ArrayT<T> &matrices, Matrix3ArrayT<T> &u,
+         PointCloud3T<T> &singular_values, Matrix3ArrayT<T> &v,
+         DecompositionAccuracy accuracy) {
+  const std::size_t n = matrices.size();
+  u.resize(n);
+  singular_values.resize(n);
+  v.resize(n);
+  SvdArrays<T> arrays;
+  for (int k = 0; k < 9; ++k) {
+    arrays.m[k] = matrices.element(k / 3, k % 3);
+    arrays.u[k] = u.element(k / 3, k % 3);
+    arrays.v[k] = v.element(k / 3, k % 3);
+  }
+  arrays.values[0] = singular_values.x();
+  arrays.values[1] = singular_values.y();
+  arrays.values[2] = singular_values.z();
+  const int sweeps = sweepCount(accuracy);
+  std::size_t i = 0;
+#ifdef CPPCOURSE_X86_KERNELS
+  if (useAvx2()) {
+    i = svdAvx2(arrays, n, sweeps);
+  }
+#endif
+  for (; i < n; ++i) {
+    svdAt<ScalarOps<T>>(arrays, i, sweeps);
+  }
+}
+
+template class Matrix3ArrayT<float>;
+template class Matrix3ArrayT<double>;
+
+#define CPPCOURSE_INSTANTIATE_DECOMPOSITION(T)                                 \
+  template SymmetricEigenT<T> symmetricEigen(const Matrix3T<T> &,              \
+                                             DecompositionAccuracy);           \
+  template SvdT<T> svd(const Matrix3T<T> &, DecompositionAccuracy);            \
+  template void symmetricEigen(const Matrix3ArrayT<T> &, PointCloud3T<T> &,    \
+                               Matrix3ArrayT<T> &, DecompositionAccuracy);     \
+  template void svd(const Matrix3ArrayT<T> &, Matrix3ArrayT<T> &,              \
+                    PointCloud3T<T> &, Matrix3ArrayT<T> &,                     \
+                    DecompositionAccuracy)
+CPPCOURSE_INSTANTIATE_DECOMPOSITION(float);
+CPPCOURSE_INSTANTIATE_DECOMPOSITION(double);
+#undef CPPCOURSE_INSTANTIATE_DECOMPOSITION
+
+} // namespace cppcourse
@@ -0,0 +1,156 @@
+#include "euler.h"
+
+#include <cmath>
+#include <limits>
+
+#include "isometry.h"
+
+namespace cppcourse {
+
+namespace {
+
+// Every convention is a relabeling of XYZ (Tait-Bryan) or XYX (proper
+// Euler): frame axis `axis[p]` plays the role of canonical axis p. An odd
+// relabeling mirrors the frame, which flips the sense of every rotation.
+struct Axes {
+  int axis[3];
+  bool proper;
+  int parity;
+};
+
+// Indexed by EulerConvention.
+const Axes kAxes[] = {
+    {{0, 1, 2}, false, 1}, {{0, 2, 1}, false, -1}, {{1, 0, 2}, false, -1},
+    {{1, 2, 0}, false, 1}, {{2, 0, 1}, false, 1},  {{2, 1, 0}, false, -1},
+    {{0, 1, 2}, true, 1},  {{0, 2, 1}, true, -1},  {{1, 0, 2}, true, -1},
+    {{1, 2, 0}, true, 1},  {{2, 0, 1}, true, 1},   {{2, 1, 0}, true, -1},
+};
+
+inline const Axes &axesOf(EulerConvention convention) {
+  return kAxes[static_cast<int>(convention)];
+}
+
+template <typename T>
+inline Matrix3T<T> buildRotation(const Vector3T<T> &angles,
+                                 const Axes &axes) {
+  const T sign = axes.parity;
+  const T ca = std::cos(angles[0]), sa = sign * std::sin(angles[0]);
+  const T cb = std::cos(angles[1]), sb = sign * std::sin(angles[1]);
+  const T cc = std::cos(angles[2]), sc = sign * std::sin(angles[2]);
+  T c[3][3];
+  if (axes.proper) {
+    // Rx(a) * Ry(b) * Rx(c).
+    c[0][0] = cb;
+    c[0][1] = sb * sc;
+    c[0][2] = sb * cc;
+    c[1][0] = sa * sb;
+    c[1][1] = ca * cc - sa * cb * sc;
+    c[1][2] = -ca * sc - sa * cb * cc;
+    c[2][0] = -ca * sb;
+    c[2][1] = sa * cc + ca * cb * sc;
+    c[2][2] = ca * cb * cc - sa * sc;
+  } else {
+    // Rx(a) * Ry(b) * Rz(c).
+    c[0][0] = cb * cc;
+    c[0][1] = -cb * sc;
+    c[0][2] = sb;
+    c[1][0] = ca * sc + sa * sb * cc;
+    c[1][1] = ca * cc - sa * sb * sc;
+    c[1][2] = -sa * cb;
+    c[2][0] = sa * sc - ca * sb * cc;
+    c[2][1] = sa * cc + ca * sb * sc;
+    c[2][2] = ca * cb;
+  }
+  Matrix3T<T> output;
+  for (int p = 0; p < 3; ++p) {
+    for (int q = 0; q < 3; ++q) {
+      output[axes.axis[p]][axes.axis[q]] = c[p][q];
+    }
+  }
+  return output;
+}
+
+template <typename T>
+inline Vector3T<T> extractAngles(const Matrix3T<T> &rotation,
+                                 const Axes &axes) {
+  // Below this |cos(b)| (Tait-Bryan) or |sin(b)| (proper Euler) the first and
+  // third axes are aligned.
+  const T kLock = 16 * std::numeric_limits<T>::epsilon();
+  const T sign = axes.parity;
+  T c[3][3];
+  for (int p = 0; p < 3; ++p) {
+    for (int q = 0; q < 3; ++q) {
+      c[p][q] = rotation(axes.axis[p], axes.axis[q]);
+    }
+  }
+  T a, b;
+  if (axes.proper) {
+    // Picks the solution whose mirrored second angle lands in [0, pi].
+    const T sin_b = sign * std::hypot(c[0][1], c[0][2]);
+    b = std::atan2(sin_b, c[0][0]);
+    a = std::abs(sin_b) > kLock ? std::atan2(sign * c[1][0], -sign * c[2][0])
+                                : T(0);
+  } else {
+    const T cos_b = std::hypot(c[0][0], c[0][1]);
+    b = std::atan2(c[0][2], cos_b);
+    a = cos_b > kLock ? std::atan2(-c[1][2], c[2][2]) : T(0);
+  }
+  // The third angle comes from Rx(a)^T * R, so it absorbs whatever the first
+  // angle did not at gimbal lock.
+  const T ca = std::cos(a), sa = std::sin(a);
+  const T cos_c = ca * c[1][1] + sa * c[2][1];
+  const T sin_c = axes.proper ? -(ca * c[1][2] + sa * c[2][2])
+                              : ca * c[1][0] + sa * c[2][0];
+  return Vector3T<T>(sign * a, sign * b, sign * std::atan2(sin_c, cos_c));
+}
+
+} // namespace
+
+namespace euler {
+
+template <typename T>
+Matrix3T<T> toRotation(const Vector3T<T> &angles,
+                       EulerConvention convention) {
+  return buildRotation(angles, axesOf(convention));
+}
+
+template <typename T>
+Vector3T<T> fromRotation(const Matrix3T<T> &rotation,
+                         EulerConvention convention) {
+  return extractAngles(rotation, axesOf(convention));
+}
+
+template <typename T>
+void toRotationBatch(const Vector3T<T> *angles, Matrix3T<T> *rotations,
+                     std::size_t count, EulerConvention convention) {
+  const Axes &axes = axesOf(convention);
+  for (std::size_t i = 0; i < count; ++i) {
+    rotations[i] = buildRotation(angles[i], axes);
+  }
+}
+
+template <typename T>
+void fromRotationBatch(const Matrix3T<T> *rotations, Vector3T<T> *angles,
+                       std::size_t count, EulerConvention convention) {
+  const Axes &axes = axesOf(convention);
+  for (std::size_t i = 0; i < count; ++i) {
+    angles[i] = extractAngles(rotations[i], axes);
+  }
+}
+
+} // namespace euler
+
+#define CPPCOURSE_INSTANTIATE_EULER(T)                                         \
+  template Matrix3T<T> euler::toRotation(const Vector3T<T> &,                  \
+                                         EulerConvention);                     \
+  template Vector3T<T> euler::fromRotation(const Matrix3T<T> &,                \
+                                           EulerConvention);                   \
+  template void euler::toRotationBatch(const Vector3T<T> *, Matrix3T<T> *,     \
+                                       std::size_t, EulerConvention);          \
+  template void euler::fromRotationBatch(const Matrix3T<T> *, Vector3T<T> *,   \
+                                         std::size_t, EulerConvention)
+CPPCOURSE_INSTANTIATE_EULER(float);
+CPPCOURSE_INSTANTIATE_EULER(double);
+#undef CPPCOURSE_INSTANTIATE_EULER
+
+} // namespace cppcourse
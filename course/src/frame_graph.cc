@@ -0,0 +1,169 @@
+#include "frame_graph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace cppcourse {
+
+FrameGraph::FrameId FrameGraph::addFrame(const std::string &name) {
+  if (hasFrame(name)) {
+    throw std::invalid_argument("Frame already exists: " + name);
+  }
+  const FrameId id = frames_.size();
+  frames_.push_back(
+      Frame{name, id, 0, {}, Isometry(), Isometry(), id, false});
+  ids_.emplace(name, id);
+  return id;
+}
+
+FrameGraph::FrameId FrameGraph::setTransform(const std::string &parent,
+                                             const std::string &child,
+                                             const Isometry &parent_T_child) {
+  const FrameId parent_id = id(parent);
+  const auto found = ids_.find(child);
+  if (found == ids_.end()) {
+    const FrameId child_id = frames_.size();
+    frames_.push_back(Frame{child, parent_id, frames_[parent_id].depth + 1,
+                            {}, parent_T_child, Isometry(), child_id, false});
+    frames_[parent_id].children.push_back(child_id);
+    ids_.emplace(child, child_id);
+    return child_id;
+  }
+
+  const FrameId child_id = found->second;
+  // Re-parenting below one of its own descendants would close a cycle.
+  for (FrameId ancestor = parent_id;; ancestor = frames_[ancestor].parent) {
+    if (ancestor == child_id) {
+      throw std::invalid_argument("Edge " + parent + " -> " + child +
+                                  " would close a cycle.");
+    }
+    if (frames_[ancestor].parent == ancestor) {
+      break;
+    }
+  }
+  Frame &node = frames_[child_id];
+  if (node.parent != parent_id) {
+    if (node.parent != child_id) {
+      std::vector<FrameId> &siblings = frames_[node.parent].children;
+      siblings.erase(std::find(siblings.begin(), siblings.end(), child_id));
+    }
+    node.parent = parent_id;
+    frames_[parent_id].children.push_back(child_id);
+  }
+  node.parent_T_frame = parent_T_child;
+  invalidate(child_id);
+  return child_id;
+}
+
+void FrameGraph::setTransform(FrameId child, const Isometry &parent_T_child) {
+  frame(child);
+  frames_[child].parent_T_frame = parent_T_child;
+  invalidate(child);
+}
+
+bool FrameGraph::hasFrame(const std::string &name) const {
+  return ids_.find(name) != ids_.end();
+}
+
+FrameGraph::FrameId FrameGraph::id(const std::string &name) const {
+  const auto found = ids_.find(name);
+  if (found == ids_.end()) {
+    throw std::out_of_range("Unknown frame: " + name);
+  }
+  return found->second;
+}
+
+const std::string &FrameGraph::name(FrameId frame_id) const {
+  return frame(frame_id).name;
+}
+
+FrameGraph::FrameId FrameGraph::parent(FrameId frame_id) const {
+  return frame(frame_id).parent;
+}
+
+Isometry FrameGraph::lookup(const std::string &from,
+                            const std::string &to) const {
+  return lookup(id(from), id(to));
+}
+
+Isometry FrameGraph::lookup(FrameId from, FrameId to) const {
+  frame(from);
+  frame(to);
+  if (from == to) {
+    return Isometry();
+  }
+  // Composing through the cached root transforms is the same as composing
+  // through the lowest common ancestor, without walking the tree.
+  const Isometry &root_T_from = rootTransform(from);
+  const Isometry &root_T_to = rootTransform(to);
+  if (frames_[from].root != frames_[to].root) {
+    throw std::invalid_argument("Frames " + frames_[from].name + " and " +
+                                frames_[to].name + " are not connected.");
+  }
+  return root_T_to.inverse() * root_T_from;
+}
+
+void FrameGraph::resolveAll() const {
+  for (FrameId id = 0; id < frames_.size(); ++id) {
+    rootTransform(id);
+  }
+}
+
+FrameGraph::FrameId FrameGraph::commonAncestor(FrameId first,
+                                               FrameId second) const {
+  frame(first);
+  frame(second);
+  while (frames_[first].depth > frames_[second].depth) {
+    first = frames_[first].parent;
+  }
+  while (frames_[second].depth > frames_[first].depth) {
+    second = frames_[second].parent;
+  }
+  while (first != second) {
+    if (frames_[first].parent == first) {
+      throw std::invalid_argument("Frames " + frames_[first].name + " and " +
+                                  frames_[second].name +
+                                  " are not connected.");
+    }
+    first = frames_[first].parent;
+    second = frames_[second].parent;
+  }
+  return first;
+}
+
+const FrameGraph::Frame &FrameGraph::frame(FrameId id) const {
+  if (id >= frames_.size()) {
+    throw std::out_of_range("Unknown frame id: " + std::to_string(id));
+  }
+  return frames_[id];
+}
+
+void FrameGraph::invalidate(FrameId id) {
+  std::vector<FrameId> pending{id};
+  while (!pending.empty()) {
+    const FrameId current = pending.back();
+    pending.pop_back();
+    // Parents are visited before their children.
+    Frame &node = frames_[current];
+    node.cached = false;
+    node.depth = node.parent == current ? 0 : frames_[node.parent].depth + 1;
+    pending.insert(pending.end(), node.children.begin(), node.children.end());
+  }
+}
+
+const Isometry &FrameGraph::rootTransform(FrameId id) const {
+  const Frame &node = frames_[id];
+  if (!node.cached) {
+    if (node.parent == id) {
+      node.root_T_frame = node.parent_T_frame;
+      node.root = id;
+    } else {
+      node.root_T_frame = rootTransform(node.parent) * node.parent_T_frame;
+      node.root = frames_[node.parent].root;
+    }
+    node.cached = true;
+  }
+  return node.root_T_frame;
+}
+
+} // namespace cppcourse
@@ -0,0 +1,335 @@
+#include "kd_tree.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "thread_pool.h"
+
+namespace cppcourse {
+
+namespace {
+
+// Nodes at least this large build their two subtrees as separate tasks.
+const std::size_t kParallelBuildCutoff{1 << 15};
+// Queries per parallelFor() chunk, and fewer queries than this run on the
+// calling thread alone.
+const std::size_t kQueryChunk{1024};
+const std::size_t kQuerySerialCutoff{4 * kQueryChunk};
+
+// The k closest entries so far, sorted by distance, in the caller's buffer.
+template <typename T> class NearestVisitor {
+public:
+  NearestVisitor(std::size_t k, NeighborT<T> *neighbors)
+      : k_(k), neighbors_(neighbors) {}
+
+  std::size_t count() const { return count_; }
+  T bound() const { return bound_; }
+  // Insertion sort; once the buffer is full the farthest entry drops out.
+  void add(std::size_t index, T squared_distance) {
+    std::size_t slot = count_ < k_ ? count_++ : k_ - 1;
+    for (; slot > 0 && neighbors_[slot - 1].squared_distance > squared_distance;
+         --slot) {
+      neighbors_[slot] = neighbors_[slot - 1];
+    }
+    neighbors_[slot] = NeighborT<T>{index, squared_distance};
+    if (count_ == k_) {
+      bound_ = neighbors_[k_ - 1].squared_distance;
+    }
+  }
+
+private:
+  std::size_t k_;
+  NeighborT<T> *neighbors_;
+  std::size_t count_{};
+  T bound_{std::numeric_limits<T>::infinity()};
+};
+
+template <typename T> class RadiusVisitor {
+public:
+  RadiusVisitor(T radius, std::vector<NeighborT<T>> &neighbors)
+      : bound_(radius * radius), neighbors_(neighbors) {}
+
+  T bound() const { return bound_; }
+  void add(std::size_t index, T squared_distance) {
+    neighbors_.push_back(NeighborT<T>{index, squared_distance});
+  }
+
+private:
+  T bound_;
+  std::vector<NeighborT<T>> &neighbors_;
+};
+
+template <typename T> void checkRadius(T radius) {
+  if (!(radius >= 0)) {
+    throw std::invalid_argument("Search radius must be non-negative.");
+  }
+}
+
+} // namespace
+
+template <typename T> KdTreeT<T>::KdTreeT(const PointView3T<T> &points) {
+  build(points, nullptr);
+}
+
+template <typename T>
+KdTreeT<T>::KdTreeT(const std::vector<Vector3T<T>> &points) {
+  if (points.empty()) {
+    return;
+  }
+  const std::size_t stride = sizeof(Vector3T<T>);
+  build(PointView3T<T>{StridedSpan<T>(&points[0][0], points.size(), stride),
+                       StridedSpan<T>(&points[0][1], points.size(), stride),
+                       StridedSpan<T>(&points[0][2], points.size(), stride)},
+        nullptr);
+}
+
+template <typename T>
+KdTreeT<T>::KdTreeT(const PointView3T<T> &points, ThreadPool &pool) {
+  build(points, pool.threads() > 1 ? &pool : nullptr);
+}
+
+template <typename T>
+void KdTreeT<T>::build(const PointView3T<T> &points, ThreadPool *pool) {
+  if (points.size() > kIndexMask + std::size_t(1)) {
+    throw std::invalid_argument("Too many points for a KD-tree.");
+  }
+  entries_.resize(points.size());
+  if (points.empty()) {
+    return;
+  }
+  Vector3T<T> low = points[0], high = points[0];
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    Entry &entry = entries_[i];
+    entry.point[0] = points.x[i];
+    entry.point[1] = points.y[i];
+    entry.point[2] = points.z[i];
+    entry.key = static_cast<std::uint32_t>(i);
+    for (int d = 0; d < 3; ++d) {
+      low[d] = std::min(low[d], entry.point[d]);
+      high[d] = std::max(high[d], entry.point[d]);
+    }
+  }
+  buildNode(0, entries_.size(), low, high, pool);
+}
+
+template <typename T>
+void KdTreeT<T>::buildNode(std::size_t begin, std::size_t end,
+                           Vector3T<T> low, Vector3T<T> high,
+                           ThreadPool *pool) {
+  if (end - begin <= kLeafSize) {
+    return;
+  }
+  int dim = 0;
+  for (int d = 1; d < 3; ++d) {
+    if (high[d] - low[d] > high[dim] - low[dim]) {
+      dim = d;
+    }
+  }
+  const std::size_t mid = begin + (end - begin) / 2;
+  std::nth_element(entries_.begin() + begin, entries_.begin() + mid,
+                   entries_.begin() + end,
+                   [dim](const Entry &a, const Entry &b) {
+                     return a.point[dim] < b.point[dim];
+                   });
+  entries_[mid].key |= std::uint32_t(dim) << kIndexBits;
+  const T split = entries_[mid].point[dim];
+  Vector3T<T> left_high = high, right_low = low;
+  left_high[dim] = split;
+  right_low[dim] = split;
+  if (pool && end - begin >= kParallelBuildCutoff) {
+    pool->parallelFor(2, 1, [&](std::size_t child, std::size_t) {
+      if (child == 0) {
+        buildNode(begin, mid, low, left_high, pool);
+      } else {
+        buildNode(mid + 1, end, right_low, high, pool);
+      }
+    });
+    return;
+  }
+  buildNode(begin, mid, low, left_high, nullptr);
+  buildNode(mid + 1, end, right_low, high, nullptr);
+}
+
+template <typename T>
+template <typename Visitor>
+void KdTreeT<T>::search(std::size_t begin, std::size_t end, const T *query,
+                        T *offset, T box_distance, Visitor &visitor) const {
+  if (end - begin <= kLeafSize) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const Entry &entry = entries_[i];
+      const T dx = entry.point[0] - query[0];
+      const T dy = entry.point[1] - query[1];
+      const T dz = entry.point[2] - query[2];
+      const T squared_distance = dx * dx + dy * dy + dz * dz;
+      if (squared_distance <= visitor.bound()) {
+        visitor.add(entry.key & kIndexMask, squared_distance);
+      }
+    }
+    return;
+  }
+  const std::size_t mid = begin + (end - begin) / 2;
+  const Entry &split = entries_[mid];
+  const int dim = split.key >> kIndexBits;
+  const T diff = query[dim] - split.point[dim];
+  // The near child first: it tightens the bound before the split point
+  // and the far child are considered. The far box only moves away along
+  // `dim`.
+  const bool left_first = diff < 0;
+  if (left_first) {
+    search(begin, mid, query, offset, box_distance, visitor);
+  } else {
+    search(mid + 1, end, query, offset, box_distance, visitor);
+  }
+  const T previous = offset[dim];
+  const T far_distance = box_distance - previous * previous + diff * diff;
+  if (far_distance <= visitor.bound()) {
+    const T dx = split.point[0] - query[0];
+    const T dy = split.point[1] - query[1];
+    const T dz = split.point[2] - query[2];
+    const T squared_distance = dx * dx + dy * dy + dz * dz;
+    if (squared_distance <= visitor.bound()) {
+      visitor.add(split.key & kIndexMask, squared_distance);
+    }
+    offset[dim] = diff;
+    if (left_first) {
+      search(mid + 1, end, query, offset, far_distance, visitor);
+    } else {
+      search(begin, mid, query, offset, far_distance, visitor);
+    }
+    offset[dim] = previous;
+  }
+}
+
+template <typename T>
+NeighborT<T> KdTreeT<T>::nearest(const Vector3T<T> &query) const {
+  if (empty()) {
+    throw std::out_of_range("Nearest neighbor in an empty KD-tree.");
+  }
+  NeighborT<T> neighbor;
+  nearest(query, 1, &neighbor);
+  return neighbor;
+}
+
+template <typename T>
+std::size_t KdTreeT<T>::nearest(const Vector3T<T> &query, std::size_t k,
+                                NeighborT<T> *neighbors) const {
+  k = std::min(k, size());
+  if (k == 0) {
+    return 0;
+  }
+  NearestVisitor<T> visitor(k, neighbors);
+  const T point[3] = {query[0], query[1], query[2]};
+  T offset[3] = {0, 0, 0};
+  search(0, size(), point, offset, T(0), visitor);
+  return visitor.count();
+}
+
+template <typename T>
+void KdTreeT<T>::radiusSearch(const Vector3T<T> &query, T radius,
+                              std::vector<NeighborT<T>> &neighbors) const {
+  checkRadius(radius);
+  neighbors.clear();
+  if (empty()) {
+    return;
+  }
+  RadiusVisitor<T> visitor(radius, neighbors);
+  const T point[3] = {query[0], query[1], query[2]};
+  T offset[3] = {0, 0, 0};
+  search(0, size(), point, offset, T(0), visitor);
+}
+
+template <typename T>
+void KdTreeT<T>::nearest(const PointView3T<T> &queries, std::size_t k,
+                         std::vector<NeighborT<T>> &neighbors) const {
+  k = std::min(k, size());
+  neighbors.resize(queries.size() * k);
+  for (std::size_t i = 0; k > 0 && i < queries.size(); ++i) {
+    nearest(queries[i], k, &neighbors[i * k]);
+  }
+}
+
+template <typename T>
+void KdTreeT<T>::nearest(const PointView3T<T> &queries, std::size_t k,
+                         std::vector<NeighborT<T>> &neighbors,
+                         ThreadPool &pool) const {
+  k = std::min(k, size());
+  if (queries.size() < kQuerySerialCutoff || pool.threads() == 1 || k == 0) {
+    nearest(queries, k, neighbors);
+    return;
+  }
+  neighbors.resize(queries.size() * k);
+  NeighborT<T> *output = neighbors.data();
+  pool.parallelFor(queries.size(), kQueryChunk,
+                   [&](std::size_t begin, std::size_t end) {
+                     for (std::size_t i = begin; i < end; ++i) {
+                       nearest(queries[i], k, output + i * k);
+                     }
+                   });
+}
+
+template <typename T>
+void KdTreeT<T>::radiusRange(const PointView3T<T> &queries, std::size_t begin,
+                             std::size_t end, T radius, std::size_t *counts,
+                             std::vector<NeighborT<T>> &neighbors) const {
+  RadiusVisitor<T> visitor(radius, neighbors);
+  for (std::size_t i = begin; i < end; ++i) {
+    const std::size_t before = neighbors.size();
+    if (!empty()) {
+      const T point[3] = {queries.x[i], queries.y[i], queries.z[i]};
+      T offset[3] = {0, 0, 0};
+      search(0, size(), point, offset, T(0), visitor);
+    }
+    counts[i - begin] = neighbors.size() - before;
+  }
+}
+
+template <typename T>
+void KdTreeT<T>::radiusSearch(const PointView3T<T> &queries, T radius,
+                              std::vector<std::size_t> &offsets,
+                              std::vector<NeighborT<T>> &neighbors) const {
+  checkRadius(radius);
+  offsets.resize(queries.size() + 1);
+  offsets[0] = 0;
+  neighbors.clear();
+  radiusRange(queries, 0, queries.size(), radius, &offsets[1], neighbors);
+  for (std::size_t i = 1; i < offsets.size(); ++i) {
+    offsets[i] += offsets[i - 1];
+  }
+}
+
+template <typename T>
+void KdTreeT<T>::radiusSearch(const PointView3T<T> &queries, T radius,
+                              std::vector<std::size_t> &offsets,
+                              std::vector<NeighborT<T>> &neighbors,
+                              ThreadPool &pool) const {
+  if (queries.size() < kQuerySerialCutoff || pool.threads() == 1) {
+    radiusSearch(queries, radius, offsets, neighbors);
+    return;
+  }
+  checkRadius(radius);
+  offsets.resize(queries.size() + 1);
+  offsets[0] = 0;
+  // Each chunk collects its own neighbors; they are joined in query order.
+  std::vector<std::vector<NeighborT<T>>> chunks(
+      (queries.size() + kQueryChunk - 1) / kQueryChunk);
+  pool.parallelFor(queries.size(), kQueryChunk,
+                   [&](std::size_t begin, std::size_t end) {
+                     radiusRange(queries, begin, end, radius,
+                                 &offsets[begin + 1],
+                                 chunks[begin / kQueryChunk]);
+                   });
+  for (std::size_t i = 1; i < offsets.size(); ++i) {
+    offsets[i] += offsets[i - 1];
+  }
+  neighbors.clear();
+  neighbors.reserve(offsets.back());
+  for (const std::vector<NeighborT<T>> &chunk : chunks) {
+    neighbors.insert(neighbors.end(), chunk.begin(), chunk.end());
+  }
+}
+
+template class KdTreeT<float>;
+template class KdTreeT<double>;
+
+} // namespace cppcourse
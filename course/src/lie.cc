@@ -0,0 +1,214 @@
+#include "lie.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cppcourse {
+
+namespace {
+
+// Below this squared angle the coefficients switch to their Taylor series,
+// truncated after the theta^8 term; the remainder is under 1e-16 there.
+template <typename T> constexpr T taylorThreshold() { return T(1e-2); }
+
+// Coefficients of the Rodrigues-like series in theta = |phi|.
+template <typename T> struct Coefficients {
+  T a; // sin(t) / t
+  T b; // (1 - cos(t)) / t^2
+  T c; // (t - sin(t)) / t^3
+  T d; // (1 - a / (2 b)) / t^2, for the inverse Jacobians
+};
+
+// Both branches are evaluated and selected without jumps, so batch loops
+// stay straight-line code.
+template <typename T> inline Coefficients<T> coefficients(const T &theta2) {
+  const bool small = theta2 < taylorThreshold<T>();
+  const T safe2 = small ? T(1) : theta2;
+  const T theta = std::sqrt(safe2);
+  const T sin_theta = std::sin(theta);
+  const T sin_half = std::sin(theta / 2);
+  // 1 - cos(t) as 2 sin^2(t / 2) avoids the cancellation near zero.
+  const T closed_a = sin_theta / theta;
+  const T closed_b = 2 * sin_half * sin_half / safe2;
+  const T closed_c = (theta - sin_theta) / (safe2 * theta);
+  const T closed_d = (1 - closed_a / (2 * closed_b)) / safe2;
+
+  const T t2 = theta2, t4 = t2 * t2, t6 = t4 * t2, t8 = t4 * t4;
+  Coefficients<T> out;
+  out.a = small ? 1 - t2 / 6 + t4 / 120 - t6 / 5040 + t8 / 362880 : closed_a;
+  out.b = small ? T(0.5) - t2 / 24 + t4 / 720 - t6 / 40320 + t8 / 3628800
+                : closed_b;
+  out.c = small ? T(1) / 6 - t2 / 120 + t4 / 5040 - t6 / 362880 +
+                      t8 / 39916800
+                : closed_c;
+  out.d = small ? T(1) / 12 + t2 / 720 + t4 / 30240 + t6 / 1209600 +
+                      t8 / 47900160
+                : closed_d;
+  return out;
+}
+
+template <typename T> inline T squaredNorm(const Vector3T<T> &v) {
+  return v.dot(v);
+}
+
+template <typename T>
+inline IsometryT<T> expTwist(const TwistT<T> &twist) {
+  const Coefficients<T> k = coefficients(squaredNorm(twist.phi));
+  const Matrix3T<T> left_jacobian = detail::rodrigues(twist.phi, k.b, k.c);
+  return IsometryT<T>(left_jacobian.product(twist.rho),
+                      detail::rodrigues(twist.phi, k.a, k.b));
+}
+
+template <typename T> inline TwistT<T> logPose(const IsometryT<T> &pose) {
+  const Vector3T<T> phi = so3::log(pose.rotation());
+  const Coefficients<T> k = coefficients(squaredNorm(phi));
+  return TwistT<T>(
+      detail::rodrigues(phi, T(-0.5), k.d).product(pose.translation()), phi);
+}
+
+} // namespace
+
+namespace so3 {
+
+template <typename T> Matrix3T<T> exp(const Vector3T<T> &phi) {
+  const Coefficients<T> k = coefficients(squaredNorm(phi));
+  return detail::rodrigues(phi, k.a, k.b);
+}
+
+template <typename T> Vector3T<T> log(const Matrix3T<T> &rotation) {
+  // vee(R) = sin(t) * axis and trace(R) = 1 + 2 cos(t).
+  const Vector3T<T> sin_axis = vee(rotation);
+  const T sin_theta = sin_axis.norm();
+  const T cos_theta =
+      std::max(T(-1), std::min(T(1), (rotation(0, 0) + rotation(1, 1) +
+                                      rotation(2, 2) - 1) /
+                                         2));
+  const T theta = std::atan2(sin_theta, cos_theta);
+  if (cos_theta > T(-0.99)) {
+    return sin_axis * (T(1) / coefficients(theta * theta).a);
+  }
+  // Close to pi sin(t) vanishes and the axis is recovered from the symmetric
+  // part, (R + R^T) / 2 - cos(t) I = (1 - cos(t)) axis axis^T.
+  int i = 0;
+  for (int j = 1; j < 3; ++j) {
+    if (rotation(j, j) > rotation(i, i)) {
+      i = j;
+    }
+  }
+  const T one_minus_cos = 1 - cos_theta;
+  const T axis_i = std::sqrt(
+      std::max(T(0), (rotation(i, i) - cos_theta) / one_minus_cos));
+  Vector3T<T> axis;
+  for (int j = 0; j < 3; ++j) {
+    axis[j] = j == i ? axis_i
+                     : (rotation(i, j) + rotation(j, i)) /
+                           (2 * one_minus_cos * axis_i);
+  }
+  if (axis.dot(sin_axis) < 0) {
+    axis = -axis;
+  }
+  return axis * theta;
+}
+
+template <typename T> Matrix3T<T> leftJacobian(const Vector3T<T> &phi) {
+  const Coefficients<T> k = coefficients(squaredNorm(phi));
+  return detail::rodrigues(phi, k.b, k.c);
+}
+
+template <typename T> Matrix3T<T> rightJacobian(const Vector3T<T> &phi) {
+  const Coefficients<T> k = coefficients(squaredNorm(phi));
+  return detail::rodrigues(phi, -k.b, k.c);
+}
+
+template <typename T> Matrix3T<T> leftJacobianInverse(const Vector3T<T> &phi) {
+  const Coefficients<T> k = coefficients(squaredNorm(phi));
+  return detail::rodrigues(phi, T(-0.5), k.d);
+}
+
+template <typename T>
+Matrix3T<T> rightJacobianInverse(const Vector3T<T> &phi) {
+  const Coefficients<T> k = coefficients(squaredNorm(phi));
+  return detail::rodrigues(phi, T(0.5), k.d);
+}
+
+template <typename T>
+void expBatch(const Vector3T<T> *phi, Matrix3T<T> *rotations,
+              std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const Coefficients<T> k = coefficients(squaredNorm(phi[i]));
+    rotations[i] = detail::rodrigues(phi[i], k.a, k.b);
+  }
+}
+
+} // namespace so3
+
+namespace se3 {
+
+template <typename T> IsometryT<T> exp(const TwistT<T> &twist) {
+  return expTwist(twist);
+}
+
+template <typename T> TwistT<T> log(const IsometryT<T> &pose) {
+  return logPose(pose);
+}
+
+template <typename T> Matrix6T<T> adjoint(const IsometryT<T> &pose) {
+  Matrix6T<T> output;
+  output.top_left = pose.rotation();
+  output.top_right = so3::hat(pose.translation()).product(pose.rotation());
+  output.bottom_left = Matrix3T<T>::kZero;
+  output.bottom_right = pose.rotation();
+  return output;
+}
+
+template <typename T>
+IsometryT<T> boxplus(const IsometryT<T> &pose, const TwistT<T> &delta) {
+  return pose * expTwist(delta);
+}
+
+template <typename T>
+TwistT<T> boxminus(const IsometryT<T> &other, const IsometryT<T> &pose) {
+  return logPose(pose.inverse() * other);
+}
+
+template <typename T>
+void expBatch(const TwistT<T> *twists, IsometryT<T> *poses,
+              std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    poses[i] = expTwist(twists[i]);
+  }
+}
+
+template <typename T>
+void logBatch(const IsometryT<T> *poses, TwistT<T> *twists,
+              std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    twists[i] = logPose(poses[i]);
+  }
+}
+
+} // namespace se3
+
+#define CPPCOURSE_INSTANTIATE_LIE(T)                                           \
+  template Matrix3T<T> so3::exp(const Vector3T<T> &);                          \
+  template Vector3T<T> so3::log(const Matrix3T<T> &);                          \
+  template Matrix3T<T> so3::leftJacobian(const Vector3T<T> &);                 \
+  template Matrix3T<T> so3::rightJacobian(const Vector3T<T> &);                \
+  template Matrix3T<T> so3::leftJacobianInverse(const Vector3T<T> &);          \
+  template Matrix3T<T> so3::rightJacobianInverse(const Vector3T<T> &);         \
+  template void so3::expBatch(const Vector3T<T> *, Matrix3T<T> *,              \
+                              std::size_t);                                    \
+  template IsometryT<T> se3::exp(const TwistT<T> &);                           \
+  template TwistT<T> se3::log(const IsometryT<T> &);                           \
+  template Matrix6T<T> se3::adjoint(const IsometryT<T> &);                     \
+  template IsometryT<T> se3::boxplus(const IsometryT<T> &, const TwistT<T> &); \
+  template TwistT<T> se3::boxminus(const IsometryT<T> &,                       \
+                                   const IsometryT<T> &);                      \
+  template void se3::expBatch(const TwistT<T> *, IsometryT<T> *,               \
+                              std::size_t);                                    \
+  template void se3::logBatch(const IsometryT<T> *, TwistT<T> *, std::size_t)
+CPPCOURSE_INSTANTIATE_LIE(float);
+CPPCOURSE_INSTANTIATE_LIE(double);
+#undef CPPCOURSE_INSTANTIATE_LIE
+
+} // namespace cppcourse
@@ -0,0 +1,77 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace cppcourse {
+
+namespace {
+
+std::runtime_error systemError(const std::string &what,
+                               const std::string &path) {
+  return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+MappedFile::MappedFile(const std::string &path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw systemError("Cannot open", path);
+  }
+  struct stat status;
+  if (::fstat(fd, &status) != 0) {
+    const std::runtime_error error = systemError("Cannot stat", path);
+    ::close(fd);
+    throw error;
+  }
+  size_ = static_cast<std::size_t>(status.st_size);
+  if (size_ == 0) {
+    // mmap() rejects empty mappings.
+    ::close(fd);
+    return;
+  }
+  void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (mapping == MAP_FAILED) {
+    const std::runtime_error error = systemError("Cannot map", path);
+    ::close(fd);
+    throw error;
+  }
+  // The mapping keeps its own reference to the file.
+  ::close(fd);
+  data_ = static_cast<const unsigned char *>(mapping);
+}
+
+MappedFile::MappedFile(MappedFile &&other)
+    : data_(other.data_), size_(other.size_) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) {
+  if (this != &other) {
+    unmap();
+    data_ = other.data_;
+    size_ = other.size_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+void MappedFile::unmap() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<unsigned char *>(data_), size_);
+    data_ = nullptr;
+  }
+}
+
+} // namespace cppcourse
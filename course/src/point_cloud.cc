@@ -0,0 +1,63 @@
+#include "point_cloud.h"
+
+namespace cppcourse {
+
+template <typename T>
+PointCloud3T<T>::PointCloud3T(const std::vector<Vector3T<T>> &points)
+    : PointCloud3T(points.size()) {
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    set(i, points[i]);
+  }
+}
+
+template <typename T> void PointCloud3T<T>::resize(std::size_t size) {
+  x_.resize(size);
+  y_.resize(size);
+  z_.resize(size);
+}
+
+template <typename T> void PointCloud3T<T>::reserve(std::size_t capacity) {
+  x_.reserve(capacity);
+  y_.reserve(capacity);
+  z_.reserve(capacity);
+}
+
+template <typename T> void PointCloud3T<T>::clear() {
+  x_.clear();
+  y_.clear();
+  z_.clear();
+}
+
+template <typename T>
+void PointCloud3T<T>::push_back(const Vector3T<T> &point) {
+  x_.push_back(point.x());
+  y_.push_back(point.y());
+  z_.push_back(point.z());
+}
+
+template <typename T>
+void PointCloud3T<T>::set(std::size_t index, const Vector3T<T> &point) {
+  x_[index] = point.x();
+  y_[index] = point.y();
+  z_[index] = point.z();
+}
+
+template <typename T>
+std::vector<Vector3T<T>> PointCloud3T<T>::toVector() const {
+  std::vector<Vector3T<T>> output;
+  output.reserve(size());
+  for (std::size_t i = 0; i < size(); ++i) {
+    output.push_back((*this)[i]);
+  }
+  return output;
+}
+
+void transform(const Isometry &pose, const PointCloud3f &in,
+               PointCloud3f &out) {
+  pose.cast<float>().transform(in, out);
+}
+
+template class PointCloud3T<float>;
+template class PointCloud3T<double>;
+
+} // namespace cppcourse
@@ -0,0 +1,366 @@
+#include "point_file.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+namespace cppcourse {
+
+namespace {
+
+// Points interleaved per write() call to the output stream.
+const std::size_t kWriteChunk{4096};
+// Width reserved in writer headers for the point count.
+const int kCountWidth{20};
+
+bool isLittleEndianHost() {
+  const std::uint32_t probe{1};
+  unsigned char first;
+  std::memcpy(&first, &probe, 1);
+  return first == 1;
+}
+
+// The header, up to and including the line that starts with `last_key`.
+// Returns false if there is no such line.
+bool headerUntil(const MappedFile &file, const std::string &last_key,
+                 std::string *header) {
+  const char *begin = reinterpret_cast<const char *>(file.data());
+  const char *end = begin + file.size();
+  for (const char *line = begin; line < end;) {
+    const char *newline = std::find(line, end, '\n');
+    if (newline == end) {
+      return false;
+    }
+    if (std::string(line, newline).compare(0, last_key.size(), last_key) ==
+        0) {
+      header->assign(begin, newline + 1);
+      return true;
+    }
+    line = newline + 1;
+  }
+  return false;
+}
+
+// PLY property type name to PCD type letter and size; false if unknown.
+bool plyType(const std::string &name, char *type, std::size_t *size) {
+  struct Entry {
+    const char *name;
+    char type;
+    std::size_t size;
+  };
+  static const Entry kTypes[] = {
+      {"char", 'I', 1},   {"int8", 'I', 1},    {"uchar", 'U', 1},
+      {"uint8", 'U', 1},  {"short", 'I', 2},   {"int16", 'I', 2},
+      {"ushort", 'U', 2}, {"uint16", 'U', 2},  {"int", 'I', 4},
+      {"int32", 'I', 4},  {"uint", 'U', 4},    {"uint32", 'U', 4},
+      {"float", 'F', 4},  {"float32", 'F', 4}, {"double", 'F', 8},
+      {"float64", 'F', 8}};
+  for (const Entry &entry : kTypes) {
+    if (name == entry.name) {
+      *type = entry.type;
+      *size = entry.size;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::invalid_argument badFile(const std::string &path,
+                              const std::string &problem) {
+  return std::invalid_argument(path + ": " + problem + ".");
+}
+
+} // namespace
+
+MappedPointFile::MappedPointFile(const std::string &path) : file_(path) {
+  if (!isLittleEndianHost()) {
+    throw std::runtime_error("Point files map only on little-endian hosts.");
+  }
+  const char *text = reinterpret_cast<const char *>(file_.data());
+  if (file_.size() >= 4 && std::memcmp(text, "ply", 3) == 0 &&
+      (text[3] == '\n' || text[3] == '\r')) {
+    format_ = PointFileFormat::kPly;
+    parsePly(path);
+  } else {
+    format_ = PointFileFormat::kPcd;
+    parsePcd(path);
+  }
+
+  const PointField *x = nullptr;
+  for (const PointField &f : fields_) {
+    if (f.name == "x") {
+      x = &f;
+    }
+  }
+  if (x == nullptr || x->type != 'F' || (x->size != 4 && x->size != 8)) {
+    throw badFile(path, "no float or double x field");
+  }
+  scalar_size_ = x->size;
+  for (const char *name : {"y", "z"}) {
+    const auto f = std::find_if(
+        fields_.begin(), fields_.end(),
+        [&](const PointField &field) { return field.name == name; });
+    if (f == fields_.end() || f->type != 'F' || f->size != scalar_size_) {
+      throw badFile(path, std::string("no ") + name + " field like x");
+    }
+  }
+  if (data_offset_ > file_.size() ||
+      (stride_ != 0 && count_ > (file_.size() - data_offset_) / stride_)) {
+    throw badFile(path, "truncated point data");
+  }
+}
+
+const PointField &MappedPointFile::field(const std::string &name) const {
+  for (const PointField &f : fields_) {
+    if (f.name == name) {
+      return f;
+    }
+  }
+  throw std::out_of_range("No point field " + name + ".");
+}
+
+const PointField &MappedPointFile::checkedField(const std::string &name,
+                                                char type,
+                                                std::size_t size) const {
+  const PointField &f = field(name);
+  if (f.type != type || f.size != size) {
+    throw std::invalid_argument("Point field " + name +
+                                " holds another type.");
+  }
+  return f;
+}
+
+void MappedPointFile::parsePly(const std::string &path) {
+  std::string header;
+  if (!headerUntil(file_, "end_header", &header)) {
+    throw badFile(path, "PLY header without end_header");
+  }
+  std::istringstream lines(header);
+  std::string line;
+  bool format_seen = false;
+  bool in_vertex = false;
+  bool vertex_seen = false;
+  // Bytes taken by the elements before the vertex element.
+  std::size_t skipped = 0;
+  std::size_t element_count = 0;
+  std::size_t element_size = 0;
+  bool element_has_list = false;
+  while (std::getline(lines, line)) {
+    std::istringstream words(line);
+    std::string keyword;
+    words >> keyword;
+    if (keyword == "format") {
+      std::string encoding;
+      words >> encoding;
+      if (encoding != "binary_little_endian") {
+        throw badFile(path, "PLY encoding " + encoding + " is not supported, "
+                            "only binary_little_endian");
+      }
+      format_seen = true;
+    } else if (keyword == "element") {
+      if (vertex_seen) {
+        break;
+      }
+      if (element_has_list) {
+        throw badFile(path, "PLY list element before the vertices");
+      }
+      skipped += element_count * element_size;
+      std::string name;
+      words >> name >> element_count;
+      element_size = 0;
+      in_vertex = name == "vertex";
+      if (in_vertex) {
+        vertex_seen = true;
+        count_ = element_count;
+      }
+    } else if (keyword == "property") {
+      std::string type_name;
+      words >> type_name;
+      if (type_name == "list") {
+        if (in_vertex) {
+          throw badFile(path, "PLY vertex with a list property");
+        }
+        element_has_list = true;
+        continue;
+      }
+      PointField f{};
+      if (!plyType(type_name, &f.type, &f.size)) {
+        throw badFile(path, "unknown PLY type " + type_name);
+      }
+      words >> f.name;
+      f.offset = element_size;
+      f.count = 1;
+      element_size += f.size;
+      if (in_vertex) {
+        fields_.push_back(f);
+        stride_ = element_size;
+      }
+    }
+  }
+  if (!format_seen || !vertex_seen) {
+    throw badFile(path, "PLY header without format or vertex element");
+  }
+  data_offset_ = header.size() + skipped;
+}
+
+void MappedPointFile::parsePcd(const std::string &path) {
+  std::string header;
+  if (!headerUntil(file_, "DATA", &header)) {
+    throw badFile(path, "not a PLY or PCD file");
+  }
+  std::istringstream lines(header);
+  std::string line;
+  std::vector<std::string> names;
+  std::vector<std::size_t> sizes, counts;
+  std::vector<char> types;
+  std::size_t width = 0, height = 1, points = 0;
+  bool points_seen = false;
+  while (std::getline(lines, line)) {
+    std::istringstream words(line);
+    std::string keyword;
+    words >> keyword;
+    if (keyword.empty() || keyword[0] == '#') {
+      continue;
+    }
+    if (keyword == "FIELDS") {
+      for (std::string name; words >> name;) {
+        names.push_back(name);
+      }
+    } else if (keyword == "SIZE") {
+      for (std::size_t size; words >> size;) {
+        sizes.push_back(size);
+      }
+    } else if (keyword == "TYPE") {
+      for (char type; words >> type;) {
+        types.push_back(type);
+      }
+    } else if (keyword == "COUNT") {
+      for (std::size_t count; words >> count;) {
+        counts.push_back(count);
+      }
+    } else if (keyword == "WIDTH") {
+      words >> width;
+    } else if (keyword == "HEIGHT") {
+      words >> height;
+    } else if (keyword == "POINTS") {
+      words >> points;
+      points_seen = true;
+    } else if (keyword == "DATA") {
+      std::string encoding;
+      words >> encoding;
+      if (encoding != "binary") {
+        throw badFile(path, "PCD DATA " + encoding + " is not supported, "
+                            "only binary");
+      }
+    }
+  }
+  if (counts.empty()) {
+    counts.assign(names.size(), 1);
+  }
+  if (names.empty() || sizes.size() != names.size() ||
+      types.size() != names.size() || counts.size() != names.size()) {
+    throw badFile(path, "PCD FIELDS, SIZE, TYPE and COUNT do not match");
+  }
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    fields_.push_back(PointField{names[i], stride_, sizes[i], types[i],
+                                 counts[i]});
+    stride_ += sizes[i] * counts[i];
+  }
+  count_ = points_seen ? points : width * height;
+  data_offset_ = header.size();
+}
+
+template <typename T>
+PointFileWriter<T>::PointFileWriter(const std::string &path,
+                                    PointFileFormat format)
+    : out_(path, std::ios::binary | std::ios::trunc) {
+  if (!out_) {
+    throw std::runtime_error("Cannot create " + path);
+  }
+  const char *type = sizeof(T) == 4 ? "float" : "double";
+  const std::string blank(kCountWidth, ' ');
+  if (format == PointFileFormat::kPly) {
+    out_ << "ply\nformat binary_little_endian 1.0\nelement vertex ";
+    count_positions_.push_back(out_.tellp());
+    out_ << blank << "\nproperty " << type << " x\nproperty " << type
+         << " y\nproperty " << type << " z\nend_header\n";
+  } else {
+    out_ << "# .PCD v0.7 - Point Cloud Data file format\nVERSION 0.7\n"
+         << "FIELDS x y z\nSIZE " << sizeof(T) << ' ' << sizeof(T) << ' '
+         << sizeof(T) << "\nTYPE F F F\nCOUNT 1 1 1\nWIDTH ";
+    count_positions_.push_back(out_.tellp());
+    out_ << blank << "\nHEIGHT 1\nVIEWPOINT 0 0 0 1 0 0 0\nPOINTS ";
+    count_positions_.push_back(out_.tellp());
+    out_ << blank << "\nDATA binary\n";
+  }
+  buffer_.reserve(3 * kWriteChunk);
+}
+
+template <typename T> PointFileWriter<T>::~PointFileWriter() {
+  if (out_.is_open()) {
+    try {
+      close();
+    } catch (const std::exception &) {
+    }
+  }
+}
+
+template <typename T>
+void PointFileWriter<T>::write(const Vector3T<T> *points, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    buffer_.push_back(points[i].x());
+    buffer_.push_back(points[i].y());
+    buffer_.push_back(points[i].z());
+    if (buffer_.size() == buffer_.capacity()) {
+      flush();
+    }
+  }
+  count_ += count;
+}
+
+template <typename T>
+void PointFileWriter<T>::write(const PointView3T<T> &points) {
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    buffer_.push_back(points.x[i]);
+    buffer_.push_back(points.y[i]);
+    buffer_.push_back(points.z[i]);
+    if (buffer_.size() == buffer_.capacity()) {
+      flush();
+    }
+  }
+  count_ += points.size();
+}
+
+template <typename T> void PointFileWriter<T>::close() {
+  if (!out_.is_open()) {
+    return;
+  }
+  flush();
+  const std::string count = std::to_string(count_);
+  for (const std::streampos position : count_positions_) {
+    out_.seekp(position);
+    out_.write(count.data(), count.size());
+  }
+  out_.close();
+  if (!out_) {
+    throw std::runtime_error("Failed to write point file.");
+  }
+}
+
+template <typename T> void PointFileWriter<T>::flush() {
+  if (!isLittleEndianHost()) {
+    for (T &value : buffer_) {
+      unsigned char *bytes = reinterpret_cast<unsigned char *>(&value);
+      std::reverse(bytes, bytes + sizeof(T));
+    }
+  }
+  out_.write(reinterpret_cast<const char *>(buffer_.data()),
+             buffer_.size() * sizeof(T));
+  buffer_.clear();
+}
+
+template class PointFileWriter<float>;
+template class PointFileWriter<double>;
+
+} // namespace cppcourse
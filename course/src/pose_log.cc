@@ -0,0 +1,641 @@
+#include "pose_log.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "quaternion.h"
+#include "transform_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPPCOURSE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace cppcourse {
+
+namespace {
+
+const char kMagic[8] = {'C', 'P', 'P', 'C', 'P', 'L', 'O', 'G'};
+// Integers per pose: translation x, y, z, the three stored quaternion
+// components and the index of the dropped one.
+const std::size_t kChannels{7};
+const std::size_t kDroppedChannel{6};
+// Widths up to 56 bits leave room for the 0-7 bit offset inside one
+// 64-bit load.
+const unsigned kMaxWidth{56};
+// Poses whose integers are decoded at a time, on the stack.
+const std::size_t kDecodeBlock{256};
+// Stored components of a unit quaternion, one of the largest dropped, lie
+// in [-1/sqrt(2), 1/sqrt(2)].
+const double kComponentLimit{0.70710678118654752440};
+// Translations are limited to 2^51 steps from the origin, which integer to
+// double conversions tricks below rely on.
+const double kMaxSteps{2251799813685248.};
+// Where the three stored components go in (w, x, y, z), per dropped index.
+const int kStoredSlots[4][3] = {{1, 2, 3}, {0, 2, 3}, {0, 1, 3}, {0, 1, 2}};
+
+bool isLittleEndianHost() {
+  const std::uint32_t probe{1};
+  unsigned char first;
+  std::memcpy(&first, &probe, 1);
+  return first == 1;
+}
+
+template <typename Int> void storeLittle(unsigned char *bytes, Int value) {
+  for (std::size_t i = 0; i < sizeof(Int); ++i) {
+    bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+  }
+}
+
+template <typename Int> Int loadLittle(const unsigned char *bytes) {
+  Int value{};
+  for (std::size_t i = 0; i < sizeof(Int); ++i) {
+    value |= static_cast<Int>(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+// Eight bytes of the bit stream; the bit at `bytes` offset 0 is bit 0.
+inline std::uint64_t loadWord(const unsigned char *bytes) {
+  std::uint64_t word;
+  std::memcpy(&word, bytes, sizeof(word));
+  return isLittleEndianHost() ? word : __builtin_bswap64(word);
+}
+
+inline std::uint64_t zigzag(std::int64_t value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^
+         static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t value) {
+  return static_cast<std::int64_t>(value >> 1) ^
+         -static_cast<std::int64_t>(value & 1);
+}
+
+void putVarint(std::vector<std::uint8_t> &bytes, std::uint64_t value) {
+  while (value >= 0x80) {
+    bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Returns nullptr if the varint runs past `last` or over 64 bits.
+const std::uint8_t *getVarint(const std::uint8_t *first,
+                              const std::uint8_t *last,
+                              std::uint64_t &value) {
+  value = 0;
+  for (unsigned shift = 0; shift < 64 && first != last; shift += 7) {
+    const std::uint8_t byte = *first++;
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return first;
+    }
+  }
+  return nullptr;
+}
+
+// Value `Index` of a group of 8 packed at `Width` bits. A group takes
+// exactly `Width` bytes, so the load offset, shift and mask are constants.
+template <unsigned Width, std::size_t Index>
+inline std::int64_t packedAt(const std::uint8_t *group) {
+  if constexpr (Width == 0) {
+    return 0;
+  } else {
+    const std::uint64_t mask = ~std::uint64_t{0} >> (64 - Width);
+    return static_cast<std::int64_t>(
+        (loadWord(group + Index * Width / 8) >> (Index * Width % 8)) & mask);
+  }
+}
+
+template <unsigned Width, std::size_t... Index>
+inline void unpackGroup(const std::uint8_t *group, std::int64_t minimum,
+                        std::int64_t &sum, std::int64_t *out,
+                        std::index_sequence<Index...>) {
+  ((sum += packedAt<Width, Index>(group) + minimum, out[Index] = sum), ...);
+}
+
+// Running sums of `groups` groups of 8 deltas, each packed as its
+// difference to `minimum`.
+template <unsigned Width>
+void unpack(const std::uint8_t *bytes, std::size_t groups,
+            std::int64_t minimum, std::int64_t &sum, std::int64_t *out) {
+  std::int64_t running = sum;
+  for (std::size_t g = 0; g < groups; ++g) {
+    unpackGroup<Width>(bytes + g * Width, minimum, running, out + 8 * g,
+                       std::make_index_sequence<8>());
+  }
+  sum = running;
+}
+
+typedef void (*Unpacker)(const std::uint8_t *, std::size_t, std::int64_t,
+                         std::int64_t &, std::int64_t *);
+
+template <std::size_t... Widths>
+constexpr std::array<Unpacker, sizeof...(Widths)>
+makeUnpackers(std::index_sequence<Widths...>) {
+  return {{&unpack<Widths>...}};
+}
+
+const std::array<Unpacker, kMaxWidth + 1> kUnpackers =
+    makeUnpackers(std::make_index_sequence<kMaxWidth + 1>());
+
+// Decoded integers of a block of poses, one array per channel.
+typedef std::int64_t BlockValues[kChannels][kDecodeBlock];
+
+// Turns the integers back into scalars.
+template <typename T> struct Dequantization {
+  T step;
+  // Component = integer * scale - offset.
+  T scale;
+  T offset;
+};
+
+// Poses [from, to) of a block into out[0, to - from).
+template <typename T>
+void reconstructScalar(const BlockValues &values, std::size_t from,
+                       std::size_t to, const Dequantization<T> &dq,
+                       IsometryT<T> *out) {
+  for (std::size_t i = from; i < to; ++i) {
+    const T a = static_cast<T>(values[3][i]) * dq.scale - dq.offset;
+    const T b = static_cast<T>(values[4][i]) * dq.scale - dq.offset;
+    const T c = static_cast<T>(values[5][i]) * dq.scale - dq.offset;
+    const std::int64_t dropped = values[kDroppedChannel][i];
+    const T d = std::sqrt(std::max(T(0), 1 - a * a - b * b - c * c));
+    // The stored components fill the other slots in order.
+    const T w = dropped == 0 ? d : a;
+    const T x = dropped == 0 ? a : (dropped == 1 ? d : b);
+    const T y = dropped < 2 ? b : (dropped == 2 ? d : c);
+    const T z = dropped < 3 ? c : d;
+    out[i - from] = IsometryT<T>(
+        Vector3T<T>(static_cast<T>(values[0][i]) * dq.step,
+                    static_cast<T>(values[1][i]) * dq.step,
+                    static_cast<T>(values[2][i]) * dq.step),
+        QuaternionT<T>(w, x, y, z).toRotation());
+  }
+}
+
+#ifdef CPPCOURSE_X86_KERNELS
+
+// No "fma": contracted multiply-adds would round differently from the
+// scalar code.
+#define CPPCOURSE_TARGET_AVX2 __attribute__((target("avx2")))
+
+// Four poses per register: __m256d for double, __m128 for float. Integers
+// below 2^51 convert exactly to double by adding them to the bits of
+// 2^52 + 2^51, and from there to float with the same rounding as a direct
+// conversion, so both match reconstructScalar() bit for bit.
+template <typename T> struct Avx2Lanes;
+template <> struct Avx2Lanes<double> {
+  typedef __m256d Reg;
+  CPPCOURSE_TARGET_AVX2 static Reg set1(double v) { return _mm256_set1_pd(v); }
+  CPPCOURSE_TARGET_AVX2 static Reg fromInt64(const std::int64_t *p) {
+    const __m256i bits = _mm256_add_epi64(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)),
+        _mm256_set1_epi64x(0x4338000000000000));
+    return _mm256_sub_pd(_mm256_castsi256_pd(bits),
+                         _mm256_set1_pd(6755399441055744.));
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg add(Reg a, Reg b) {
+    return _mm256_add_pd(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg sub(Reg a, Reg b) {
+    return _mm256_sub_pd(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg mul(Reg a, Reg b) {
+    return _mm256_mul_pd(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg max(Reg a, Reg b) {
+    return _mm256_max_pd(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg sqrt(Reg a) { return _mm256_sqrt_pd(a); }
+  CPPCOURSE_TARGET_AVX2 static Reg equal(Reg a, Reg b) {
+    return _mm256_cmp_pd(a, b, _CMP_EQ_OQ);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg less(Reg a, Reg b) {
+    return _mm256_cmp_pd(a, b, _CMP_LT_OQ);
+  }
+  // `b` where `mask` is set, `a` elsewhere.
+  CPPCOURSE_TARGET_AVX2 static Reg select(Reg mask, Reg a, Reg b) {
+    return _mm256_blendv_pd(a, b, mask);
+  }
+  // Writes scalars k to k + 3 of four poses, one register per scalar, to
+  // the poses starting at `out` + k.
+  CPPCOURSE_TARGET_AVX2 static void store(double *out, Reg r0, Reg r1, Reg r2,
+                                          Reg r3) {
+    const Reg t0 = _mm256_unpacklo_pd(r0, r1);
+    const Reg t1 = _mm256_unpackhi_pd(r0, r1);
+    const Reg t2 = _mm256_unpacklo_pd(r2, r3);
+    const Reg t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(out, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(out + 12, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(out + 24, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(out + 36, _mm256_permute2f128_pd(t1, t3, 0x31));
+  }
+};
+template <> struct Avx2Lanes<float> {
+  typedef __m128 Reg;
+  CPPCOURSE_TARGET_AVX2 static Reg set1(float v) { return _mm_set1_ps(v); }
+  CPPCOURSE_TARGET_AVX2 static Reg fromInt64(const std::int64_t *p) {
+    return _mm256_cvtpd_ps(Avx2Lanes<double>::fromInt64(p));
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg add(Reg a, Reg b) {
+    return _mm_add_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg sub(Reg a, Reg b) {
+    return _mm_sub_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg mul(Reg a, Reg b) {
+    return _mm_mul_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg max(Reg a, Reg b) {
+    return _mm_max_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg sqrt(Reg a) { return _mm_sqrt_ps(a); }
+  CPPCOURSE_TARGET_AVX2 static Reg equal(Reg a, Reg b) {
+    return _mm_cmpeq_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg less(Reg a, Reg b) {
+    return _mm_cmplt_ps(a, b);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg select(Reg mask, Reg a, Reg b) {
+    return _mm_blendv_ps(a, b, mask);
+  }
+  CPPCOURSE_TARGET_AVX2 static void store(float *out, Reg r0, Reg r1, Reg r2,
+                                          Reg r3) {
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(out, r0);
+    _mm_storeu_ps(out + 12, r1);
+    _mm_storeu_ps(out + 24, r2);
+    _mm_storeu_ps(out + 36, r3);
+  }
+};
+
+// Same operations in the same order as reconstructScalar(), four poses at
+// a time, without fused multiply-adds.
+template <typename T>
+CPPCOURSE_TARGET_AVX2 void
+reconstructAvx2(const BlockValues &values, std::size_t from, std::size_t to,
+                const Dequantization<T> &dq, IsometryT<T> *out) {
+  typedef Avx2Lanes<T> L;
+  typedef typename L::Reg Reg;
+  const Reg step = L::set1(dq.step), scale = L::set1(dq.scale),
+            offset = L::set1(dq.offset);
+  const Reg zero = L::set1(0), one = L::set1(1), two = L::set1(2),
+            three = L::set1(3);
+  std::size_t i = from;
+  for (; i + 4 <= to; i += 4) {
+    const Reg a = L::sub(L::mul(L::fromInt64(values[3] + i), scale), offset);
+    const Reg b = L::sub(L::mul(L::fromInt64(values[4] + i), scale), offset);
+    const Reg c = L::sub(L::mul(L::fromInt64(values[5] + i), scale), offset);
+    const Reg dropped = L::fromInt64(values[kDroppedChannel] + i);
+    const Reg d = L::sqrt(L::max(
+        L::sub(L::sub(L::sub(one, L::mul(a, a)), L::mul(b, b)), L::mul(c, c)),
+        zero));
+    const Reg is0 = L::equal(dropped, zero);
+    const Reg w = L::select(is0, a, d);
+    const Reg x = L::select(is0, L::select(L::equal(dropped, one), b, d), a);
+    const Reg y = L::select(L::less(dropped, two),
+                            L::select(L::equal(dropped, two), c, d), b);
+    const Reg z = L::select(L::less(dropped, three), d, c);
+
+    // QuaternionT::toRotation().
+    const Reg xx = L::mul(x, x), yy = L::mul(y, y), zz = L::mul(z, z);
+    const Reg xy = L::mul(x, y), xz = L::mul(x, z), yz = L::mul(y, z);
+    const Reg wx = L::mul(w, x), wy = L::mul(w, y), wz = L::mul(w, z);
+    T *pose = reinterpret_cast<T *>(out + (i - from));
+    L::store(pose, L::sub(one, L::mul(two, L::add(yy, zz))),
+             L::mul(two, L::sub(xy, wz)), L::mul(two, L::add(xz, wy)),
+             L::mul(two, L::add(xy, wz)));
+    L::store(pose + 4, L::sub(one, L::mul(two, L::add(xx, zz))),
+             L::mul(two, L::sub(yz, wx)), L::mul(two, L::sub(xz, wy)),
+             L::mul(two, L::add(yz, wx)));
+    L::store(pose + 8, L::sub(one, L::mul(two, L::add(xx, yy))),
+             L::mul(L::fromInt64(values[0] + i), step),
+             L::mul(L::fromInt64(values[1] + i), step),
+             L::mul(L::fromInt64(values[2] + i), step));
+  }
+  reconstructScalar(values, i, to, dq, out + (i - from));
+}
+
+#endif // CPPCOURSE_X86_KERNELS
+
+// Levels of a quantized quaternion component, 0 to 2^bits - 1.
+double componentLevels(int bits) {
+  return static_cast<double>((std::uint64_t{1} << bits) - 1);
+}
+
+std::invalid_argument malformed(const char *what) {
+  return std::invalid_argument(std::string("Malformed pose log: ") + what);
+}
+
+} // namespace
+
+double PoseLogOptions::maxRotationError() const {
+  // Each stored component is off by up to e = 1 / (sqrt(2) levels). The
+  // dropped one, at least 1/2, moves by at most sqrt(3) e through the
+  // normalization, so the quaternion moves by at most 2 sqrt(3) e and the
+  // rotation by twice that.
+  return 2. * std::sqrt(6.) / componentLevels(rotation_bits);
+}
+
+PoseLogEncoder::PoseLogEncoder(const PoseLogOptions &options)
+    : options_(options) {
+  if (!(options.translation_step > 0.) ||
+      !std::isfinite(options.translation_step)) {
+    throw std::invalid_argument("Pose log translation step must be > 0.");
+  }
+  if (options.rotation_bits < 4 || options.rotation_bits > 30) {
+    throw std::invalid_argument("Pose log rotation bits must be in [4, 30].");
+  }
+  if (options.chunk_size == 0) {
+    throw std::invalid_argument("Pose log chunks need room for a pose.");
+  }
+  pending_.resize(kChannels * options.chunk_size);
+  bytes_.resize(kPoseLogHeaderSize);
+}
+
+void PoseLogEncoder::append(const Isometry *poses, std::size_t count) {
+  appendPoses(poses, count);
+}
+
+void PoseLogEncoder::append(const Isometryf *poses, std::size_t count) {
+  appendPoses(poses, count);
+}
+
+template <typename T>
+void PoseLogEncoder::appendPoses(const IsometryT<T> *poses,
+                                 std::size_t count) {
+  const std::size_t chunk_size = options_.chunk_size;
+  const double inverse_step = 1. / options_.translation_step;
+  const double levels = componentLevels(options_.rotation_bits);
+  for (std::size_t i = 0; i < count; ++i) {
+    std::int64_t *slot = pending_.data() + pending_count_;
+    for (int k = 0; k < 3; ++k) {
+      const double steps = poses[i].translation()[k] * inverse_step;
+      if (!(std::abs(steps) < kMaxSteps)) {
+        throw std::invalid_argument(
+            "Pose log translation out of range for its step.");
+      }
+      slot[k * chunk_size] = std::llround(steps);
+    }
+
+    const Quaternion q =
+        Quaternion::FromRotation(poses[i].rotation().template cast<double>());
+    const double components[4] = {q.w(), q.x(), q.y(), q.z()};
+    int dropped = 0;
+    for (int k = 1; k < 4; ++k) {
+      if (std::abs(components[k]) > std::abs(components[dropped])) {
+        dropped = k;
+      }
+    }
+    // q and -q are the same rotation; keep the one whose dropped component
+    // is positive so it can be recovered from the others.
+    const double sign = components[dropped] < 0. ? -1. : 1.;
+    for (int k = 0; k < 3; ++k) {
+      const double c = std::min(
+          std::max(sign * components[kStoredSlots[dropped][k]],
+                   -kComponentLimit),
+          kComponentLimit);
+      slot[(3 + k) * chunk_size] =
+          std::llround((c / kComponentLimit + 1.) * 0.5 * levels);
+    }
+    slot[kDroppedChannel * chunk_size] = dropped;
+
+    ++count_;
+    if (++pending_count_ == chunk_size) {
+      encodeChunk();
+    }
+  }
+}
+
+void PoseLogEncoder::encodeChunk() {
+  chunk_offsets_.push_back(bytes_.size());
+  const std::size_t chunk_size = options_.chunk_size;
+  const std::size_t n = pending_count_;
+  unsigned widths[kChannels];
+  std::int64_t minimums[kChannels];
+  for (std::size_t c = 0; c < kChannels; ++c) {
+    const std::int64_t *values = pending_.data() + c * chunk_size;
+    std::int64_t minimum = n > 1 ? values[1] - values[0] : 0;
+    std::int64_t maximum = minimum;
+    for (std::size_t i = 2; i < n; ++i) {
+      minimum = std::min(minimum, values[i] - values[i - 1]);
+      maximum = std::max(maximum, values[i] - values[i - 1]);
+    }
+    // Translations are within 2^51 steps, so the range of their deltas
+    // fits in 53 bits.
+    const std::uint64_t range = static_cast<std::uint64_t>(maximum - minimum);
+    widths[c] = 0;
+    while ((range >> widths[c]) != 0) {
+      ++widths[c];
+    }
+    minimums[c] = minimum;
+    // The value before the first pose, so that its delta is the minimum
+    // too and packs as 0.
+    putVarint(bytes_, zigzag(values[0] - minimum));
+    putVarint(bytes_, zigzag(minimum));
+    bytes_.push_back(static_cast<std::uint8_t>(widths[c]));
+  }
+
+  for (std::size_t c = 0; c < kChannels; ++c) {
+    const std::int64_t *values = pending_.data() + c * chunk_size;
+    const unsigned width = widths[c];
+    // Groups of 8 values take exactly `width` bytes.
+    const std::size_t groups = (n + 7) / 8;
+    std::size_t at = bytes_.size();
+    bytes_.resize(at + groups * width);
+    std::uint64_t buffer = 0;
+    unsigned buffered = 0;
+    // The first pose packs as 0 and the padding after the last as 0.
+    for (std::size_t i = 0; i < 8 * groups && width != 0; ++i) {
+      const std::uint64_t packed =
+          i > 0 && i < n ? static_cast<std::uint64_t>(
+                               values[i] - values[i - 1] - minimums[c])
+                         : 0;
+      buffer |= packed << buffered;
+      buffered += width;
+      while (buffered >= 8) {
+        bytes_[at++] = static_cast<std::uint8_t>(buffer);
+        buffer >>= 8;
+        buffered -= 8;
+      }
+    }
+  }
+  pending_count_ = 0;
+}
+
+std::vector<std::uint8_t> PoseLogEncoder::finish() {
+  if (pending_count_ != 0) {
+    encodeChunk();
+  }
+  const std::size_t index_offset = bytes_.size();
+  bytes_.resize(index_offset + 8 * chunk_offsets_.size());
+  for (std::size_t i = 0; i < chunk_offsets_.size(); ++i) {
+    storeLittle(&bytes_[index_offset + 8 * i], chunk_offsets_[i]);
+  }
+  unsigned char *header = bytes_.data();
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  storeLittle(header + 8, kPoseLogVersion);
+  storeLittle(header + 12, static_cast<std::uint32_t>(options_.rotation_bits));
+  std::uint64_t step_bits;
+  std::memcpy(&step_bits, &options_.translation_step, sizeof(step_bits));
+  storeLittle(header + 16, step_bits);
+  storeLittle(header + 24, static_cast<std::uint64_t>(count_));
+  storeLittle(header + 32, static_cast<std::uint64_t>(options_.chunk_size));
+  storeLittle(header + 40, static_cast<std::uint64_t>(index_offset));
+
+  std::vector<std::uint8_t> log;
+  log.swap(bytes_);
+  bytes_.resize(kPoseLogHeaderSize);
+  chunk_offsets_.clear();
+  count_ = 0;
+  return log;
+}
+
+PoseLogDecoder::PoseLogDecoder(const void *data, std::size_t size)
+    : data_(static_cast<const std::uint8_t *>(data)), size_(size) {
+  if (size < kPoseLogHeaderSize ||
+      std::memcmp(data_, kMagic, sizeof(kMagic)) != 0) {
+    throw malformed("bad header.");
+  }
+  if (loadLittle<std::uint32_t>(data_ + 8) != kPoseLogVersion) {
+    throw malformed("unsupported version.");
+  }
+  options_.rotation_bits =
+      static_cast<int>(loadLittle<std::uint32_t>(data_ + 12));
+  const std::uint64_t step_bits = loadLittle<std::uint64_t>(data_ + 16);
+  std::memcpy(&options_.translation_step, &step_bits, sizeof(step_bits));
+  const std::uint64_t count = loadLittle<std::uint64_t>(data_ + 24);
+  const std::uint64_t chunk_size = loadLittle<std::uint64_t>(data_ + 32);
+  const std::uint64_t index_offset = loadLittle<std::uint64_t>(data_ + 40);
+  if (options_.rotation_bits < 4 || options_.rotation_bits > 30 ||
+      !(options_.translation_step > 0.) ||
+      !std::isfinite(options_.translation_step) || chunk_size == 0) {
+    throw malformed("bad options.");
+  }
+  const std::uint64_t chunk_count =
+      count / chunk_size + (count % chunk_size != 0);
+  if (index_offset < kPoseLogHeaderSize || index_offset > size ||
+      chunk_count > (size - index_offset) / 8) {
+    throw malformed("truncated chunk index.");
+  }
+  options_.chunk_size = chunk_size;
+  count_ = count;
+  chunk_count_ = chunk_count;
+  index_offset_ = index_offset;
+  std::uint64_t previous = kPoseLogHeaderSize;
+  for (std::size_t i = 0; i < chunk_count_; ++i) {
+    const std::uint64_t offset =
+        loadLittle<std::uint64_t>(data_ + index_offset_ + 8 * i);
+    if (offset < previous || offset >= index_offset_) {
+      throw malformed("bad chunk offset.");
+    }
+    previous = offset;
+  }
+}
+
+template <typename T>
+void PoseLogDecoder::decode(std::size_t first, std::size_t count,
+                            IsometryT<T> *out) const {
+  if (first > count_ || count > count_ - first) {
+    throw std::out_of_range("Poses out of the pose log.");
+  }
+  const std::size_t chunk_size = options_.chunk_size;
+  while (count > 0) {
+    const std::size_t chunk = first / chunk_size;
+    const std::size_t begin = first - chunk * chunk_size;
+    const std::size_t end = std::min(chunk_size, begin + count);
+    decodeChunk(chunk, begin, end, out);
+    out += end - begin;
+    first += end - begin;
+    count -= end - begin;
+  }
+}
+
+template <typename T>
+void PoseLogDecoder::decodeChunk(std::size_t chunk, std::size_t begin,
+                                 std::size_t end, IsometryT<T> *out) const {
+  const std::size_t chunk_size = options_.chunk_size;
+  const std::size_t n = std::min(chunk_size, count_ - chunk * chunk_size);
+  const std::uint8_t *first =
+      data_ + loadLittle<std::uint64_t>(data_ + index_offset_ + 8 * chunk);
+  const std::uint8_t *last =
+      chunk + 1 < chunk_count_
+          ? data_ + loadLittle<std::uint64_t>(data_ + index_offset_ +
+                                               8 * (chunk + 1))
+          : data_ + index_offset_;
+
+  std::int64_t sums[kChannels];
+  std::int64_t minimums[kChannels];
+  unsigned widths[kChannels];
+  for (std::size_t c = 0; c < kChannels; ++c) {
+    std::uint64_t before, minimum;
+    first = getVarint(first, last, before);
+    if (first != nullptr) {
+      first = getVarint(first, last, minimum);
+    }
+    if (first == nullptr || first == last) {
+      throw malformed("truncated chunk.");
+    }
+    sums[c] = unzigzag(before);
+    minimums[c] = unzigzag(minimum);
+    widths[c] = *first++;
+  }
+  const std::size_t groups = (n + 7) / 8;
+  const std::uint8_t *streams[kChannels];
+  std::size_t stream_bytes = 0;
+  for (std::size_t c = 0; c < kChannels; ++c) {
+    if (widths[c] > kMaxWidth || (widths[c] != 0 && groups > size_)) {
+      throw malformed("bad delta width.");
+    }
+    streams[c] = first + stream_bytes;
+    stream_bytes += groups * widths[c];
+  }
+  // Loads read up to 7 bytes past the streams, which the next chunk or the
+  // index always provides.
+  if (stream_bytes > static_cast<std::size_t>(last - first)) {
+    throw malformed("truncated chunk.");
+  }
+
+  const Dequantization<T> dq = {
+      static_cast<T>(options_.translation_step),
+      static_cast<T>(2. * kComponentLimit /
+                     componentLevels(options_.rotation_bits)),
+      static_cast<T>(kComponentLimit)};
+#ifdef CPPCOURSE_X86_KERNELS
+  static const bool use_avx2 =
+      kernels::activeBackend() >= kernels::Backend::kAvx2;
+#endif
+  BlockValues values;
+  for (std::size_t block = 0; block < end; block += kDecodeBlock) {
+    const std::size_t size = std::min(kDecodeBlock, end - block);
+    for (std::size_t c = 0; c < kChannels; ++c) {
+      kUnpackers[widths[c]](streams[c], (size + 7) / 8, minimums[c], sums[c],
+                            values[c]);
+      streams[c] += kDecodeBlock / 8 * widths[c];
+    }
+    const std::size_t from = std::max(begin, block) - block;
+    IsometryT<T> *poses = out + (block + from - begin);
+#ifdef CPPCOURSE_X86_KERNELS
+    if (use_avx2) {
+      reconstructAvx2(values, from, size, dq, poses);
+      continue;
+    }
+#endif
+    reconstructScalar(values, from, size, dq, poses);
+  }
+}
+
+#define CPPCOURSE_INSTANTIATE_POSE_LOG(T)                                      \
+  template void PoseLogDecoder::decode(std::size_t, std::size_t,               \
+                                       IsometryT<T> *) const
+CPPCOURSE_INSTANTIATE_POSE_LOG(float);
+CPPCOURSE_INSTANTIATE_POSE_LOG(double);
+#undef CPPCOURSE_INSTANTIATE_POSE_LOG
+
+} // namespace cppcourse
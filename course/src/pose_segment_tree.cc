@@ -0,0 +1,69 @@
+#include "pose_segment_tree.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace cppcourse {
+
+template <typename T>
+PoseSegmentTreeT<T>::PoseSegmentTreeT(const IsometryT<T> *increments,
+                                      std::size_t count)
+    : size_(count), nodes_(2 * count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    nodes_[count + i] = increments[i];
+  }
+  for (std::size_t k = count; k-- > 1;) {
+    nodes_[k] = nodes_[2 * k] * nodes_[2 * k + 1];
+  }
+}
+
+template <typename T>
+const IsometryT<T> &PoseSegmentTreeT<T>::increment(std::size_t index) const {
+  if (index >= size_) {
+    throw std::out_of_range("Increment " + std::to_string(index) +
+                            " out of range.");
+  }
+  return nodes_[size_ + index];
+}
+
+template <typename T>
+void PoseSegmentTreeT<T>::update(std::size_t index,
+                                 const IsometryT<T> &increment) {
+  if (index >= size_) {
+    throw std::out_of_range("Increment " + std::to_string(index) +
+                            " out of range.");
+  }
+  std::size_t k = size_ + index;
+  nodes_[k] = increment;
+  for (k /= 2; k >= 1; k /= 2) {
+    nodes_[k] = nodes_[2 * k] * nodes_[2 * k + 1];
+  }
+}
+
+template <typename T>
+IsometryT<T> PoseSegmentTreeT<T>::compose(std::size_t begin,
+                                          std::size_t end) const {
+  if (begin > end || end > size_) {
+    throw std::out_of_range("Range [" + std::to_string(begin) + ", " +
+                            std::to_string(end) + ") out of range.");
+  }
+  // Walk up from both ends; a boundary node that is a right child on the
+  // left (or a left child on the right) is fully inside the range.
+  IsometryT<T> left;
+  IsometryT<T> right;
+  for (std::size_t l = begin + size_, r = end + size_; l < r;
+       l /= 2, r /= 2) {
+    if (l & 1) {
+      left = left * nodes_[l++];
+    }
+    if (r & 1) {
+      right = nodes_[--r] * right;
+    }
+  }
+  return left * right;
+}
+
+template class PoseSegmentTreeT<float>;
+template class PoseSegmentTreeT<double>;
+
+} // namespace cppcourse
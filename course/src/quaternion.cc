@@ -0,0 +1,73 @@
+#include "quaternion.h"
+
+#include <limits>
+
+namespace cppcourse {
+
+template <typename T>
+QuaternionT<T> QuaternionT<T>::FromRotation(const Matrix3T<T> &rotation) {
+  const Matrix3T<T> &m = rotation;
+  const T trace = m(0, 0) + m(1, 1) + m(2, 2);
+  // Divides by the largest of the four candidate components to stay away
+  // from cancellation.
+  if (trace > 0) {
+    const T s = std::sqrt(trace + 1) * 2;
+    return QuaternionT(s / 4, (m(2, 1) - m(1, 2)) / s, (m(0, 2) - m(2, 0)) / s,
+                       (m(1, 0) - m(0, 1)) / s)
+        .normalized();
+  }
+  if (m(0, 0) > m(1, 1) && m(0, 0) > m(2, 2)) {
+    const T s = std::sqrt(1 + m(0, 0) - m(1, 1) - m(2, 2)) * 2;
+    return QuaternionT((m(2, 1) - m(1, 2)) / s, s / 4, (m(0, 1) + m(1, 0)) / s,
+                       (m(0, 2) + m(2, 0)) / s)
+        .normalized();
+  }
+  if (m(1, 1) > m(2, 2)) {
+    const T s = std::sqrt(1 + m(1, 1) - m(0, 0) - m(2, 2)) * 2;
+    return QuaternionT((m(0, 2) - m(2, 0)) / s, (m(0, 1) + m(1, 0)) / s, s / 4,
+                       (m(1, 2) + m(2, 1)) / s)
+        .normalized();
+  }
+  const T s = std::sqrt(1 + m(2, 2) - m(0, 0) - m(1, 1)) * 2;
+  return QuaternionT((m(1, 0) - m(0, 1)) / s, (m(0, 2) + m(2, 0)) / s,
+                     (m(1, 2) + m(2, 1)) / s, s / 4)
+      .normalized();
+}
+
+template <typename T>
+QuaternionT<T> QuaternionT<T>::slerp(const QuaternionT &other,
+                                     const T &t) const {
+  // q and -q are the same rotation; take the one on the shorter arc.
+  const T dot = w() * other.w() + x() * other.x() + y() * other.y() +
+                z() * other.z();
+  const T sign = dot < 0 ? T(-1) : T(1);
+  const T dw = sign * other.w() - w(), sw = sign * other.w() + w();
+  const T dx = sign * other.x() - x(), sx = sign * other.x() + x();
+  const T dy = sign * other.y() - y(), sy = sign * other.y() + y();
+  const T dz = sign * other.z() - z(), sz = sign * other.z() + z();
+  // Angle between the two 4-vectors from |q1 - q0| and |q1 + q0|, accurate
+  // even for the tiny steps between densely sampled poses, unlike acos(dot).
+  const T difference = std::sqrt(dw * dw + dx * dx + dy * dy + dz * dz);
+  const T sum = std::sqrt(sw * sw + sx * sx + sy * sy + sz * sz);
+  const T angle = 2 * std::atan2(difference, sum);
+  T from_weight = 1 - t;
+  T to_weight = t;
+  if (angle > std::numeric_limits<T>::epsilon()) {
+    const T inverse_sin = T(1) / std::sin(angle);
+    from_weight = std::sin((1 - t) * angle) * inverse_sin;
+    to_weight = std::sin(t * angle) * inverse_sin;
+  }
+  to_weight *= sign;
+  return QuaternionT(from_weight * w() + to_weight * other.w(),
+                     from_weight * x() + to_weight * other.x(),
+                     from_weight * y() + to_weight * other.y(),
+                     from_weight * z() + to_weight * other.z())
+      .normalized();
+}
+
+template class QuaternionT<float>;
+template class QuaternionT<double>;
+template class IsometryQT<float>;
+template class IsometryQT<double>;
+
+} // namespace cppcourse
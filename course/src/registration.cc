@@ -0,0 +1,274 @@
+#include "registration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "decomposition.h"
+#include "transform_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPPCOURSE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace cppcourse {
+
+namespace {
+
+// Weighted sums over the pairs of p = source[i] - source[0] and
+// q = target[i] - target[0].
+struct Moments {
+  double weight = 0.;
+  double source[3] = {0., 0., 0.};
+  double target[3] = {0., 0., 0.};
+  // Row-major sum of w p q^T.
+  double cross[9] = {0., 0., 0., 0., 0., 0., 0., 0., 0.};
+};
+
+// Adds pairs [begin, size) one at a time; works on any stride.
+template <typename T>
+void accumulateScalar(const PointView3T<T> &source,
+                      const PointView3T<T> &target, const T *weights,
+                      const Vector3 &source_origin,
+                      const Vector3 &target_origin, std::size_t begin,
+                      Moments &moments) {
+  for (std::size_t i = begin; i < source.size(); ++i) {
+    const double w = weights ? double(weights[i]) : 1.;
+    const double p[3] = {source.x[i] - source_origin[0],
+                         source.y[i] - source_origin[1],
+                         source.z[i] - source_origin[2]};
+    const double q[3] = {target.x[i] - target_origin[0],
+                         target.y[i] - target_origin[1],
+                         target.z[i] - target_origin[2]};
+    moments.weight += w;
+    for (int r = 0; r < 3; ++r) {
+      const double wp = w * p[r];
+      moments.source[r] += wp;
+      moments.target[r] += w * q[r];
+      for (int c = 0; c < 3; ++c) {
+        moments.cross[3 * r + c] += wp * q[c];
+      }
+    }
+  }
+}
+
+#ifdef CPPCOURSE_X86_KERNELS
+
+// Unlike the batch decompositions nothing here needs to match the scalar
+// path bit for bit, so the multiplies and adds may fuse.
+#define CPPCOURSE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+
+CPPCOURSE_TARGET_AVX2 inline __m256d load4(const double *p) {
+  return _mm256_loadu_pd(p);
+}
+CPPCOURSE_TARGET_AVX2 inline __m256d load4(const float *p) {
+  return _mm256_cvtps_pd(_mm_loadu_ps(p));
+}
+
+CPPCOURSE_TARGET_AVX2 inline double sum4(__m256d v) {
+  const __m128d pair =
+      _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+// Four pairs per iteration into one double accumulator per sum, widening
+// float input on load. Returns how many pairs it added; the caller adds
+// the rest.
+template <typename T, bool kWeighted>
+CPPCOURSE_TARGET_AVX2 std::size_t
+accumulateAvx2(const T *const source[3], const T *const target[3],
+               const T *weights, std::size_t count,
+               const Vector3 &source_origin, const Vector3 &target_origin,
+               Moments &moments) {
+  __m256d source_origin4[3], target_origin4[3];
+  __m256d weight_sum = _mm256_setzero_pd();
+  __m256d source_sum[3], target_sum[3], cross_sum[9];
+  for (int r = 0; r < 3; ++r) {
+    source_origin4[r] = _mm256_set1_pd(source_origin[r]);
+    target_origin4[r] = _mm256_set1_pd(target_origin[r]);
+    source_sum[r] = target_sum[r] = _mm256_setzero_pd();
+  }
+  for (__m256d &sum : cross_sum) {
+    sum = _mm256_setzero_pd();
+  }
+
+  const std::size_t end = count & ~std::size_t(3);
+  // Rolled up, as -O2 leaves them, the short loops below would keep the
+  // sums in memory instead of registers.
+  for (std::size_t i = 0; i < end; i += 4) {
+    __m256d p[3], q[3];
+#pragma GCC unroll 3
+    for (int r = 0; r < 3; ++r) {
+      p[r] = _mm256_sub_pd(load4(source[r] + i), source_origin4[r]);
+      q[r] = _mm256_sub_pd(load4(target[r] + i), target_origin4[r]);
+    }
+    if (kWeighted) {
+      const __m256d w = load4(weights + i);
+      weight_sum = _mm256_add_pd(weight_sum, w);
+#pragma GCC unroll 3
+      for (int r = 0; r < 3; ++r) {
+        target_sum[r] = _mm256_fmadd_pd(w, q[r], target_sum[r]);
+        p[r] = _mm256_mul_pd(w, p[r]);
+      }
+    } else {
+#pragma GCC unroll 3
+      for (int r = 0; r < 3; ++r) {
+        target_sum[r] = _mm256_add_pd(target_sum[r], q[r]);
+      }
+    }
+#pragma GCC unroll 3
+    for (int r = 0; r < 3; ++r) {
+      source_sum[r] = _mm256_add_pd(source_sum[r], p[r]);
+#pragma GCC unroll 3
+      for (int c = 0; c < 3; ++c) {
+        cross_sum[3 * r + c] =
+            _mm256_fmadd_pd(p[r], q[c], cross_sum[3 * r + c]);
+      }
+    }
+  }
+
+  moments.weight += kWeighted ? sum4(weight_sum) : double(end);
+  for (int r = 0; r < 3; ++r) {
+    moments.source[r] += sum4(source_sum[r]);
+    moments.target[r] += sum4(target_sum[r]);
+  }
+  for (int k = 0; k < 9; ++k) {
+    moments.cross[k] += sum4(cross_sum[k]);
+  }
+  return end;
+}
+
+template <typename T>
+bool contiguous(const PointView3T<T> &view) {
+  return view.x.isContiguous() && view.y.isContiguous() &&
+         view.z.isContiguous();
+}
+
+// Runs accumulateAvx2() on the views, copying strided coordinates to the
+// stack a block at a time.
+template <typename T, bool kWeighted>
+std::size_t accumulateVector(const PointView3T<T> &source,
+                             const PointView3T<T> &target, const T *weights,
+                             const Vector3 &source_origin,
+                             const Vector3 &target_origin, Moments &moments) {
+  if (contiguous(source) && contiguous(target)) {
+    const T *const source_data[3] = {
+        reinterpret_cast<const T *>(source.x.data()),
+        reinterpret_cast<const T *>(source.y.data()),
+        reinterpret_cast<const T *>(source.z.data())};
+    const T *const target_data[3] = {
+        reinterpret_cast<const T *>(target.x.data()),
+        reinterpret_cast<const T *>(target.y.data()),
+        reinterpret_cast<const T *>(target.z.data())};
+    return accumulateAvx2<T, kWeighted>(source_data, target_data, weights,
+                                        source.size(), source_origin,
+                                        target_origin, moments);
+  }
+  const std::size_t kBlock = 256;
+  T block[6][kBlock];
+  const T *const source_data[3] = {block[0], block[1], block[2]};
+  const T *const target_data[3] = {block[3], block[4], block[5]};
+  std::size_t done = 0;
+  while (source.size() - done >= 4) {
+    const std::size_t count =
+        std::min(kBlock, (source.size() - done) & ~std::size_t(3));
+    for (std::size_t i = 0; i < count; ++i) {
+      block[0][i] = source.x[done + i];
+      block[1][i] = source.y[done + i];
+      block[2][i] = source.z[done + i];
+      block[3][i] = target.x[done + i];
+      block[4][i] = target.y[done + i];
+      block[5][i] = target.z[done + i];
+    }
+    accumulateAvx2<T, kWeighted>(source_data, target_data,
+                                 kWeighted ? weights + done : nullptr, count,
+                                 source_origin, target_origin, moments);
+    done += count;
+  }
+  return done;
+}
+
+#endif // CPPCOURSE_X86_KERNELS
+
+template <typename T>
+IsometryT<T> estimate(const PointView3T<T> &source,
+                      const PointView3T<T> &target, const T *weights) {
+  if (source.size() != target.size()) {
+    throw std::invalid_argument("Source and target sizes differ.");
+  }
+  if (source.empty()) {
+    throw std::invalid_argument("No point pairs to register.");
+  }
+  const Vector3 source_origin = source[0].template cast<double>();
+  const Vector3 target_origin = target[0].template cast<double>();
+
+  Moments moments;
+  std::size_t done = 0;
+#ifdef CPPCOURSE_X86_KERNELS
+  if (kernels::activeBackend() >= kernels::Backend::kAvx2) {
+    done = weights ? accumulateVector<T, true>(source, target, weights,
+                                               source_origin, target_origin,
+                                               moments)
+                   : accumulateVector<T, false>(source, target, weights,
+                                                source_origin, target_origin,
+                                                moments);
+  }
+#endif
+  accumulateScalar(source, target, weights, source_origin, target_origin,
+                   done, moments);
+
+  if (!(moments.weight > 0.) || !std::isfinite(moments.weight)) {
+    throw std::invalid_argument("Weights must add up to a positive number.");
+  }
+  const Vector3 source_mean(moments.source[0] / moments.weight,
+                            moments.source[1] / moments.weight,
+                            moments.source[2] / moments.weight);
+  const Vector3 target_mean(moments.target[0] / moments.weight,
+                            moments.target[1] / moments.weight,
+                            moments.target[2] / moments.weight);
+  // sum w (p - source_mean) (q - target_mean)^T.
+  Matrix3 covariance;
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) {
+      covariance[r][c] =
+          moments.cross[3 * r + c] - moments.source[r] * target_mean[c];
+    }
+  }
+  // The rotation maximizing trace(R covariance) = trace(v^T R u s) is
+  // v u^T, since svd() leaves any reflection in the last singular value.
+  const Svd decomposition = svd(covariance);
+  const Matrix3 rotation =
+      decomposition.v.product(decomposition.u.transpose());
+  const Vector3 translation =
+      target_origin + target_mean -
+      rotation.product(Vector3(source_origin + source_mean));
+  return IsometryT<T>(translation.template cast<T>(),
+                      rotation.template cast<T>());
+}
+
+} // namespace
+
+template <typename T>
+IsometryT<T> estimateRigidTransform(const PointView3T<T> &source,
+                                    const PointView3T<T> &target) {
+  return estimate<T>(source, target, nullptr);
+}
+
+template <typename T>
+IsometryT<T> estimateRigidTransform(const PointView3T<T> &source,
+                                    const PointView3T<T> &target,
+                                    const T *weights) {
+  return estimate(source, target, weights);
+}
+
+#define CPPCOURSE_INSTANTIATE_REGISTRATION(T)                                  \
+  template IsometryT<T> estimateRigidTransform(const PointView3T<T> &,         \
+                                               const PointView3T<T> &);        \
+  template IsometryT<T> estimateRigidTransform(                                \
+      const PointView3T<T> &, const PointView3T<T> &, const T *)
+CPPCOURSE_INSTANTIATE_REGISTRATION(float);
+CPPCOURSE_INSTANTIATE_REGISTRATION(double);
+#undef CPPCOURSE_INSTANTIATE_REGISTRATION
+
+} // namespace cppcourse
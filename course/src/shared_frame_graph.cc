@@ -0,0 +1,57 @@
+#include "shared_frame_graph.h"
+
+#include <thread>
+
+namespace cppcourse {
+
+SharedFrameGraph::Reader::Reader(Reader &&other)
+    : graph_(other.graph_), readers_(other.readers_) {
+  other.readers_ = nullptr;
+}
+
+SharedFrameGraph::Reader::~Reader() {
+  if (readers_ != nullptr) {
+    readers_->fetch_sub(1);
+  }
+}
+
+SharedFrameGraph::SharedFrameGraph(const FrameGraph &graph) {
+  FrameGraph *snapshot = new FrameGraph(graph);
+  snapshot->resolveAll();
+  current_.store(snapshot);
+  readers_[0].store(0);
+  readers_[1].store(0);
+}
+
+SharedFrameGraph::~SharedFrameGraph() { delete current_.load(); }
+
+SharedFrameGraph::Reader SharedFrameGraph::read() const {
+  for (;;) {
+    const std::uint64_t epoch = epoch_.load();
+    std::atomic<std::int64_t> &readers = readers_[epoch & 1];
+    readers.fetch_add(1);
+    // If publish() advanced the epoch in between it may not wait for this
+    // counter; back off and retry in the new epoch.
+    if (epoch_.load() == epoch) {
+      return Reader(current_.load(), &readers);
+    }
+    readers.fetch_sub(1);
+  }
+}
+
+void SharedFrameGraph::publish(const FrameGraph &graph) {
+  FrameGraph *snapshot = new FrameGraph(graph);
+  snapshot->resolveAll();
+
+  std::lock_guard<std::mutex> lock(publish_mutex_);
+  const FrameGraph *previous = current_.exchange(snapshot);
+  // Readers registered from now on see `snapshot`; wait for the ones that
+  // registered before and may hold `previous`.
+  const std::uint64_t epoch = epoch_.fetch_add(1);
+  while (readers_[epoch & 1].load() != 0) {
+    std::this_thread::yield();
+  }
+  delete previous;
+}
+
+} // namespace cppcourse
@@ -0,0 +1,67 @@
+#include "sliding_window.h"
+
+#include <stdexcept>
+
+namespace cppcourse {
+
+template <typename T>
+SlidingWindowComposerT<T>::SlidingWindowComposerT(std::size_t capacity) {
+  if (capacity == 0) {
+    throw std::invalid_argument("SlidingWindowComposer needs a capacity.");
+  }
+  slots_.resize(capacity);
+}
+
+template <typename T>
+void SlidingWindowComposerT<T>::push(const IsometryT<T> &increment) {
+  if (full()) {
+    pop();
+  }
+  slots_[slot(size_)] = increment;
+  ++size_;
+  newer_product_ = newer_product_ * increment;
+}
+
+template <typename T> void SlidingWindowComposerT<T>::pop() {
+  if (empty()) {
+    throw std::out_of_range("Pop from an empty SlidingWindowComposer.");
+  }
+  if (older_ == 0) {
+    flip();
+  }
+  head_ = slot(1);
+  --size_;
+  --older_;
+}
+
+template <typename T> void SlidingWindowComposerT<T>::clear() {
+  head_ = 0;
+  size_ = 0;
+  older_ = 0;
+  newer_product_ = IsometryT<T>();
+}
+
+template <typename T>
+IsometryT<T> SlidingWindowComposerT<T>::windowComposition() const {
+  if (older_ == 0) {
+    return newer_product_;
+  }
+  return slots_[head_] * newer_product_;
+}
+
+template <typename T> void SlidingWindowComposerT<T>::flip() {
+  // Only called with an empty older part, so the newer part is everything.
+  IsometryT<T> suffix;
+  for (std::size_t index = size_; index-- > 0;) {
+    IsometryT<T> &value = slots_[slot(index)];
+    suffix = value * suffix;
+    value = suffix;
+  }
+  older_ = size_;
+  newer_product_ = IsometryT<T>();
+}
+
+template class SlidingWindowComposerT<float>;
+template class SlidingWindowComposerT<double>;
+
+} // namespace cppcourse
@@ -0,0 +1,195 @@
+#include "text.h"
+
+namespace cppcourse {
+namespace text {
+
+namespace {
+
+// The scalars of an element in text order.
+template <typename T> void toScalars(const Vector3T<T> &v, T *scalars) {
+  for (int i = 0; i < 3; ++i) {
+    scalars[i] = v[i];
+  }
+}
+template <typename T> void toScalars(const Matrix3T<T> &m, T *scalars) {
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      scalars[3 * i + j] = m(i, j);
+    }
+  }
+}
+template <typename T> void toScalars(const IsometryT<T> &iso, T *scalars) {
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      scalars[4 * i + j] = iso.rotation()(i, j);
+    }
+    scalars[4 * i + 3] = iso.translation()[i];
+  }
+}
+
+template <typename T> void fromScalars(const T *scalars, Vector3T<T> &v) {
+  v = Vector3T<T>(scalars[0], scalars[1], scalars[2]);
+}
+template <typename T> void fromScalars(const T *scalars, Matrix3T<T> &m) {
+  for (int i = 0; i < 3; ++i) {
+    m[i] = Vector3T<T>(scalars[3 * i], scalars[3 * i + 1], scalars[3 * i + 2]);
+  }
+}
+template <typename T> void fromScalars(const T *scalars, IsometryT<T> &iso) {
+  Matrix3T<T> rotation;
+  Vector3T<T> translation;
+  for (int i = 0; i < 3; ++i) {
+    rotation[i] =
+        Vector3T<T>(scalars[4 * i], scalars[4 * i + 1], scalars[4 * i + 2]);
+    translation[i] = scalars[4 * i + 3];
+  }
+  iso = IsometryT<T>(translation, rotation);
+}
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+const char *skipBlanks(const char *first, const char *last, char separator) {
+  while (first != last && (isBlank(*first) || *first == separator)) {
+    ++first;
+  }
+  return first;
+}
+
+} // namespace
+
+template <typename T>
+std::to_chars_result formatScalars(char *first, char *last, const T *scalars,
+                                   std::size_t count, char separator) {
+  for (std::size_t i = 0; i < count; ++i) {
+    if (i > 0) {
+      if (first == last) {
+        return {last, std::errc::value_too_large};
+      }
+      *first++ = separator;
+    }
+    const std::to_chars_result result = std::to_chars(first, last, scalars[i]);
+    if (result.ec != std::errc()) {
+      return {last, result.ec};
+    }
+    first = result.ptr;
+  }
+  return {first, std::errc()};
+}
+
+template <typename T>
+std::from_chars_result parseScalars(const char *first, const char *last,
+                                    T *scalars, std::size_t count,
+                                    char separator) {
+  for (std::size_t i = 0; i < count; ++i) {
+    first = skipBlanks(first, last, separator);
+    // std::from_chars does not take an explicit plus sign.
+    const char *digits =
+        first != last && *first == '+' && first + 1 != last && first[1] != '-'
+            ? first + 1
+            : first;
+    const std::from_chars_result result =
+        std::from_chars(digits, last, scalars[i]);
+    if (result.ec != std::errc()) {
+      return {first, result.ec};
+    }
+    first = result.ptr;
+  }
+  return {first, std::errc()};
+}
+
+template <typename Element>
+std::to_chars_result format(char *first, char *last, const Element &value,
+                            char separator) {
+  typedef ElementScalars<Element> Traits;
+  typename Traits::Scalar scalars[Traits::kCount];
+  toScalars(value, scalars);
+  return formatScalars(first, last, scalars, Traits::kCount, separator);
+}
+
+template <typename Element>
+std::from_chars_result parse(const char *first, const char *last,
+                             Element &value, char separator) {
+  typedef ElementScalars<Element> Traits;
+  typename Traits::Scalar scalars[Traits::kCount];
+  const std::from_chars_result result =
+      parseScalars(first, last, scalars, Traits::kCount, separator);
+  if (result.ec == std::errc()) {
+    fromScalars(scalars, value);
+  }
+  return result;
+}
+
+template <typename Element>
+FormatResult formatLines(char *first, char *last, const Element *values,
+                         std::size_t count, char separator) {
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::to_chars_result result =
+        format(first, last, values[i], separator);
+    if (result.ec != std::errc() || result.ptr == last) {
+      return {first, i, std::errc::value_too_large};
+    }
+    *result.ptr = '\n';
+    first = result.ptr + 1;
+  }
+  return {first, count, std::errc()};
+}
+
+template <typename Element>
+ParseResult parseLines(const char *first, const char *last, Element *values,
+                       std::size_t capacity, char separator) {
+  std::size_t count = 0;
+  while (count < capacity && first != last) {
+    const char *line = first;
+    first = skipBlanks(first, last, separator);
+    if (first == last) {
+      break;
+    }
+    if (*first == '\n' || *first == '#') {
+      while (first != last && *first++ != '\n') {
+      }
+      continue;
+    }
+    const std::from_chars_result result =
+        parse(first, last, values[count], separator);
+    if (result.ec != std::errc()) {
+      return {line, count, result.ec};
+    }
+    first = skipBlanks(result.ptr, last, separator);
+    if (first != last && *first != '\n') {
+      return {line, count, std::errc::invalid_argument};
+    }
+    if (first != last) {
+      ++first;
+    }
+    ++count;
+  }
+  return {first, count, std::errc()};
+}
+
+#define CPPCOURSE_INSTANTIATE_SCALARS(T)                                       \
+  template std::to_chars_result formatScalars(char *, char *, const T *,       \
+                                              std::size_t, char);              \
+  template std::from_chars_result parseScalars(const char *, const char *,     \
+                                               T *, std::size_t, char)
+CPPCOURSE_INSTANTIATE_SCALARS(float);
+CPPCOURSE_INSTANTIATE_SCALARS(double);
+#undef CPPCOURSE_INSTANTIATE_SCALARS
+
+#define CPPCOURSE_INSTANTIATE_TEXT(Element)                                    \
+  template std::to_chars_result format(char *, char *, const Element &, char); \
+  template std::from_chars_result parse(const char *, const char *,            \
+                                        Element &, char);                      \
+  template FormatResult formatLines(char *, char *, const Element *,           \
+                                    std::size_t, char);                        \
+  template ParseResult parseLines(const char *, const char *, Element *,       \
+                                  std::size_t, char)
+CPPCOURSE_INSTANTIATE_TEXT(Vector3f);
+CPPCOURSE_INSTANTIATE_TEXT(Vector3);
+CPPCOURSE_INSTANTIATE_TEXT(Matrix3f);
+CPPCOURSE_INSTANTIATE_TEXT(Matrix3);
+CPPCOURSE_INSTANTIATE_TEXT(Isometryf);
+CPPCOURSE_INSTANTIATE_TEXT(Isometry);
+#undef CPPCOURSE_INSTANTIATE_TEXT
+
+} // namespace text
+} // namespace cppcourse
@@ -0,0 +1,177 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace cppcourse {
+
+namespace {
+
+// Pool and deque of the worker running on this thread, if any.
+thread_local const ThreadPool *current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+
+} // namespace
+
+struct ThreadPool::Job {
+  const std::function<void(std::size_t, std::size_t)> *fn;
+  std::atomic<std::size_t> remaining;
+  std::mutex mutex;
+  std::condition_variable done;
+  std::exception_ptr error;
+};
+
+ThreadPool::ThreadPool(std::size_t threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  queue_count_ = threads - 1;
+  queues_.reset(new Queue[queue_count_]);
+  workers_.reserve(queue_count_);
+  for (std::size_t i = 0; i < queue_count_; ++i) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::parallelFor(
+    std::size_t count, std::size_t grain,
+    const std::function<void(std::size_t, std::size_t)> &fn) {
+  grain = std::max<std::size_t>(grain, 1);
+  const std::size_t chunks = (count + grain - 1) / grain;
+  if (queue_count_ == 0 || chunks <= 1) {
+    // Same contract as the queued path: every chunk runs, then the first
+    // exception is rethrown.
+    std::exception_ptr error;
+    for (std::size_t begin = 0; begin < count; begin += grain) {
+      try {
+        fn(begin, std::min(begin + grain, count));
+      } catch (...) {
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return;
+  }
+
+  Job job;
+  job.fn = &fn;
+  job.remaining.store(chunks);
+  // A worker keeps nested work in its own deque for the others to steal;
+  // an outside caller deals contiguous blocks of chunks to every deque.
+  const bool is_worker = current_pool == this;
+  const std::size_t queues = queue_count_;
+  // Counted before the tasks become visible: tryPop() decrements as soon
+  // as it takes one, which must not wrap the counter below zero.
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    queued_ += chunks;
+  }
+  for (std::size_t q = 0; q < queues; ++q) {
+    if (is_worker && q != current_queue) {
+      continue;
+    }
+    const std::size_t first = is_worker ? 0 : q * chunks / queues;
+    const std::size_t last = is_worker ? chunks : (q + 1) * chunks / queues;
+    std::lock_guard<std::mutex> lock(queues_[q].mutex);
+    // Pushed backwards so the owner, popping from the back, goes forwards.
+    for (std::size_t chunk = last; chunk-- > first;) {
+      const std::size_t begin = chunk * grain;
+      queues_[q].tasks.push_back(
+          Task{&job, begin, std::min(begin + grain, count)});
+    }
+  }
+  wake_.notify_all();
+
+  Task task;
+  while (job.remaining.load() != 0 &&
+         tryPop(is_worker ? current_queue : 0, task)) {
+    run(task);
+  }
+  std::unique_lock<std::mutex> lock(job.mutex);
+  job.done.wait(lock, [&]() { return job.remaining.load() == 0; });
+  if (job.error) {
+    std::rethrow_exception(job.error);
+  }
+}
+
+ThreadPool &ThreadPool::global() {
+  static ThreadPool pool;
+  return pool;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+  current_pool = this;
+  current_queue = index;
+  for (;;) {
+    Task task;
+    if (tryPop(index, task)) {
+      run(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [&]() { return stop_ || queued_.load() != 0; });
+    if (stop_) {
+      return;
+    }
+  }
+}
+
+bool ThreadPool::tryPop(std::size_t first_queue, Task &task) {
+  const std::size_t queues = queue_count_;
+  for (std::size_t k = 0; k < queues; ++k) {
+    Queue &queue = queues_[(first_queue + k) % queues];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.front == queue.tasks.size()) {
+      continue;
+    }
+    if (k == 0) {
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+    } else {
+      task = queue.tasks[queue.front++];
+    }
+    if (queue.front == queue.tasks.size()) {
+      queue.tasks.clear();
+      queue.front = 0;
+    }
+    --queued_;
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::run(const Task &task) {
+  std::exception_ptr error;
+  try {
+    (*task.job->fn)(task.begin, task.end);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // The caller of parallelFor() destroys the job once it can take this lock
+  // and see no remaining chunks, so nothing touches the job after unlocking.
+  Job &job = *task.job;
+  std::lock_guard<std::mutex> lock(job.mutex);
+  if (error && !job.error) {
+    job.error = error;
+  }
+  if (job.remaining.fetch_sub(1) == 1) {
+    job.done.notify_all();
+  }
+}
+
+} // namespace cppcourse
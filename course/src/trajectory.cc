@@ -0,0 +1,138 @@
+#include "trajectory.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace cppcourse {
+
+namespace {
+
+// Below this many increments the pooled scans run serially.
+const std::size_t kSerialCutoff{1 << 14};
+// Blocks per thread, so that stealing can even out slow blocks.
+const std::size_t kBlocksPerThread{4};
+
+// True when the running pose after increment `index` is re-orthonormalized.
+inline bool reorthonormalizeAfter(std::size_t index, std::size_t every) {
+  return every != 0 && (index + 1) % every == 0;
+}
+
+// Composes increments [begin, end) onto `running`, writing the inclusive or
+// exclusive prefixes to `poses` when it is not null. Returns the pose after
+// the last increment.
+template <typename T>
+IsometryT<T> scanRange(const IsometryT<T> *increments, IsometryT<T> *poses,
+                       std::size_t begin, std::size_t end,
+                       IsometryT<T> running, std::size_t every,
+                       bool inclusive) {
+  for (std::size_t i = begin; i < end; ++i) {
+    // Read before writing, `poses` may alias `increments`.
+    const IsometryT<T> increment = increments[i];
+    if (poses != nullptr && !inclusive) {
+      poses[i] = running;
+    }
+    running = running * increment;
+    if (reorthonormalizeAfter(i, every)) {
+      running = running.orthonormalized();
+    }
+    if (poses != nullptr && inclusive) {
+      poses[i] = running;
+    }
+  }
+  return running;
+}
+
+template <typename T>
+IsometryT<T> blockedScan(const IsometryT<T> *increments, IsometryT<T> *poses,
+                         std::size_t count, ThreadPool &pool,
+                         const IsometryT<T> &origin, std::size_t every,
+                         bool inclusive) {
+  if (count < kSerialCutoff || pool.threads() == 1) {
+    return scanRange(increments, poses, 0, count, origin, every, inclusive);
+  }
+  const std::size_t blocks = pool.threads() * kBlocksPerThread;
+  const std::size_t block_size = (count + blocks - 1) / blocks;
+  // offsets[b] is the pose before block b, offsets[blocks] the final one.
+  std::vector<IsometryT<T>> offsets(blocks + 1);
+  pool.parallelFor(blocks, 1, [&](std::size_t first, std::size_t last) {
+    for (std::size_t b = first; b < last; ++b) {
+      const std::size_t begin = std::min(b * block_size, count);
+      const std::size_t end = std::min(begin + block_size, count);
+      offsets[b + 1] = scanRange<T>(increments, nullptr, begin, end,
+                                    IsometryT<T>(), every, inclusive);
+    }
+  });
+  offsets[0] = origin;
+  for (std::size_t b = 0; b < blocks; ++b) {
+    offsets[b + 1] = offsets[b] * offsets[b + 1];
+    if (every != 0) {
+      offsets[b + 1] = offsets[b + 1].orthonormalized();
+    }
+  }
+  pool.parallelFor(blocks, 1, [&](std::size_t first, std::size_t last) {
+    for (std::size_t b = first; b < last; ++b) {
+      const std::size_t begin = std::min(b * block_size, count);
+      const std::size_t end = std::min(begin + block_size, count);
+      scanRange(increments, poses, begin, end, offsets[b], every, inclusive);
+    }
+  });
+  return offsets[blocks];
+}
+
+} // namespace
+
+namespace trajectory {
+
+template <typename T>
+void inclusiveScan(const IsometryT<T> *increments, IsometryT<T> *poses,
+                   std::size_t count, const IsometryT<T> &origin,
+                   std::size_t reorthonormalize_every) {
+  scanRange(increments, poses, 0, count, origin, reorthonormalize_every, true);
+}
+
+template <typename T>
+void inclusiveScan(const IsometryT<T> *increments, IsometryT<T> *poses,
+                   std::size_t count, ThreadPool &pool,
+                   const IsometryT<T> &origin,
+                   std::size_t reorthonormalize_every) {
+  blockedScan(increments, poses, count, pool, origin, reorthonormalize_every,
+              true);
+}
+
+template <typename T>
+IsometryT<T> exclusiveScan(const IsometryT<T> *increments, IsometryT<T> *poses,
+                           std::size_t count, const IsometryT<T> &origin,
+                           std::size_t reorthonormalize_every) {
+  return scanRange(increments, poses, 0, count, origin,
+                   reorthonormalize_every, false);
+}
+
+template <typename T>
+IsometryT<T> exclusiveScan(const IsometryT<T> *increments, IsometryT<T> *poses,
+                           std::size_t count, ThreadPool &pool,
+                           const IsometryT<T> &origin,
+                           std::size_t reorthonormalize_every) {
+  return blockedScan(increments, poses, count, pool, origin,
+                     reorthonormalize_every, false);
+}
+
+} // namespace trajectory
+
+#define CPPCOURSE_INSTANTIATE_TRAJECTORY(T)                                    \
+  template void trajectory::inclusiveScan(const IsometryT<T> *,                \
+                                          IsometryT<T> *, std::size_t,         \
+                                          const IsometryT<T> &, std::size_t);  \
+  template void trajectory::inclusiveScan(                                     \
+      const IsometryT<T> *, IsometryT<T> *, std::size_t, ThreadPool &,         \
+      const IsometryT<T> &, std::size_t);                                      \
+  template IsometryT<T> trajectory::exclusiveScan(                             \
+      const IsometryT<T> *, IsometryT<T> *, std::size_t, const IsometryT<T> &, \
+      std::size_t);                                                            \
+  template IsometryT<T> trajectory::exclusiveScan(                             \
+      const IsometryT<T> *, IsometryT<T> *, std::size_t, ThreadPool &,         \
+      const IsometryT<T> &, std::size_t)
+CPPCOURSE_INSTANTIATE_TRAJECTORY(float);
+CPPCOURSE_INSTANTIATE_TRAJECTORY(double);
+#undef CPPCOURSE_INSTANTIATE_TRAJECTORY
+
+} // namespace cppcourse
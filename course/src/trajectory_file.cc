@@ -0,0 +1,251 @@
+#include "trajectory_file.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include "quaternion.h"
+#include "text.h"
+
+namespace cppcourse {
+
+namespace {
+
+const std::size_t kReadBuffer{1 << 20};
+const std::size_t kWriteBuffer{1 << 20};
+
+const char *skipBlanks(const char *first, const char *last) {
+  while (first != last && (*first == ' ' || *first == '\t' || *first == '\r')) {
+    ++first;
+  }
+  return first;
+}
+
+} // namespace
+
+template <typename T>
+TrajectoryReader<T>::TrajectoryReader(const std::string &path,
+                                      TrajectoryFormat format,
+                                      std::size_t chunk_size)
+    : path_(path), in_(path, std::ios::binary), format_(format),
+      buffer_(kReadBuffer) {
+  if (!in_) {
+    throw std::runtime_error("Cannot open " + path);
+  }
+  if (chunk_size == 0) {
+    throw std::invalid_argument("Trajectory chunks need room for a pose.");
+  }
+  poses_.resize(chunk_size);
+  if (format_ == TrajectoryFormat::kTum) {
+    stamps_.resize(chunk_size);
+  }
+}
+
+template <typename T> bool TrajectoryReader<T>::next() {
+  size_ = 0;
+  while (size_ < poses_.size()) {
+    const char *first = buffer_.data() + begin_;
+    const char *last = recordsEnd();
+    if (first == last) {
+      if (eof_) {
+        break;
+      }
+      fill();
+      continue;
+    }
+    if (format_ == TrajectoryFormat::kKitti) {
+      const text::ParseResult result = text::parseLines(
+          first, last, poses_.data() + size_, poses_.size() - size_);
+      if (result.ec != std::errc()) {
+        throwMalformed(result.ptr);
+      }
+      size_ += result.count;
+      first = result.ptr;
+    } else {
+      first = parseTum(first, last);
+    }
+    begin_ = first - buffer_.data();
+  }
+  count_ += size_;
+  return size_ != 0;
+}
+
+template <typename T> std::size_t TrajectoryReader<T>::memoryBytes() const {
+  return buffer_.capacity() + poses_.capacity() * sizeof(IsometryT<T>) +
+         stamps_.capacity() * sizeof(double);
+}
+
+template <typename T> const char *TrajectoryReader<T>::recordsEnd() const {
+  const char *first = buffer_.data() + begin_;
+  const char *last = buffer_.data() + end_;
+  if (eof_) {
+    return last;
+  }
+  while (last != first && last[-1] != '\n') {
+    --last;
+  }
+  return last;
+}
+
+template <typename T> void TrajectoryReader<T>::fill() {
+  if (begin_ == 0 && end_ == buffer_.size()) {
+    buffer_.resize(2 * buffer_.size());
+  } else {
+    lines_ += std::count(buffer_.data(), buffer_.data() + begin_, '\n');
+    std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+    end_ -= begin_;
+    begin_ = 0;
+  }
+  in_.read(buffer_.data() + end_, buffer_.size() - end_);
+  end_ += in_.gcount();
+  if (in_.bad()) {
+    throw std::runtime_error("Failed to read " + path_);
+  }
+  eof_ = in_.eof();
+}
+
+template <typename T>
+const char *TrajectoryReader<T>::parseTum(const char *first,
+                                          const char *last) {
+  while (size_ < poses_.size() && first != last) {
+    const char *line = first;
+    first = skipBlanks(first, last);
+    if (first == last) {
+      break;
+    }
+    if (*first == '\n' || *first == '#') {
+      while (first != last && *first++ != '\n') {
+      }
+      continue;
+    }
+    // tx ty tz qx qy qz qw
+    T values[7];
+    std::from_chars_result result =
+        text::parseScalars(first, last, &stamps_[size_], 1);
+    if (result.ec == std::errc()) {
+      result = text::parseScalars(result.ptr, last, values, 7);
+    }
+    if (result.ec != std::errc()) {
+      throwMalformed(line);
+    }
+    first = skipBlanks(result.ptr, last);
+    if (first != last && *first != '\n') {
+      throwMalformed(line);
+    }
+    if (first != last) {
+      ++first;
+    }
+    const QuaternionT<T> rotation(values[6], values[3], values[4], values[5]);
+    // A zero or non-finite quaternion would normalize to NaN.
+    const T norm = rotation.norm();
+    if (!(norm > 0) || !std::isfinite(norm)) {
+      throwMalformed(line);
+    }
+    poses_[size_] =
+        IsometryT<T>(Vector3T<T>(values[0], values[1], values[2]),
+                     rotation.normalized().toRotation());
+    ++size_;
+  }
+  return first;
+}
+
+template <typename T>
+void TrajectoryReader<T>::throwMalformed(const char *where) const {
+  const std::size_t line =
+      lines_ + std::count(buffer_.data(), where, '\n') + 1;
+  throw std::invalid_argument(
+      path_ + ":" + std::to_string(line) + ": malformed " +
+      (format_ == TrajectoryFormat::kTum ? "TUM" : "KITTI") + " record.");
+}
+
+template <typename T>
+TrajectoryWriter<T>::TrajectoryWriter(const std::string &path,
+                                      TrajectoryFormat format)
+    : out_(path, std::ios::binary | std::ios::trunc), format_(format),
+      buffer_(kWriteBuffer) {
+  if (!out_) {
+    throw std::runtime_error("Cannot create " + path);
+  }
+}
+
+template <typename T> TrajectoryWriter<T>::~TrajectoryWriter() {
+  if (out_.is_open()) {
+    try {
+      close();
+    } catch (const std::exception &) {
+    }
+  }
+}
+
+template <typename T>
+void TrajectoryWriter<T>::write(const IsometryT<T> *poses, std::size_t count) {
+  if (format_ == TrajectoryFormat::kTum) {
+    throw std::invalid_argument("TUM records need timestamps.");
+  }
+  while (count > 0) {
+    const text::FormatResult result =
+        text::formatLines(buffer_.data() + used_,
+                          buffer_.data() + buffer_.size(), poses, count);
+    used_ = result.ptr - buffer_.data();
+    poses += result.count;
+    count -= result.count;
+    count_ += result.count;
+    if (count > 0) {
+      flush();
+    }
+  }
+}
+
+template <typename T>
+void TrajectoryWriter<T>::write(const double *stamps,
+                                const IsometryT<T> *poses, std::size_t count) {
+  if (format_ == TrajectoryFormat::kKitti) {
+    write(poses, count);
+    return;
+  }
+  // The stamp, seven scalars and their separators and the line break.
+  const std::size_t record_chars =
+      text::maxScalarChars<double>() + 7 * (text::maxScalarChars<T>() + 1) + 1;
+  for (std::size_t i = 0; i < count; ++i) {
+    if (buffer_.size() - used_ < record_chars) {
+      flush();
+    }
+    char *first = buffer_.data() + used_;
+    char *const last = buffer_.data() + buffer_.size();
+    first = std::to_chars(first, last, stamps[i]).ptr;
+    *first++ = ' ';
+    const Vector3T<T> &t = poses[i].translation();
+    const QuaternionT<T> q = QuaternionT<T>::FromRotation(poses[i].rotation());
+    const T values[7] = {t.x(), t.y(), t.z(), q.x(), q.y(), q.z(), q.w()};
+    first = text::formatScalars(first, last, values, 7).ptr;
+    *first++ = '\n';
+    used_ = first - buffer_.data();
+  }
+  count_ += count;
+}
+
+template <typename T> void TrajectoryWriter<T>::close() {
+  if (!out_.is_open()) {
+    return;
+  }
+  flush();
+  out_.close();
+  if (!out_) {
+    throw std::runtime_error("Failed to write trajectory file.");
+  }
+}
+
+template <typename T> void TrajectoryWriter<T>::flush() {
+  out_.write(buffer_.data(), used_);
+  used_ = 0;
+}
+
+template class TrajectoryReader<float>;
+template class TrajectoryReader<double>;
+template class TrajectoryWriter<float>;
+template class TrajectoryWriter<double>;
+
+} // namespace cppcourse
@@ -0,0 +1,88 @@
+#include "transform_buffer.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace cppcourse {
+
+TransformBuffer::TransformBuffer(std::size_t capacity) {
+  if (capacity < 2) {
+    throw std::invalid_argument("TransformBuffer needs room for 2 samples.");
+  }
+  samples_.resize(capacity);
+}
+
+void TransformBuffer::insert(double stamp, const Isometry &pose) {
+  if (size_ > 0 && stamp <= latestStamp()) {
+    throw std::invalid_argument("Stamp " + std::to_string(stamp) +
+                                " is not after the latest sample.");
+  }
+  std::size_t slot = head_ + size_;
+  if (size_ == samples_.size()) {
+    head_ = head_ + 1 == samples_.size() ? 0 : head_ + 1;
+  } else {
+    ++size_;
+  }
+  if (slot >= samples_.size()) {
+    slot -= samples_.size();
+  }
+  samples_[slot] = Sample{stamp, IsometryQ(pose)};
+}
+
+Isometry TransformBuffer::lookup(double stamp) const {
+  checkRange(stamp);
+  return interpolate(segment(stamp), stamp);
+}
+
+void TransformBuffer::lookup(const double *stamps, Isometry *poses,
+                             std::size_t count) const {
+  std::size_t index = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    checkRange(stamps[i]);
+    if (i == 0 || stamps[i] < stamps[i - 1]) {
+      index = segment(stamps[i]);
+    } else {
+      while (index + 2 < size_ && sample(index + 1).stamp <= stamps[i]) {
+        ++index;
+      }
+    }
+    poses[i] = interpolate(index, stamps[i]);
+  }
+}
+
+std::size_t TransformBuffer::segment(double stamp) const {
+  if (size_ < 2 || stamp >= sample(size_ - 2).stamp) {
+    return size_ < 2 ? 0 : size_ - 2;
+  }
+  // sample(low).stamp <= stamp < sample(high).stamp.
+  std::size_t low = 0;
+  std::size_t high = size_ - 2;
+  while (high - low > 1) {
+    const std::size_t middle = low + (high - low) / 2;
+    if (sample(middle).stamp <= stamp) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+Isometry TransformBuffer::interpolate(std::size_t index, double stamp) const {
+  const Sample &before = sample(index);
+  if (index + 1 >= size_) {
+    return before.pose.toIsometry();
+  }
+  const Sample &after = sample(index + 1);
+  const double t = (stamp - before.stamp) / (after.stamp - before.stamp);
+  return before.pose.interpolate(after.pose, t).toIsometry();
+}
+
+void TransformBuffer::checkRange(double stamp) const {
+  if (size_ == 0 || stamp < oldestStamp() || stamp > latestStamp()) {
+    throw std::out_of_range("No samples around stamp " +
+                            std::to_string(stamp) + ".");
+  }
+}
+
+} // namespace cppcourse
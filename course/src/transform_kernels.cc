@@ -0,0 +1,347 @@
+#include "transform_kernels.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPPCOURSE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace cppcourse {
+namespace kernels {
+
+const char *const kBackendEnvVar = "CPPCOURSE_SIMD_BACKEND";
+
+namespace {
+
+template <typename T> struct Kernel {
+  typedef void (*Fn)(const AffineCoefficients<T> &, const T *, const T *,
+                     const T *, T *, T *, T *, std::size_t);
+};
+
+template <typename T>
+void transformScalar(const AffineCoefficients<T> &c, const T *x, const T *y,
+                     const T *z, T *ox, T *oy, T *oz, std::size_t n) {
+  const T r00 = c.m[0], r01 = c.m[1], r02 = c.m[2], tx = c.m[3];
+  const T r10 = c.m[4], r11 = c.m[5], r12 = c.m[6], ty = c.m[7];
+  const T r20 = c.m[8], r21 = c.m[9], r22 = c.m[10], tz = c.m[11];
+  for (std::size_t i = 0; i < n; ++i) {
+    const T px = x[i];
+    const T py = y[i];
+    const T pz = z[i];
+    ox[i] = r00 * px + r01 * py + r02 * pz + tx;
+    oy[i] = r10 * px + r11 * py + r12 * pz + ty;
+    oz[i] = r20 * px + r21 * py + r22 * pz + tz;
+  }
+}
+
+#ifdef CPPCOURSE_X86_KERNELS
+
+#define CPPCOURSE_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define CPPCOURSE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define CPPCOURSE_TARGET_AVX512 __attribute__((target("avx512f")))
+
+// Thin per-ISA wrappers so every kernel is written once for float and double.
+template <typename T> struct Sse42Ops;
+template <> struct Sse42Ops<double> {
+  typedef __m128d Reg;
+  static const std::size_t kLanes = 2;
+  CPPCOURSE_TARGET_SSE42 static Reg set1(double v) { return _mm_set1_pd(v); }
+  CPPCOURSE_TARGET_SSE42 static Reg load(const double *p) {
+    return _mm_loadu_pd(p);
+  }
+  CPPCOURSE_TARGET_SSE42 static void store(double *p, Reg v) {
+    _mm_storeu_pd(p, v);
+  }
+  CPPCOURSE_TARGET_SSE42 static Reg add(Reg a, Reg b) {
+    return _mm_add_pd(a, b);
+  }
+  CPPCOURSE_TARGET_SSE42 static Reg mul(Reg a, Reg b) {
+    return _mm_mul_pd(a, b);
+  }
+};
+template <> struct Sse42Ops<float> {
+  typedef __m128 Reg;
+  static const std::size_t kLanes = 4;
+  CPPCOURSE_TARGET_SSE42 static Reg set1(float v) { return _mm_set1_ps(v); }
+  CPPCOURSE_TARGET_SSE42 static Reg load(const float *p) {
+    return _mm_loadu_ps(p);
+  }
+  CPPCOURSE_TARGET_SSE42 static void store(float *p, Reg v) {
+    _mm_storeu_ps(p, v);
+  }
+  CPPCOURSE_TARGET_SSE42 static Reg add(Reg a, Reg b) {
+    return _mm_add_ps(a, b);
+  }
+  CPPCOURSE_TARGET_SSE42 static Reg mul(Reg a, Reg b) {
+    return _mm_mul_ps(a, b);
+  }
+};
+
+template <typename T> struct Avx2Ops;
+template <> struct Avx2Ops<double> {
+  typedef __m256d Reg;
+  static const std::size_t kLanes = 4;
+  CPPCOURSE_TARGET_AVX2 static Reg set1(double v) { return _mm256_set1_pd(v); }
+  CPPCOURSE_TARGET_AVX2 static Reg load(const double *p) {
+    return _mm256_loadu_pd(p);
+  }
+  CPPCOURSE_TARGET_AVX2 static void store(double *p, Reg v) {
+    _mm256_storeu_pd(p, v);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg fmadd(Reg a, Reg b, Reg c) {
+    return _mm256_fmadd_pd(a, b, c);
+  }
+};
+template <> struct Avx2Ops<float> {
+  typedef __m256 Reg;
+  static const std::size_t kLanes = 8;
+  CPPCOURSE_TARGET_AVX2 static Reg set1(float v) { return _mm256_set1_ps(v); }
+  CPPCOURSE_TARGET_AVX2 static Reg load(const float *p) {
+    return _mm256_loadu_ps(p);
+  }
+  CPPCOURSE_TARGET_AVX2 static void store(float *p, Reg v) {
+    _mm256_storeu_ps(p, v);
+  }
+  CPPCOURSE_TARGET_AVX2 static Reg fmadd(Reg a, Reg b, Reg c) {
+    return _mm256_fmadd_ps(a, b, c);
+  }
+};
+
+template <typename T> struct Avx512Ops;
+template <> struct Avx512Ops<double> {
+  typedef __m512d Reg;
+  typedef __mmask8 Mask;
+  static const std::size_t kLanes = 8;
+  CPPCOURSE_TARGET_AVX512 static Reg set1(double v) {
+    return _mm512_set1_pd(v);
+  }
+  CPPCOURSE_TARGET_AVX512 static Reg load(Mask m, const double *p) {
+    return _mm512_maskz_loadu_pd(m, p);
+  }
+  CPPCOURSE_TARGET_AVX512 static void store(double *p, Mask m, Reg v) {
+    _mm512_mask_storeu_pd(p, m, v);
+  }
+  CPPCOURSE_TARGET_AVX512 static Reg fmadd(Reg a, Reg b, Reg c) {
+    return _mm512_fmadd_pd(a, b, c);
+  }
+};
+template <> struct Avx512Ops<float> {
+  typedef __m512 Reg;
+  typedef __mmask16 Mask;
+  static const std::size_t kLanes = 16;
+  CPPCOURSE_TARGET_AVX512 static Reg set1(float v) { return _mm512_set1_ps(v); }
+  CPPCOURSE_TARGET_AVX512 static Reg load(Mask m, const float *p) {
+    return _mm512_maskz_loadu_ps(m, p);
+  }
+  CPPCOURSE_TARGET_AVX512 static void store(float *p, Mask m, Reg v) {
+    _mm512_mask_storeu_ps(p, m, v);
+  }
+  CPPCOURSE_TARGET_AVX512 static Reg fmadd(Reg a, Reg b, Reg c) {
+    return _mm512_fmadd_ps(a, b, c);
+  }
+};
+
+// Same operation order as the scalar kernel, hence bit-exact with it.
+template <typename T>
+CPPCOURSE_TARGET_SSE42 void
+transformSse42(const AffineCoefficients<T> &c, const T *x, const T *y,
+               const T *z, T *ox, T *oy, T *oz, std::size_t n) {
+  typedef Sse42Ops<T> Ops;
+  typename Ops::Reg m[12];
+  for (int k = 0; k < 12; ++k) {
+    m[k] = Ops::set1(c.m[k]);
+  }
+  T *out[3] = {ox, oy, oz};
+  std::size_t i = 0;
+  for (; i + Ops::kLanes <= n; i += Ops::kLanes) {
+    const typename Ops::Reg px = Ops::load(x + i);
+    const typename Ops::Reg py = Ops::load(y + i);
+    const typename Ops::Reg pz = Ops::load(z + i);
+    for (int r = 0; r < 3; ++r) {
+      const typename Ops::Reg *row = m + 4 * r;
+      Ops::store(out[r] + i,
+                 Ops::add(Ops::add(Ops::add(Ops::mul(row[0], px),
+                                            Ops::mul(row[1], py)),
+                                   Ops::mul(row[2], pz)),
+                          row[3]));
+    }
+  }
+  transformScalar(c, x + i, y + i, z + i, ox + i, oy + i, oz + i, n - i);
+}
+
+template <typename T>
+CPPCOURSE_TARGET_AVX2 void
+transformAvx2(const AffineCoefficients<T> &c, const T *x, const T *y,
+              const T *z, T *ox, T *oy, T *oz, std::size_t n) {
+  typedef Avx2Ops<T> Ops;
+  typename Ops::Reg m[12];
+  for (int k = 0; k < 12; ++k) {
+    m[k] = Ops::set1(c.m[k]);
+  }
+  T *out[3] = {ox, oy, oz};
+  std::size_t i = 0;
+  for (; i + Ops::kLanes <= n; i += Ops::kLanes) {
+    const typename Ops::Reg px = Ops::load(x + i);
+    const typename Ops::Reg py = Ops::load(y + i);
+    const typename Ops::Reg pz = Ops::load(z + i);
+    for (int r = 0; r < 3; ++r) {
+      const typename Ops::Reg *row = m + 4 * r;
+      Ops::store(out[r] + i,
+                 Ops::fmadd(row[2], pz,
+                            Ops::fmadd(row[1], py,
+                                       Ops::fmadd(row[0], px, row[3]))));
+    }
+  }
+  transformScalar(c, x + i, y + i, z + i, ox + i, oy + i, oz + i, n - i);
+}
+
+// The tail is handled with masked loads and stores, so every point goes
+// through the same fused arithmetic.
+template <typename T>
+CPPCOURSE_TARGET_AVX512 void
+transformAvx512(const AffineCoefficients<T> &c, const T *x, const T *y,
+                const T *z, T *ox, T *oy, T *oz, std::size_t n) {
+  typedef Avx512Ops<T> Ops;
+  typename Ops::Reg m[12];
+  for (int k = 0; k < 12; ++k) {
+    m[k] = Ops::set1(c.m[k]);
+  }
+  T *out[3] = {ox, oy, oz};
+  for (std::size_t i = 0; i < n; i += Ops::kLanes) {
+    const std::size_t remaining = n - i;
+    const typename Ops::Mask mask =
+        remaining >= Ops::kLanes
+            ? typename Ops::Mask(~0u)
+            : typename Ops::Mask((1u << remaining) - 1u);
+    const typename Ops::Reg px = Ops::load(mask, x + i);
+    const typename Ops::Reg py = Ops::load(mask, y + i);
+    const typename Ops::Reg pz = Ops::load(mask, z + i);
+    for (int r = 0; r < 3; ++r) {
+      const typename Ops::Reg *row = m + 4 * r;
+      Ops::store(out[r] + i, mask,
+                 Ops::fmadd(row[2], pz,
+                            Ops::fmadd(row[1], py,
+                                       Ops::fmadd(row[0], px, row[3]))));
+    }
+  }
+}
+
+#endif // CPPCOURSE_X86_KERNELS
+
+template <typename T> typename Kernel<T>::Fn kernelFor(Backend backend) {
+  switch (backend) {
+#ifdef CPPCOURSE_X86_KERNELS
+  case Backend::kSse42:
+    return transformSse42<T>;
+  case Backend::kAvx2:
+    return transformAvx2<T>;
+  case Backend::kAvx512:
+    return transformAvx512<T>;
+#endif
+  default:
+    return transformScalar<T>;
+  }
+}
+
+Backend selectBackend() {
+  Backend backend = bestBackend();
+  Backend pinned;
+  const char *name = std::getenv(kBackendEnvVar);
+  if (name != nullptr && parseBackend(name, &pinned) && isSupported(pinned)) {
+    backend = pinned;
+  }
+  return backend;
+}
+
+} // namespace
+
+const char *backendName(Backend backend) {
+  switch (backend) {
+  case Backend::kSse42:
+    return "sse4.2";
+  case Backend::kAvx2:
+    return "avx2";
+  case Backend::kAvx512:
+    return "avx512";
+  default:
+    return "scalar";
+  }
+}
+
+bool parseBackend(const char *name, Backend *backend) {
+  const Backend kAll[] = {Backend::kScalar, Backend::kSse42, Backend::kAvx2,
+                          Backend::kAvx512};
+  for (const Backend candidate : kAll) {
+    if (std::strcmp(name, backendName(candidate)) == 0) {
+      *backend = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isSupported(Backend backend) {
+#ifdef CPPCOURSE_X86_KERNELS
+  __builtin_cpu_init();
+  switch (backend) {
+  case Backend::kScalar:
+    return true;
+  case Backend::kSse42:
+    return __builtin_cpu_supports("sse4.2");
+  case Backend::kAvx2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case Backend::kAvx512:
+    return __builtin_cpu_supports("avx512f");
+  }
+  return false;
+#else
+  return backend == Backend::kScalar;
+#endif
+}
+
+Backend bestBackend() {
+  const Backend kByPreference[] = {Backend::kAvx512, Backend::kAvx2,
+                                   Backend::kSse42};
+  for (const Backend candidate : kByPreference) {
+    if (isSupported(candidate)) {
+      return candidate;
+    }
+  }
+  return Backend::kScalar;
+}
+
+Backend activeBackend() {
+  static const Backend backend = selectBackend();
+  return backend;
+}
+
+void transformPoints(const AffineCoefficients<double> &c, const double *x,
+                     const double *y, const double *z, double *ox, double *oy,
+                     double *oz, std::size_t n) {
+  static const Kernel<double>::Fn kernel = kernelFor<double>(activeBackend());
+  kernel(c, x, y, z, ox, oy, oz, n);
+}
+
+void transformPoints(const AffineCoefficients<float> &c, const float *x,
+                     const float *y, const float *z, float *ox, float *oy,
+                     float *oz, std::size_t n) {
+  static const Kernel<float>::Fn kernel = kernelFor<float>(activeBackend());
+  kernel(c, x, y, z, ox, oy, oz, n);
+}
+
+void transformPoints(Backend backend, const AffineCoefficients<double> &c,
+                     const double *x, const double *y, const double *z,
+                     double *ox, double *oy, double *oz, std::size_t n) {
+  kernelFor<double>(backend)(c, x, y, z, ox, oy, oz, n);
+}
+
+void transformPoints(Backend backend, const AffineCoefficients<float> &c,
+                     const float *x, const float *y, const float *z, float *ox,
+                     float *oy, float *oz, std::size_t n) {
+  kernelFor<float>(backend)(c, x, y, z, ox, oy, oz, n);
+}
+
+} // namespace kernels
+} // namespace cppcourse
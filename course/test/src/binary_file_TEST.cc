@@ -0,0 +1,156 @@
+#include "binary_file.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+std::string tempPath(const std::string &name) {
+  return testing::internal::TempDir() + "binary_file_TEST_" + name;
+}
+
+GTEST_TEST(BinaryFileTest, RoundTrip) {
+  std::vector<Isometry> poses;
+  for (int i = 0; i < 1000; ++i) {
+    poses.push_back(Isometry::FromTranslation({1. * i, -2., 0.5}) *
+                    Isometry::FromEulerAngles(0.01 * i, 0.2, -0.3));
+  }
+  const std::string path = tempPath("poses");
+  binary::writeArray(path, poses);
+
+  binary::MappedArrayFile file(path);
+  EXPECT_EQ(file.version(), binary::kFormatVersion);
+  EXPECT_EQ(file.elementType(), binary::ElementType::kIsometryd);
+  ASSERT_EQ(file.size(), poses.size());
+  const Span<const Isometry> view = file.view<Isometry>();
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(view.data()) %
+                binary::kDataAlignment,
+            0u);
+  for (std::size_t i = 0; i < poses.size(); ++i) {
+    ASSERT_EQ(view[i], poses[i]);
+  }
+  EXPECT_THROW(file.view<Isometryf>(), std::invalid_argument);
+  EXPECT_THROW(file.view<Vector3>(), std::invalid_argument);
+
+  // Moving keeps the mapping alive.
+  binary::MappedArrayFile moved(std::move(file));
+  EXPECT_EQ(moved.view<Isometry>()[999], poses[999]);
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(BinaryFileTest, EveryElementType) {
+  const std::string path = tempPath("elements");
+  const std::vector<Vector3f> points{Vector3f(1.f, 2.f, 3.f),
+                                     Vector3f(-4.f, 5.f, 6.f)};
+  binary::writeArray(path, points);
+  {
+    binary::MappedArrayFile file(path);
+    const Span<const Vector3f> view = file.view<Vector3f>();
+    EXPECT_EQ(std::vector<Vector3f>(view.begin(), view.end()), points);
+  }
+
+  const std::vector<Matrix3> matrices{Matrix3::kIdentity, Matrix3::kOnes};
+  binary::writeArray(path, matrices);
+  {
+    binary::MappedArrayFile file(path);
+    EXPECT_EQ(file.view<Matrix3>()[1], Matrix3::kOnes);
+  }
+
+  binary::writeArray<Isometryf>(path, nullptr, 0);
+  {
+    binary::MappedArrayFile file(path);
+    EXPECT_TRUE(file.view<Isometryf>().empty());
+  }
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(BinaryFileTest, LittleEndianHeader) {
+  std::ostringstream out;
+  const Vector3 point(1., 2., 3.);
+  binary::writeArray(out, &point, 1);
+  const std::string bytes = out.str();
+  ASSERT_EQ(bytes.size(), binary::kHeaderSize + sizeof(Vector3));
+  EXPECT_EQ(bytes.substr(0, 8), std::string("CPPCARR\0", 8));
+  EXPECT_EQ(bytes[8], 1);   // Version.
+  EXPECT_EQ(bytes[12], 2);  // kVector3d.
+  EXPECT_EQ(bytes[16], 8);  // Scalar size.
+  EXPECT_EQ(bytes[20], 24); // Element size.
+  EXPECT_EQ(bytes[24], 1);  // Count.
+  EXPECT_EQ(bytes[32], 64); // Data offset.
+}
+
+GTEST_TEST(BinaryFileTest, RejectsBadFiles) {
+  EXPECT_THROW(binary::MappedArrayFile(tempPath("missing")),
+               std::runtime_error);
+
+  const std::string path = tempPath("bad");
+  const auto writeBytes = [&](const std::string &bytes) {
+    std::ofstream(path, std::ios::binary) << bytes;
+  };
+  writeBytes("too short");
+  EXPECT_THROW(binary::MappedArrayFile{path}, std::invalid_argument);
+
+  std::ostringstream out;
+  const std::vector<Vector3> points(10);
+  binary::writeArray(out, points.data(), points.size());
+  const std::string valid = out.str();
+
+  std::string corrupt = valid;
+  corrupt[0] = 'X';
+  writeBytes(corrupt);
+  EXPECT_THROW(binary::MappedArrayFile{path}, std::invalid_argument);
+
+  corrupt = valid;
+  corrupt[8] = 2; // A future version.
+  writeBytes(corrupt);
+  EXPECT_THROW(binary::MappedArrayFile{path}, std::invalid_argument);
+
+  corrupt = valid;
+  corrupt[12] = 42; // Unknown element type.
+  writeBytes(corrupt);
+  EXPECT_THROW(binary::MappedArrayFile{path}, std::invalid_argument);
+
+  corrupt = valid;
+  corrupt[16] = 4; // Float scalars in a double vector.
+  writeBytes(corrupt);
+  EXPECT_THROW(binary::MappedArrayFile{path}, std::invalid_argument);
+
+  writeBytes(valid.substr(0, valid.size() - 1)); // Truncated.
+  EXPECT_THROW(binary::MappedArrayFile{path}, std::invalid_argument);
+
+  writeBytes(valid);
+  EXPECT_EQ(binary::MappedArrayFile{path}.size(), 10u);
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(SpanTest, Accessors) {
+  int values[] = {1, 2, 3, 4};
+  const Span<int> span(values, 4);
+  EXPECT_EQ(span.size(), 4u);
+  EXPECT_EQ(span[2], 3);
+  EXPECT_THROW(span.at(4), std::out_of_range);
+  const Span<int> middle = span.subspan(1, 2);
+  EXPECT_EQ(middle.size(), 2u);
+  EXPECT_EQ(middle[0], 2);
+  EXPECT_THROW(span.subspan(3, 2), std::out_of_range);
+  EXPECT_TRUE(Span<int>().empty());
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
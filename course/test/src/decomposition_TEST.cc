@@ -0,0 +1,263 @@
+#include "decomposition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+// Elements uniform in [-scale, scale], symmetric if asked.
+template <typename T>
+std::vector<Matrix3T<T>> randomMatrices(std::size_t count, bool symmetric,
+                                        double scale = 1.) {
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<double> element(-scale, scale);
+  std::vector<Matrix3T<T>> matrices;
+  for (std::size_t i = 0; i < count; ++i) {
+    Matrix3T<T> m;
+    for (int r = 0; r < 3; ++r) {
+      for (int c = symmetric ? r : 0; c < 3; ++c) {
+        m[r][c] = static_cast<T>(element(generator));
+        if (symmetric) {
+          m[c][r] = m[r][c];
+        }
+      }
+    }
+    matrices.push_back(m);
+  }
+  return matrices;
+}
+
+template <typename T> T largestElement(const Matrix3T<T> &m) {
+  T largest = 0;
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) {
+      largest = std::max(largest, std::abs(m(r, c)));
+    }
+  }
+  return largest;
+}
+
+template <typename T>
+testing::AssertionResult isRotation(const Matrix3T<T> &m, T tolerance) {
+  if (!m.isOrthonormal(tolerance) || std::abs(m.det() - 1) > tolerance) {
+    return testing::AssertionFailure() << m << " is not a rotation";
+  }
+  return testing::AssertionSuccess();
+}
+
+// Largest |m v - lambda v| over the eigenpairs, relative to m's elements.
+template <typename T>
+testing::AssertionResult isEigendecomposition(const Matrix3T<T> &m,
+                                              const SymmetricEigenT<T> &eigen,
+                                              T tolerance) {
+  if (!isRotation(eigen.vectors, tolerance)) {
+    return testing::AssertionFailure() << "vectors " << eigen.vectors;
+  }
+  if (eigen.values[0] > eigen.values[1] ||
+      eigen.values[1] > eigen.values[2]) {
+    return testing::AssertionFailure() << "unsorted " << eigen.values;
+  }
+  const T scale = std::max(largestElement(m), std::numeric_limits<T>::min());
+  for (int k = 0; k < 3; ++k) {
+    const Vector3T<T> v = eigen.vectors.col(k);
+    const Vector3T<T> residual = m.product(v) - v * eigen.values[k];
+    for (int i = 0; i < 3; ++i) {
+      if (std::abs(residual[i]) > tolerance * scale) {
+        return testing::AssertionFailure()
+               << "residual " << residual << " of eigenvalue "
+               << eigen.values[k] << " of " << m;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+template <typename T>
+testing::AssertionResult isSvd(const Matrix3T<T> &m, const SvdT<T> &svd,
+                               T tolerance) {
+  if (!isRotation(svd.u, tolerance) || !isRotation(svd.v, tolerance)) {
+    return testing::AssertionFailure() << "u " << svd.u << " v " << svd.v;
+  }
+  const Vector3T<T> &s = svd.singular_values;
+  const T scale = std::max(largestElement(m), std::numeric_limits<T>::min());
+  const T slack = tolerance * scale;
+  if (s[0] < 0 || s[1] < 0 || s[0] < s[1] - slack ||
+      s[1] < std::abs(s[2]) - slack || (s[2] < -slack && m.det() > 0)) {
+    return testing::AssertionFailure() << "singular values " << s;
+  }
+  Matrix3T<T> sigma;
+  for (int k = 0; k < 3; ++k) {
+    sigma[k][k] = s[k];
+  }
+  const Matrix3T<T> product =
+      svd.u.product(sigma).product(svd.v.transpose());
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) {
+      if (std::abs(product(r, c) - m(r, c)) > tolerance * scale) {
+        return testing::AssertionFailure()
+               << "u s v^T " << product << " of " << m;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+// A few epsilon for kAccurate, far looser for kFast.
+template <typename T> T toleranceOf(DecompositionAccuracy accuracy) {
+  return accuracy == DecompositionAccuracy::kFast
+             ? T(1e-4)
+             : 32 * std::numeric_limits<T>::epsilon();
+}
+
+template <typename T> void checkRandomSymmetric() {
+  for (const DecompositionAccuracy accuracy :
+       {DecompositionAccuracy::kFast, DecompositionAccuracy::kAccurate}) {
+    for (const Matrix3T<T> &m : randomMatrices<T>(20000, true)) {
+      ASSERT_TRUE(isEigendecomposition(m, symmetricEigen(m, accuracy),
+                                       toleranceOf<T>(accuracy)));
+    }
+  }
+}
+
+GTEST_TEST(DecompositionTest, SymmetricEigenOfRandomMatrices) {
+  checkRandomSymmetric<double>();
+  checkRandomSymmetric<float>();
+}
+
+GTEST_TEST(DecompositionTest, SymmetricEigenOfSpecialMatrices) {
+  const double tolerance = 32 * std::numeric_limits<double>::epsilon();
+  const Matrix3 rotation = Isometry::FromEulerAngles(0.3, -1.1, 2.).rotation();
+  const Matrix3 repeated =
+      rotation.product(Matrix3{2., 0., 0., 0., 5., 0., 0., 0., 2.})
+          .product(rotation.transpose());
+  // Covariance of points on a tilted plane: the normal has eigenvalue 0.
+  const Matrix3 planar = rotation.product(Matrix3{4., 0., 0., 0., 1., 0., 0.,
+                                                  0., 0.})
+                             .product(rotation.transpose());
+  for (const Matrix3 &m :
+       {Matrix3::kZero, Matrix3::kIdentity, Matrix3::kOnes, repeated, planar,
+        Matrix3{1e-200, 0., 0., 0., -3e-200, 1e-201, 0., 1e-201, 0.},
+        Matrix3{1e150, 2e150, 0., 2e150, -1e150, 3e149, 0., 3e149, 5e149}}) {
+    const SymmetricEigen eigen = symmetricEigen(m);
+    EXPECT_TRUE(isEigendecomposition(m, eigen, tolerance));
+  }
+  const SymmetricEigen twice = symmetricEigen(repeated);
+  EXPECT_NEAR(twice.values[0], 2., tolerance);
+  EXPECT_NEAR(twice.values[1], 2., tolerance);
+  EXPECT_NEAR(twice.values[2], 5., tolerance);
+  const SymmetricEigen flat = symmetricEigen(planar);
+  EXPECT_NEAR(flat.values[0], 0., 4 * tolerance);
+  const Vector3 normal = flat.vectors.col(0);
+  EXPECT_NEAR(std::abs(normal.dot(rotation.col(2))), 1., tolerance);
+
+  // Only the upper triangle is read.
+  Matrix3 upper = planar;
+  upper[1][0] = upper[2][0] = upper[2][1] = 42.;
+  EXPECT_EQ(symmetricEigen(upper).values, flat.values);
+}
+
+template <typename T> void checkRandomSvd() {
+  for (const DecompositionAccuracy accuracy :
+       {DecompositionAccuracy::kFast, DecompositionAccuracy::kAccurate}) {
+    for (const Matrix3T<T> &m : randomMatrices<T>(20000, false)) {
+      ASSERT_TRUE(isSvd(m, svd(m, accuracy), toleranceOf<T>(accuracy)));
+    }
+  }
+}
+
+GTEST_TEST(DecompositionTest, SvdOfRandomMatrices) {
+  checkRandomSvd<double>();
+  checkRandomSvd<float>();
+}
+
+GTEST_TEST(DecompositionTest, SvdOfSpecialMatrices) {
+  const double tolerance = 32 * std::numeric_limits<double>::epsilon();
+  const Matrix3 rotation = Isometry::FromEulerAngles(0.3, -1.1, 2.).rotation();
+  const Matrix3 reflection{1., 0., 0., 0., 1., 0., 0., 0., -1.};
+  for (const Matrix3 &m :
+       {Matrix3::kZero, Matrix3::kIdentity, Matrix3::kOnes, rotation,
+        Matrix3(rotation.product(reflection)),
+        // Ranks 1 and 2.
+        Matrix3{1., 2., 3., 2., 4., 6., -1., -2., -3.},
+        Matrix3{1., 2., 3., 4., 5., 6., 7., 8., 9.},
+        Matrix3{1e-200, 2e-200, 0., 0., 1e-200, 0., 3e-200, 0., 1e-201},
+        Matrix3{1e150, 2e150, 0., 0., 1e150, 0., 3e150, 0., 1e149}}) {
+    EXPECT_TRUE(isSvd(m, svd(m), tolerance));
+  }
+  // u v^T is the nearest rotation, also to a reflection.
+  const Svd reflected = svd(Matrix3(rotation.product(reflection)));
+  EXPECT_NEAR(reflected.singular_values[2], -1., tolerance);
+  const Matrix3 nearest = reflected.u.product(reflected.v.transpose());
+  EXPECT_TRUE(isRotation(nearest, tolerance));
+
+  const Svd singular = svd(Matrix3{1., 2., 3., 4., 5., 6., 7., 8., 9.});
+  EXPECT_NEAR(singular.singular_values[2], 0., 16 * tolerance);
+}
+
+template <typename T> void checkBatches() {
+  // Not a multiple of any vector width, so the scalar tail runs too.
+  const std::size_t count = 1003;
+  const std::vector<Matrix3T<T>> symmetric =
+      randomMatrices<T>(count, true, 100.);
+  const std::vector<Matrix3T<T>> general =
+      randomMatrices<T>(count, false, 100.);
+  for (const DecompositionAccuracy accuracy :
+       {DecompositionAccuracy::kFast, DecompositionAccuracy::kAccurate}) {
+    PointCloud3T<T> values;
+    Matrix3ArrayT<T> vectors;
+    symmetricEigen(Matrix3ArrayT<T>(symmetric), values, vectors, accuracy);
+    ASSERT_EQ(values.size(), count);
+    ASSERT_EQ(vectors.size(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+      const SymmetricEigenT<T> eigen = symmetricEigen(symmetric[i], accuracy);
+      ASSERT_EQ(values[i], eigen.values) << i;
+      ASSERT_EQ(vectors[i], eigen.vectors) << i;
+    }
+
+    Matrix3ArrayT<T> u, v;
+    svd(Matrix3ArrayT<T>(general), u, values, v, accuracy);
+    ASSERT_EQ(u.size(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+      const SvdT<T> expected = svd(general[i], accuracy);
+      ASSERT_EQ(u[i], expected.u) << i;
+      ASSERT_EQ(values[i], expected.singular_values) << i;
+      ASSERT_EQ(v[i], expected.v) << i;
+    }
+  }
+}
+
+GTEST_TEST(DecompositionTest, BatchesMatchSingleMatrices) {
+  checkBatches<double>();
+  checkBatches<float>();
+}
+
+GTEST_TEST(DecompositionTest, Matrix3Array) {
+  const std::vector<Matrix3> matrices = randomMatrices<double>(5, false);
+  Matrix3Array array(matrices);
+  ASSERT_EQ(array.size(), 5u);
+  EXPECT_EQ(array[3], matrices[3]);
+  EXPECT_EQ(array.element(1, 2)[3], matrices[3](1, 2));
+  array.set(0, Matrix3::kOnes);
+  EXPECT_EQ(array[0], Matrix3::kOnes);
+  array.resize(2);
+  EXPECT_EQ(array.size(), 2u);
+  EXPECT_FALSE(array.empty());
+  EXPECT_TRUE(Matrix3Arrayf().empty());
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
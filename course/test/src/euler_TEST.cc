@@ -0,0 +1,161 @@
+#include "euler.h"
+#include "isometry.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+testing::AssertionResult areAlmostEqual(const Matrix3 &a, const Matrix3 &b,
+                                        const double &tolerance) {
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      if (std::abs(a[i][j] - b[i][j]) > tolerance) {
+        return testing::AssertionFailure() << a << " != " << b;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+const EulerConvention kConventions[] = {
+    EulerConvention::kXYZ, EulerConvention::kXZY, EulerConvention::kYXZ,
+    EulerConvention::kYZX, EulerConvention::kZXY, EulerConvention::kZYX,
+    EulerConvention::kXYX, EulerConvention::kXZX, EulerConvention::kYXY,
+    EulerConvention::kYZY, EulerConvention::kZXZ, EulerConvention::kZYZ};
+
+// Axis sequence of `convention`, spelled out as in its name.
+std::vector<Vector3> axesOf(const EulerConvention convention) {
+  const Vector3 x = Vector3::kUnitX, y = Vector3::kUnitY, z = Vector3::kUnitZ;
+  switch (convention) {
+  case EulerConvention::kXYZ: return {x, y, z};
+  case EulerConvention::kXZY: return {x, z, y};
+  case EulerConvention::kYXZ: return {y, x, z};
+  case EulerConvention::kYZX: return {y, z, x};
+  case EulerConvention::kZXY: return {z, x, y};
+  case EulerConvention::kZYX: return {z, y, x};
+  case EulerConvention::kXYX: return {x, y, x};
+  case EulerConvention::kXZX: return {x, z, x};
+  case EulerConvention::kYXY: return {y, x, y};
+  case EulerConvention::kYZY: return {y, z, y};
+  case EulerConvention::kZXZ: return {z, x, z};
+  case EulerConvention::kZYZ: return {z, y, z};
+  }
+  return {};
+}
+
+bool isProper(const EulerConvention convention) {
+  return static_cast<int>(convention) >= static_cast<int>(EulerConvention::kXYX);
+}
+
+Matrix3 chainedRotation(const Vector3 &angles,
+                        const EulerConvention convention) {
+  const std::vector<Vector3> axes = axesOf(convention);
+  return (Isometry::RotateAround(axes[0], angles[0]) *
+          Isometry::RotateAround(axes[1], angles[1]) *
+          Isometry::RotateAround(axes[2], angles[2]))
+      .rotation();
+}
+
+GTEST_TEST(EulerTest, MatchesChainedRotations) {
+  const double kTolerance{1e-12};
+  const Vector3 angles{0.3, -1.1, 2.5};
+  for (const EulerConvention convention : kConventions) {
+    EXPECT_TRUE(areAlmostEqual(euler::toRotation(angles, convention),
+                               chainedRotation(angles, convention),
+                               kTolerance))
+        << static_cast<int>(convention);
+  }
+  EXPECT_TRUE(areAlmostEqual(
+      Isometry::FromEulerAngles(M_PI / 2., M_PI / 4., M_PI / 8.).rotation(),
+      chainedRotation({M_PI / 2., M_PI / 4., M_PI / 8.}, EulerConvention::kXYZ),
+      kTolerance));
+}
+
+GTEST_TEST(EulerTest, RoundTrip) {
+  const double kTolerance{1e-12};
+  for (const EulerConvention convention : kConventions) {
+    // Second angles inside the principal range of the convention.
+    const double offset = isProper(convention) ? M_PI / 2. : 0.;
+    for (const double second : {-1.5, -0.7, 0., 0.4, 1.2}) {
+      const Vector3 angles{-2.9, second + offset, 1.3};
+      const Vector3 recovered = euler::fromRotation(
+          euler::toRotation(angles, convention), convention);
+      for (int i = 0; i < 3; ++i) {
+        EXPECT_NEAR(recovered[i], angles[i], 1e-9)
+            << static_cast<int>(convention) << " " << angles;
+      }
+    }
+    // Outside the principal range only the rotation is preserved.
+    const Vector3 angles{2., isProper(convention) ? -0.5 : 2.5, -1.};
+    const Matrix3 rotation = euler::toRotation(angles, convention);
+    EXPECT_TRUE(areAlmostEqual(
+        euler::toRotation(euler::fromRotation(rotation, convention),
+                          convention),
+        rotation, kTolerance))
+        << static_cast<int>(convention);
+  }
+}
+
+GTEST_TEST(EulerTest, GimbalLock) {
+  const double kTolerance{1e-12};
+  for (const EulerConvention convention : kConventions) {
+    const double lock = isProper(convention) ? 0. : M_PI / 2.;
+    for (const double second : {lock, -lock, lock + 1e-9}) {
+      const Vector3 angles{0.7, second, -0.2};
+      const Matrix3 rotation = euler::toRotation(angles, convention);
+      const Vector3 recovered = euler::fromRotation(rotation, convention);
+      EXPECT_TRUE(areAlmostEqual(euler::toRotation(recovered, convention),
+                                 rotation, kTolerance))
+          << static_cast<int>(convention) << " " << angles;
+    }
+  }
+  // At exact lock the first angle is zeroed and the third absorbs it.
+  const Vector3 recovered = euler::fromRotation(
+      euler::toRotation(Vector3(0.7, M_PI / 2., -0.2), EulerConvention::kXYZ),
+      EulerConvention::kXYZ);
+  EXPECT_NEAR(recovered.x(), 0., kTolerance);
+  EXPECT_NEAR(recovered.y(), M_PI / 2., 1e-7);
+  EXPECT_NEAR(recovered.z(), 0.5, 1e-7);
+}
+
+GTEST_TEST(EulerTest, Batches) {
+  std::vector<Vector3> angles;
+  for (int i = 0; i < 17; ++i) {
+    angles.push_back(Vector3(std::sin(i), 0.5 * std::cos(i), i * 0.1));
+  }
+  std::vector<Matrix3> rotations(angles.size());
+  std::vector<Vector3> recovered(angles.size());
+  euler::toRotationBatch(angles.data(), rotations.data(), angles.size(),
+                         EulerConvention::kZYX);
+  euler::fromRotationBatch(rotations.data(), recovered.data(),
+                           rotations.size(), EulerConvention::kZYX);
+  for (std::size_t i = 0; i < angles.size(); ++i) {
+    EXPECT_EQ(rotations[i], euler::toRotation(angles[i], EulerConvention::kZYX));
+    EXPECT_EQ(recovered[i],
+              euler::fromRotation(rotations[i], EulerConvention::kZYX));
+  }
+}
+
+GTEST_TEST(EulerTest, FloatInstantiation) {
+  const Vector3f angles{0.1f, 0.2f, 0.3f};
+  const Vector3f recovered = euler::fromRotation(
+      euler::toRotation(angles, EulerConvention::kZXZ), EulerConvention::kZXZ);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(recovered[i], angles[i], 1e-5f);
+  }
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,92 @@
+#include "expression.h"
+
+#include <sstream>
+#include <type_traits>
+
+#include "isometry.h"
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+GTEST_TEST(ExpressionTest, VectorExpressionsAreLazy) {
+  const Vector3 a{1., 2., 3.};
+  const Vector3 b{4., 5., 6.};
+  const Vector3 c{-1., 0.5, 2.};
+  const double s{1.5};
+
+  // Operators build nodes, not vectors.
+  static_assert(!std::is_same<decltype(a + b), Vector3>::value,
+                "Sums must be lazy.");
+  static_assert(!std::is_same<decltype((a + b) * s - c), Vector3>::value,
+                "Compound expressions must be lazy.");
+
+  const Vector3 fused = (a + b) * s - c;
+  EXPECT_EQ(fused, Vector3((1. + 4.) * s + 1., (2. + 5.) * s - 0.5,
+                           (3. + 6.) * s - 2.));
+  const Vector3 ten_terms =
+      a * 2. + b / c - c * a + 0.5 * (a - b) + (-c) * s + a.cross(b);
+  for (int i = 0; i < 3; ++i) {
+    const double expected = a[i] * 2. + b[i] / c[i] - c[i] * a[i] +
+                            0.5 * (a[i] - b[i]) + (-c[i]) * s +
+                            Vector3(-3., 6., -3.)[i];
+    EXPECT_EQ(ten_terms[i], expected);
+  }
+  EXPECT_DOUBLE_EQ((a - b).norm(), std::sqrt(27.));
+  EXPECT_DOUBLE_EQ((a + b).dot(c), -5. + 3.5 + 18.);
+  EXPECT_TRUE(a + b == std::initializer_list<double>({5., 7., 9.}));
+  EXPECT_TRUE(a - b != a);
+
+  std::stringstream ss;
+  ss << a * 2.;
+  EXPECT_EQ(ss.str(), "(x: 2, y: 4, z: 6)");
+}
+
+GTEST_TEST(ExpressionTest, AssignmentIsAliasSafe) {
+  Vector3 v{1., 0., 0.};
+  v = v.cross(Vector3::kUnitY) + v;
+  EXPECT_EQ(v, Vector3(1., 0., 1.));
+
+  Matrix3 m{1., 2., 3., 4., 5., 6., 7., 8., 9.};
+  m += m * 2.;
+  const Matrix3 kExpected{3., 6., 9., 12., 15., 18., 21., 24., 27.};
+  EXPECT_EQ(m, kExpected);
+  m -= m;
+  EXPECT_EQ(m, Matrix3::kZero);
+}
+
+GTEST_TEST(ExpressionTest, MatrixExpressions) {
+  const Matrix3 a{1., 2., 3., 4., 5., 6., 7., 8., 9.};
+  const Matrix3 b = Matrix3::kOnes * 2.;
+  const Matrix3 fused = (a + b) / b - 0.5 * a * Vector3(1., 2., 3.);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_EQ(fused[i][j], (a[i][j] + 2.) / 2. - 0.5 * a[i][j] * (i + 1.));
+    }
+  }
+  // Every row takes part in the comparison.
+  Matrix3 c{a};
+  c[1][1] = 0.;
+  EXPECT_NE(a, c);
+}
+
+GTEST_TEST(ExpressionTest, ConstantEvaluation) {
+  constexpr Vector3 kA{1., 2., 3.};
+  constexpr Vector3 kB = kA * 2. - Vector3::kUnitX;
+  static_assert(kB.x() == 1. && kB.y() == 4. && kB.z() == 6.,
+                "Expressions must be constexpr.");
+  constexpr Matrix3 kM = Matrix3::kIdentity * 3. + Matrix3::kOnes;
+  static_assert(kM(0, 0) == 4. && kM(0, 1) == 1., "Must fold.");
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
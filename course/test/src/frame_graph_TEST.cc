@@ -0,0 +1,132 @@
+#include "frame_graph.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+testing::AssertionResult areAlmostEqual(const Isometry &a, const Isometry &b,
+                                        const double &tolerance) {
+  for (int i = 0; i < 3; ++i) {
+    if (std::abs(a.translation()[i] - b.translation()[i]) > tolerance) {
+      return testing::AssertionFailure() << a << " != " << b;
+    }
+    for (int j = 0; j < 3; ++j) {
+      if (std::abs(a.rotation()[i][j] - b.rotation()[i][j]) > tolerance) {
+        return testing::AssertionFailure() << a << " != " << b;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+const Isometry world_T_base = Isometry::FromTranslation({10., -5., 0.}) *
+                              Isometry::RotateAround(Vector3::kUnitZ, 0.4);
+const Isometry base_T_arm = Isometry::FromTranslation({0.2, 0., 0.5}) *
+                            Isometry::FromEulerAngles(0.1, 0.2, 0.3);
+const Isometry arm_T_hand = Isometry::FromTranslation({0.6, 0., 0.});
+const Isometry base_T_lidar = Isometry::FromTranslation({0., 0., 1.2}) *
+                              Isometry::RotateAround(Vector3::kUnitY, -0.05);
+
+// world -> base -> {arm -> hand, lidar}, plus a separate `map` tree.
+FrameGraph makeGraph() {
+  FrameGraph graph;
+  graph.addFrame("world");
+  graph.setTransform("world", "base", world_T_base);
+  graph.setTransform("base", "arm", base_T_arm);
+  graph.setTransform("arm", "hand", arm_T_hand);
+  graph.setTransform("base", "lidar", base_T_lidar);
+  graph.addFrame("map");
+  return graph;
+}
+
+GTEST_TEST(FrameGraphTest, Lookup) {
+  const FrameGraph graph = makeGraph();
+  const double kTolerance{1e-12};
+  EXPECT_EQ(graph.size(), 6u);
+  EXPECT_TRUE(areAlmostEqual(graph.lookup("hand", "world"),
+                             world_T_base * base_T_arm * arm_T_hand,
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual(graph.lookup("world", "hand"),
+                             (world_T_base * base_T_arm * arm_T_hand)
+                                 .inverse(),
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual(graph.lookup("hand", "lidar"),
+                             base_T_lidar.inverse() * base_T_arm *
+                                 arm_T_hand,
+                             kTolerance));
+  EXPECT_EQ(graph.lookup("arm", "arm"), Isometry());
+  const FrameGraph::FrameId hand = graph.id("hand");
+  EXPECT_EQ(graph.name(hand), "hand");
+  EXPECT_EQ(graph.parent(hand), graph.id("arm"));
+  EXPECT_EQ(graph.parent(graph.id("world")), graph.id("world"));
+}
+
+GTEST_TEST(FrameGraphTest, CommonAncestor) {
+  const FrameGraph graph = makeGraph();
+  EXPECT_EQ(graph.commonAncestor(graph.id("hand"), graph.id("lidar")),
+            graph.id("base"));
+  EXPECT_EQ(graph.commonAncestor(graph.id("hand"), graph.id("arm")),
+            graph.id("arm"));
+  EXPECT_EQ(graph.commonAncestor(graph.id("world"), graph.id("lidar")),
+            graph.id("world"));
+  EXPECT_THROW(graph.commonAncestor(graph.id("hand"), graph.id("map")),
+               std::invalid_argument);
+}
+
+GTEST_TEST(FrameGraphTest, UpdatesInvalidateSubtrees) {
+  FrameGraph graph = makeGraph();
+  const double kTolerance{1e-12};
+  // Warm the cache, then move the arm joint.
+  graph.lookup("hand", "lidar");
+  const Isometry moved = Isometry::RotateAround(Vector3::kUnitX, 1.);
+  graph.setTransform(graph.id("arm"), moved);
+  EXPECT_TRUE(areAlmostEqual(graph.lookup("hand", "lidar"),
+                             base_T_lidar.inverse() * moved * arm_T_hand,
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual(graph.lookup("lidar", "world"),
+                             world_T_base * base_T_lidar, kTolerance));
+
+  // Re-parent the lidar below the hand, then attach the map tree.
+  graph.setTransform("hand", "lidar", base_T_lidar);
+  EXPECT_TRUE(areAlmostEqual(graph.lookup("lidar", "arm"),
+                             arm_T_hand * base_T_lidar, kTolerance));
+  EXPECT_EQ(graph.commonAncestor(graph.id("lidar"), graph.id("arm")),
+            graph.id("arm"));
+  const Isometry map_T_world = Isometry::FromTranslation({1., 2., 3.});
+  graph.setTransform("map", "world", map_T_world);
+  EXPECT_TRUE(areAlmostEqual(graph.lookup("base", "map"),
+                             map_T_world * world_T_base, kTolerance));
+  EXPECT_EQ(graph.commonAncestor(graph.id("lidar"), graph.id("map")),
+            graph.id("map"));
+}
+
+GTEST_TEST(FrameGraphTest, Errors) {
+  FrameGraph graph = makeGraph();
+  EXPECT_THROW(graph.addFrame("base"), std::invalid_argument);
+  EXPECT_THROW(graph.lookup("base", "unknown"), std::out_of_range);
+  EXPECT_THROW(graph.setTransform("unknown", "base", Isometry()),
+               std::out_of_range);
+  EXPECT_THROW(graph.lookup(graph.id("base"), 42), std::out_of_range);
+  EXPECT_THROW(graph.lookup("hand", "map"), std::invalid_argument);
+  EXPECT_THROW(graph.setTransform("hand", "base", Isometry()),
+               std::invalid_argument);
+  EXPECT_THROW(graph.setTransform("arm", "arm", Isometry()),
+               std::invalid_argument);
+  // The failed edits left the tree untouched.
+  EXPECT_EQ(graph.parent(graph.id("base")), graph.id("world"));
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -8,6 +8,8 @@
 #include <cmath>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -144,10 +146,117 @@ GTEST_TEST(IsometryTest, IsometryOperations) {
   const double cpi_8{std::cos(pi_8)};  // 0.923879532
   const double spi_8{std::sin(pi_8)};  // 0.382683432
   EXPECT_TRUE(areAlmostEqual(t5.rotation(), Matrix3{cpi_8, -spi_8, 0., spi_8, cpi_8, 0., 0., 0., 1.}, kTolerance));
+  const double cpi_4{std::cos(M_PI / 4.)};
+  const double spi_4{std::sin(M_PI / 4.)};
+  EXPECT_TRUE(areAlmostEqual(t4.rotation(), Matrix3{cpi_4, 0., spi_4, 0., 1., 0., -spi_4, 0., cpi_4}, kTolerance));
 
   std::stringstream ss;
   ss << t5;
   EXPECT_EQ(ss.str(), "[T: (x: 0, y: 0, z: 0), R:[[0.923879533, -0.382683432, 0], [0.382683432, 0.923879533, 0], [0, 0, 1]]]");
+  // The stream's own precision is left as it was.
+  EXPECT_EQ(ss.precision(), 6);
+}
+
+GTEST_TEST(IsometryTest, Inverses) {
+  const double kTolerance{1e-12};
+  const Matrix3 m{2., -1., 0.5, 0.3, 4., 1., -2., 0.7, 3.};
+  EXPECT_TRUE(areAlmostEqual(m.product(m.inverse()), Matrix3::kIdentity,
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual(m.inverse().product(m), Matrix3::kIdentity,
+                             kTolerance));
+  const Matrix3 kExpectedTranspose{2., 0.3, -2., -1., 4., 0.7, 0.5, 1., 3.};
+  EXPECT_EQ(m.transpose(), kExpectedTranspose);
+  EXPECT_FALSE(m.isOrthonormal(kTolerance));
+
+  const Isometry rigid = Isometry::FromTranslation({1., -2., 3.}) *
+                         Isometry::FromEulerAngles(0.3, -1.1, 2.5);
+  EXPECT_TRUE(rigid.rotation().isOrthonormal(kTolerance));
+  // The transposed rotation matches the general inverse.
+  EXPECT_TRUE(areAlmostEqual(rigid.inverse().rotation(),
+                             rigid.inverseGeneral().rotation(), kTolerance));
+  EXPECT_TRUE(areAlmostEqual(rigid.inverse(), rigid.inverseGeneral(),
+                             kTolerance));
+  const Vector3 p{0.5, 7., -3.};
+  const Vector3 round_trip = rigid.inverse() * (rigid * p);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(round_trip[i], p[i], kTolerance);
+  }
+
+  const Isometry scaled{Vector3(1., 2., 3.), m};
+  const Vector3 q = scaled.inverseGeneral() * (scaled * p);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_NEAR(q[i], p[i], kTolerance);
+  }
+}
+
+GTEST_TEST(IsometryTest, Orthonormalized) {
+  const double kTolerance{1e-12};
+  const Isometry rigid = Isometry::FromTranslation({1., -2., 3.}) *
+                         Isometry::FromEulerAngles(0.3, -1.1, 2.5);
+  // An already orthonormal rotation is left alone.
+  EXPECT_TRUE(areAlmostEqual(rigid.orthonormalized().rotation(),
+                             rigid.rotation(), kTolerance));
+  EXPECT_EQ(rigid.orthonormalized().translation(), rigid.translation());
+
+  // A rotation perturbed off SO(3) is pulled back close to where it was.
+  const Matrix3 perturbation{1e-4, -2e-4, 3e-4, 0.,   1e-4,
+                             -1e-4, 2e-4, 0.,   -3e-4};
+  const Isometry drifted{rigid.translation(),
+                         rigid.rotation() + perturbation};
+  ASSERT_FALSE(drifted.rotation().isOrthonormal(1e-6));
+  const Isometry fixed = drifted.orthonormalized();
+  EXPECT_EQ(fixed.translation(), rigid.translation());
+  EXPECT_TRUE(fixed.rotation().isOrthonormal(kTolerance));
+  EXPECT_NEAR(fixed.rotation().det(), 1., kTolerance);
+  EXPECT_TRUE(areAlmostEqual(fixed.rotation(), rigid.rotation(), 1e-3));
+}
+
+GTEST_TEST(IsometryTest, FloatInstantiation) {
+  const float kTolerance{1e-6f};
+  const Isometryf t1 = Isometryf::FromTranslation({1.f, 2.f, 3.f});
+  EXPECT_EQ(t1 * Vector3f(1.f, 1.f, 1.f), Vector3f(2.f, 3.f, 4.f));
+  EXPECT_EQ(2 * Vector3f::kUnitX, Vector3f(2.f, 0.f, 0.f));
+  EXPECT_EQ(sizeof(Vector3f), 3 * sizeof(float));
+
+  const Isometry pose{Isometry::FromEulerAngles(M_PI / 2., M_PI / 4., M_PI / 8.)};
+  const Isometryf posef{Isometryf::FromEulerAngles(M_PI / 2., M_PI / 4., M_PI / 8.)};
+  const Isometryf cast = pose.cast<float>();
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR(cast.rotation()[i][j], posef.rotation()[i][j], kTolerance);
+    }
+  }
+  const Vector3f p = posef * Vector3f(1.f, 2.f, 3.f);
+  const Vector3 q = pose * Vector3(1., 2., 3.);
+  EXPECT_NEAR(p.x(), q.x(), kTolerance);
+  EXPECT_NEAR(p.y(), q.y(), kTolerance);
+  EXPECT_NEAR(p.z(), q.z(), kTolerance);
+}
+
+GTEST_TEST(IsometryTest, CompileTimeConstants) {
+  static_assert(Vector3::kUnitY.y() == 1., "kUnitY must be constexpr.");
+  static_assert(Matrix3::kIdentity[2][2] == 1., "kIdentity must be constexpr.");
+  static_assert(Matrix3::kOnes.col(1).z() == 1., "kOnes must be constexpr.");
+  static_assert(Matrix3f::kZero[0][1] == 0.f, "kZero must be constexpr.");
+
+  constexpr Isometry kExtrinsics{Vector3(0.5, -0.25, 1.5),
+                                 Matrix3{0., -1., 0., 1., 0., 0., 0., 0., 1.}};
+  static_assert(kExtrinsics.translation().z() == 1.5, "Must fold.");
+  static_assert(kExtrinsics.rotation()[1][0] == 1., "Must fold.");
+  constexpr Isometry kIdentity;
+  static_assert(kIdentity.rotation()[0][0] == 1., "Must fold.");
+  EXPECT_EQ(kExtrinsics * Vector3::kUnitX, Vector3(0.5, 0.75, 1.5));
+
+  static_assert(std::is_trivially_copyable<Isometry>::value, "");
+  static_assert(std::is_standard_layout<Isometry>::value, "");
+  std::vector<Isometry> poses(3, kExtrinsics);
+  const std::vector<Isometry> copy(poses);
+  EXPECT_EQ(copy[2], kExtrinsics);
+
+  EXPECT_THROW(Vector3(std::initializer_list<double>({1., 2.})),
+               std::invalid_argument);
+  EXPECT_THROW(Matrix3(std::initializer_list<double>({1., 2., 3.})),
+               std::invalid_argument);
 }
 
 }  // namespace test
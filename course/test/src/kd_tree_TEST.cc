@@ -0,0 +1,230 @@
+#include "kd_tree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "thread_pool.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+// Uniform in [-extent, extent]^3; a coarse grid makes many points
+// equidistant from the queries.
+template <typename T>
+PointCloud3T<T> randomCloud(std::size_t count, unsigned seed,
+                            double extent = 10., double grid = 0.) {
+  std::mt19937 generator(seed);
+  std::uniform_real_distribution<double> coordinate(-extent, extent);
+  PointCloud3T<T> cloud;
+  for (std::size_t i = 0; i < count; ++i) {
+    Vector3 point(coordinate(generator), coordinate(generator),
+                  coordinate(generator));
+    for (int k = 0; grid > 0. && k < 3; ++k) {
+      point[k] = grid * std::round(point[k] / grid);
+    }
+    cloud.push_back(point.cast<T>());
+  }
+  return cloud;
+}
+
+template <typename T>
+T squaredDistance(const Vector3T<T> &a, const Vector3T<T> &b) {
+  const T dx = a[0] - b[0], dy = a[1] - b[1], dz = a[2] - b[2];
+  return dx * dx + dy * dy + dz * dz;
+}
+
+// All squared distances from `query`, sorted.
+template <typename T>
+std::vector<T> bruteForce(const PointCloud3T<T> &cloud,
+                          const Vector3T<T> &query) {
+  std::vector<T> distances;
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    distances.push_back(squaredDistance(cloud[i], query));
+  }
+  std::sort(distances.begin(), distances.end());
+  return distances;
+}
+
+// Ties make indices ambiguous, so compare distances and check that every
+// index really is at its reported distance.
+template <typename T>
+testing::AssertionResult areNearest(const PointCloud3T<T> &cloud,
+                                    const Vector3T<T> &query,
+                                    const NeighborT<T> *neighbors,
+                                    std::size_t count) {
+  const std::vector<T> expected = bruteForce(cloud, query);
+  for (std::size_t i = 0; i < count; ++i) {
+    if (neighbors[i].squared_distance != expected[i] ||
+        squaredDistance(cloud[neighbors[i].index], query) != expected[i]) {
+      return testing::AssertionFailure()
+             << "neighbor " << i << " of " << query << " is "
+             << neighbors[i].index << " at " << neighbors[i].squared_distance
+             << ", expected a point at " << expected[i];
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+template <typename T> void checkNearest(double grid) {
+  const PointCloud3T<T> cloud = randomCloud<T>(2000, 1, 10., grid);
+  const PointCloud3T<T> queries = randomCloud<T>(200, 2, 12.);
+  const KdTreeT<T> tree(cloud.view());
+  ASSERT_EQ(tree.size(), cloud.size());
+  std::vector<NeighborT<T>> neighbors(20);
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    const NeighborT<T> nearest = tree.nearest(queries[i]);
+    ASSERT_TRUE(areNearest(cloud, queries[i], &nearest, 1));
+    for (const std::size_t k : {5u, 20u}) {
+      ASSERT_EQ(tree.nearest(queries[i], k, neighbors.data()), k);
+      ASSERT_TRUE(areNearest(cloud, queries[i], neighbors.data(), k));
+    }
+  }
+  // A point of the cloud is its own nearest neighbor.
+  EXPECT_EQ(tree.nearest(cloud[123]).squared_distance, T(0));
+}
+
+GTEST_TEST(KdTreeTest, NearestMatchesBruteForce) {
+  checkNearest<double>(0.);
+  checkNearest<float>(0.);
+  checkNearest<double>(1.);
+  checkNearest<float>(1.);
+}
+
+template <typename T> void checkRadius() {
+  const PointCloud3T<T> cloud = randomCloud<T>(3000, 3);
+  const PointCloud3T<T> queries = randomCloud<T>(100, 4);
+  const KdTreeT<T> tree(cloud.view());
+  std::vector<NeighborT<T>> neighbors;
+  for (const T radius : {T(0.5), T(2), T(50)}) {
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+      tree.radiusSearch(queries[i], radius, neighbors);
+      std::vector<std::size_t> found, expected;
+      for (const NeighborT<T> &neighbor : neighbors) {
+        ASSERT_EQ(neighbor.squared_distance,
+                  squaredDistance(cloud[neighbor.index], queries[i]));
+        found.push_back(neighbor.index);
+      }
+      for (std::size_t j = 0; j < cloud.size(); ++j) {
+        if (squaredDistance(cloud[j], queries[i]) <= radius * radius) {
+          expected.push_back(j);
+        }
+      }
+      std::sort(found.begin(), found.end());
+      ASSERT_EQ(found, expected) << "radius " << radius;
+    }
+  }
+}
+
+GTEST_TEST(KdTreeTest, RadiusSearchMatchesBruteForce) {
+  checkRadius<double>();
+  checkRadius<float>();
+}
+
+template <typename T> void checkBatches() {
+  // Large enough for the pool to split both the build and the queries.
+  const PointCloud3T<T> cloud = randomCloud<T>(100000, 5);
+  const PointCloud3T<T> queries = randomCloud<T>(10000, 6);
+  ThreadPool pool(4);
+  const KdTreeT<T> serial_tree(cloud.view());
+  const KdTreeT<T> tree(cloud.view(), pool);
+  const std::size_t k = 4;
+
+  std::vector<NeighborT<T>> serial, parallel, single(k);
+  serial_tree.nearest(queries.view(), k, serial);
+  tree.nearest(queries.view(), k, parallel, pool);
+  ASSERT_EQ(serial.size(), queries.size() * k);
+  ASSERT_EQ(parallel.size(), serial.size());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    tree.nearest(queries[i], k, single.data());
+    for (std::size_t j = 0; j < k; ++j) {
+      ASSERT_EQ(serial[i * k + j].index, single[j].index);
+      ASSERT_EQ(parallel[i * k + j].index, single[j].index);
+    }
+  }
+
+  std::vector<std::size_t> serial_offsets, parallel_offsets;
+  serial_tree.radiusSearch(queries.view(), T(0.3), serial_offsets, serial);
+  tree.radiusSearch(queries.view(), T(0.3), parallel_offsets, parallel,
+                    pool);
+  ASSERT_EQ(serial_offsets.size(), queries.size() + 1);
+  ASSERT_EQ(serial_offsets, parallel_offsets);
+  ASSERT_GT(serial_offsets.back(), queries.size());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    tree.radiusSearch(queries[i], T(0.3), single);
+    ASSERT_EQ(single.size(), serial_offsets[i + 1] - serial_offsets[i]);
+    for (std::size_t j = 0; j < single.size(); ++j) {
+      ASSERT_EQ(serial[serial_offsets[i] + j].index, single[j].index);
+      ASSERT_EQ(parallel[serial_offsets[i] + j].index, single[j].index);
+    }
+  }
+}
+
+GTEST_TEST(KdTreeTest, BatchesMatchSingleQueries) {
+  checkBatches<double>();
+  checkBatches<float>();
+}
+
+GTEST_TEST(KdTreeTest, SmallAndDegenerateSets) {
+  const KdTree empty_tree;
+  EXPECT_TRUE(empty_tree.empty());
+  EXPECT_THROW(empty_tree.nearest(Vector3()), std::out_of_range);
+  Neighbor neighbor;
+  EXPECT_EQ(empty_tree.nearest(Vector3(), 3, &neighbor), 0u);
+  std::vector<Neighbor> neighbors;
+  empty_tree.radiusSearch(Vector3(), 1., neighbors);
+  EXPECT_TRUE(neighbors.empty());
+  std::vector<std::size_t> offsets;
+  const PointCloud3 queries = randomCloud<double>(3, 7);
+  empty_tree.radiusSearch(queries.view(), 1., offsets, neighbors);
+  EXPECT_EQ(offsets, std::vector<std::size_t>(4, 0));
+  empty_tree.nearest(queries.view(), 2, neighbors);
+  EXPECT_TRUE(neighbors.empty());
+
+  // Fewer points than asked for.
+  const std::vector<Vector3> three{{0., 0., 0.}, {3., 0., 0.}, {1., 0., 0.}};
+  const KdTree small_tree(three);
+  Neighbor found[5];
+  ASSERT_EQ(small_tree.nearest(Vector3(2.9, 0., 0.), 5, found), 3u);
+  EXPECT_EQ(found[0].index, 1u);
+  EXPECT_EQ(found[1].index, 2u);
+  EXPECT_EQ(found[2].index, 0u);
+  small_tree.nearest(queries.view(), 5, neighbors);
+  EXPECT_EQ(neighbors.size(), 3 * queries.size());
+
+  // Every point in the same place.
+  const std::vector<Vector3f> same(1000, Vector3f(1.f, 2.f, 3.f));
+  const KdTreef same_tree(same);
+  std::vector<Neighborf> all;
+  same_tree.radiusSearch(Vector3f(1.f, 2.f, 3.f), 0.f, all);
+  EXPECT_EQ(all.size(), same.size());
+
+  EXPECT_THROW(small_tree.radiusSearch(Vector3(), -1., neighbors),
+               std::invalid_argument);
+  EXPECT_THROW(small_tree.radiusSearch(
+                   queries.view(), std::numeric_limits<double>::quiet_NaN(),
+                   offsets, neighbors),
+               std::invalid_argument);
+}
+
+GTEST_TEST(KdTreeTest, MemoryBytes) {
+  const PointCloud3f cloud = randomCloud<float>(1000, 8);
+  const KdTreef tree(cloud.view());
+  // Three coordinates and an index per point.
+  EXPECT_EQ(tree.memoryBytes(), 1000u * 16);
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
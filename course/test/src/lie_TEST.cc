@@ -0,0 +1,184 @@
+#include "lie.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+testing::AssertionResult areAlmostEqual(const Matrix3 &a, const Matrix3 &b,
+                                        const double &tolerance) {
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      if (std::abs(a[i][j] - b[i][j]) > tolerance) {
+        return testing::AssertionFailure() << a << " != " << b;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+testing::AssertionResult areAlmostEqual(const Vector3 &a, const Vector3 &b,
+                                        const double &tolerance) {
+  if ((a - b).norm() > tolerance) {
+    return testing::AssertionFailure() << a << " != " << b;
+  }
+  return testing::AssertionSuccess();
+}
+
+testing::AssertionResult areAlmostEqual(const Isometry &a, const Isometry &b,
+                                        const double &tolerance) {
+  if (!areAlmostEqual(a.rotation(), b.rotation(), tolerance) ||
+      !areAlmostEqual(a.translation(), b.translation(), tolerance)) {
+    return testing::AssertionFailure() << a << " != " << b;
+  }
+  return testing::AssertionSuccess();
+}
+
+// Rotation vectors from zero through the Taylor threshold up to pi.
+std::vector<Vector3> rotationVectors() {
+  const Vector3 direction{1., -2., 0.5};
+  const Vector3 axis = direction * (1. / direction.norm());
+  std::vector<Vector3> output;
+  for (const double angle : {0., 1e-9, 1e-4, 0.09, 0.11, 1., 2.5, 3.1,
+                             M_PI - 1e-7, M_PI}) {
+    output.push_back(axis * angle);
+  }
+  output.push_back(Vector3::kUnitY * M_PI);
+  return output;
+}
+
+GTEST_TEST(LieTest, HatVee) {
+  const Vector3 v{1., 2., 3.};
+  const Vector3 w{-0.5, 4., 1.};
+  EXPECT_TRUE(areAlmostEqual(so3::hat(v).product(w), v.cross(w), 1e-15));
+  EXPECT_EQ(so3::vee(so3::hat(v)), v);
+  EXPECT_EQ(so3::hat(v).transpose(), Matrix3(so3::hat(v) * -1.));
+}
+
+GTEST_TEST(LieTest, So3ExpLog) {
+  const double kTolerance{1e-12};
+  EXPECT_EQ(so3::exp(Vector3::kZero), Matrix3::kIdentity);
+  EXPECT_TRUE(areAlmostEqual(
+      so3::exp(Vector3(Vector3::kUnitZ * (M_PI / 8.))),
+      Isometry::RotateAround(Vector3::kUnitZ, M_PI / 8.).rotation(),
+      kTolerance));
+  for (const Vector3 &phi : rotationVectors()) {
+    const Matrix3 rotation = so3::exp(phi);
+    EXPECT_TRUE(rotation.isOrthonormal(kTolerance)) << phi;
+    const Vector3 recovered = so3::log(rotation);
+    // At exactly pi the sign of the axis is arbitrary.
+    if (phi.norm() < M_PI - 1e-3) {
+      EXPECT_TRUE(areAlmostEqual(recovered, phi, 1e-9)) << phi;
+    }
+    EXPECT_TRUE(areAlmostEqual(so3::exp(recovered), rotation, 1e-9)) << phi;
+  }
+}
+
+GTEST_TEST(LieTest, So3Jacobians) {
+  const double kStep{1e-6};
+  for (const Vector3 &phi : rotationVectors()) {
+    const Matrix3 left = so3::leftJacobian(phi);
+    const Matrix3 right = so3::rightJacobian(phi);
+    EXPECT_TRUE(areAlmostEqual(left.product(so3::leftJacobianInverse(phi)),
+                               Matrix3::kIdentity, 1e-9))
+        << phi;
+    EXPECT_TRUE(areAlmostEqual(right.product(so3::rightJacobianInverse(phi)),
+                               Matrix3::kIdentity, 1e-9))
+        << phi;
+    EXPECT_TRUE(areAlmostEqual(left, so3::rightJacobian(Vector3(-phi)), 1e-15));
+    // Finite differences of the right Jacobian definition.
+    const Matrix3 rotation = so3::exp(phi);
+    for (int j = 0; j < 3; ++j) {
+      Vector3 step;
+      step[j] = kStep;
+      const Matrix3 perturbed = so3::exp(Vector3(phi + step));
+      const Vector3 numeric =
+          so3::log(rotation.transpose().product(perturbed)) * (1. / kStep);
+      EXPECT_TRUE(areAlmostEqual(numeric, right.col(j), 1e-5)) << phi;
+    }
+  }
+}
+
+GTEST_TEST(LieTest, Se3ExpLog) {
+  const Vector3 rho{1., -2., 3.};
+  for (const Vector3 &phi : rotationVectors()) {
+    const Twist twist(rho, phi);
+    const Isometry pose = se3::exp(twist);
+    EXPECT_TRUE(areAlmostEqual(pose.rotation(), so3::exp(phi), 1e-15));
+    EXPECT_TRUE(areAlmostEqual(se3::exp(se3::log(pose)), pose, 1e-9)) << phi;
+    if (phi.norm() < M_PI - 1e-3) {
+      const Twist recovered = se3::log(pose);
+      EXPECT_TRUE(areAlmostEqual(recovered.rho, rho, 1e-9)) << phi;
+      EXPECT_TRUE(areAlmostEqual(recovered.phi, phi, 1e-9)) << phi;
+    }
+  }
+  // A pure translation.
+  EXPECT_TRUE(areAlmostEqual(se3::exp(Twist(rho, Vector3::kZero)),
+                             Isometry::FromTranslation(rho), 0.));
+}
+
+GTEST_TEST(LieTest, AdjointAndPerturbations) {
+  const double kTolerance{1e-9};
+  const Isometry pose =
+      Isometry::FromTranslation({1., 2., 3.}) *
+      Isometry::RotateAround(Vector3(0., 0.6, 0.8), 0.7);
+  const Twist xi({0.3, -0.1, 0.2}, {0.05, 0.4, -0.2});
+  EXPECT_TRUE(areAlmostEqual(se3::exp(se3::adjoint(pose) * xi),
+                             pose * se3::exp(xi) * pose.inverse(),
+                             kTolerance));
+
+  const Isometry other = se3::boxplus(pose, xi);
+  EXPECT_TRUE(areAlmostEqual(other, pose * se3::exp(xi), kTolerance));
+  const Twist delta = se3::boxminus(other, pose);
+  EXPECT_TRUE(areAlmostEqual(delta.rho, xi.rho, kTolerance));
+  EXPECT_TRUE(areAlmostEqual(delta.phi, xi.phi, kTolerance));
+  EXPECT_TRUE(
+      areAlmostEqual(se3::boxplus(pose, se3::boxminus(other, pose)), other,
+                     kTolerance));
+}
+
+GTEST_TEST(LieTest, Batches) {
+  std::vector<Twist> twists;
+  for (const Vector3 &phi : rotationVectors()) {
+    twists.push_back(Twist({0.5, 0.25, -1.}, phi));
+  }
+  std::vector<Isometry> poses(twists.size());
+  std::vector<Twist> logs(twists.size());
+  std::vector<Vector3> phis;
+  for (const Twist &twist : twists) {
+    phis.push_back(twist.phi);
+  }
+  std::vector<Matrix3> rotations(phis.size());
+  se3::expBatch(twists.data(), poses.data(), twists.size());
+  se3::logBatch(poses.data(), logs.data(), poses.size());
+  so3::expBatch(phis.data(), rotations.data(), phis.size());
+  for (std::size_t i = 0; i < twists.size(); ++i) {
+    EXPECT_EQ(poses[i], se3::exp(twists[i]));
+    EXPECT_EQ(logs[i], se3::log(poses[i]));
+    EXPECT_EQ(rotations[i], so3::exp(phis[i]));
+  }
+}
+
+GTEST_TEST(LieTest, FloatInstantiation) {
+  const Twistf twist({1.f, 0.f, 0.f}, {0.f, 0.f, 0.5f});
+  const Isometryf pose = se3::exp(twist);
+  const Twistf recovered = se3::log(pose);
+  EXPECT_NEAR(recovered.rho.x(), 1.f, 1e-6f);
+  EXPECT_NEAR(recovered.phi.z(), 0.5f, 1e-6f);
+  EXPECT_NEAR(so3::log(so3::exp(Vector3f(0.f, 1e-4f, 0.f))).y(), 1e-4f,
+              1e-10f);
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
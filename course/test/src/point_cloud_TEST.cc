@@ -0,0 +1,134 @@
+#include "point_cloud.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "thread_pool.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+GTEST_TEST(PointCloud3Test, Accessors) {
+  PointCloud3 cloud;
+  EXPECT_TRUE(cloud.empty());
+  cloud.push_back(Vector3(1., 2., 3.));
+  cloud.push_back(Vector3(4., 5., 6.));
+  ASSERT_EQ(cloud.size(), 2u);
+  EXPECT_EQ(cloud[0], Vector3(1., 2., 3.));
+  EXPECT_EQ(cloud[1], Vector3(4., 5., 6.));
+  EXPECT_EQ(cloud.x()[1], 4.);
+  EXPECT_EQ(cloud.y()[1], 5.);
+  EXPECT_EQ(cloud.z()[1], 6.);
+
+  cloud.set(0, Vector3::kUnitZ);
+  EXPECT_EQ(cloud[0], Vector3::kUnitZ);
+
+  const std::vector<Vector3> points{Vector3(1., 0., 0.), Vector3(0., 1., 0.)};
+  const PointCloud3 from_vector(points);
+  EXPECT_EQ(from_vector.toVector(), points);
+
+  cloud.clear();
+  EXPECT_TRUE(cloud.empty());
+}
+
+GTEST_TEST(PointCloud3Test, BatchTransformMatchesPointwise) {
+  const double kTolerance{1e-12};
+  const Isometry t = Isometry::FromTranslation({1., -2., 3.}) *
+                     Isometry::FromEulerAngles(M_PI / 3., M_PI / 5., M_PI / 7.);
+  PointCloud3 in;
+  for (int i = 0; i < 1001; ++i) {
+    in.push_back(Vector3(std::sin(i), std::cos(i * 0.5), i * 0.01));
+  }
+  PointCloud3 out;
+  t.transform(in, out);
+  ASSERT_EQ(out.size(), in.size());
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    const Vector3 expected = t * in[i];
+    EXPECT_NEAR(out[i].x(), expected.x(), kTolerance);
+    EXPECT_NEAR(out[i].y(), expected.y(), kTolerance);
+    EXPECT_NEAR(out[i].z(), expected.z(), kTolerance);
+  }
+
+  // In place.
+  t.transform(in, in);
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    EXPECT_EQ(in[i], out[i]);
+  }
+}
+
+GTEST_TEST(PointCloud3Test, ParallelTransformMatchesSerial) {
+  const Isometry t = Isometry::FromTranslation({1., -2., 3.}) *
+                     Isometry::FromEulerAngles(M_PI / 3., M_PI / 5., M_PI / 7.);
+  PointCloud3 in;
+  // Well past the serial cutoff and not a multiple of the chunk size.
+  for (int i = 0; i < 100003; ++i) {
+    in.push_back(Vector3(std::sin(i), std::cos(i * 0.5), i * 0.01));
+  }
+  PointCloud3 serial;
+  t.transform(in, serial);
+  for (const std::size_t threads : {1u, 2u, 4u}) {
+    ThreadPool pool(threads);
+    PointCloud3 parallel;
+    t.transform(in, parallel, pool);
+    EXPECT_EQ(parallel.toVector(), serial.toVector());
+  }
+
+  // In place, and below the cutoff.
+  ThreadPool pool(3);
+  t.transform(in, in, pool);
+  EXPECT_EQ(in.toVector(), serial.toVector());
+  PointCloud3 small(std::vector<Vector3>{Vector3::kUnitX, Vector3::kUnitY});
+  PointCloud3 small_out;
+  t.transform(small, small_out, pool);
+  EXPECT_EQ(small_out[0], t * Vector3::kUnitX);
+  EXPECT_EQ(small_out[1], t * Vector3::kUnitY);
+
+  // A caller-chosen cutoff: a cloud under the default one split across the
+  // pool, and a large one kept on the calling thread.
+  PointCloud3 medium;
+  for (int i = 0; i < 20000; ++i) {
+    medium.push_back(Vector3(std::cos(i), i * 0.02, std::sin(i * 0.3)));
+  }
+  ASSERT_LT(medium.size(), kCloudSerialCutoff);
+  PointCloud3 medium_serial, medium_parallel;
+  t.transform(medium, medium_serial);
+  t.transform(medium, medium_parallel, pool, 1);
+  EXPECT_EQ(medium_parallel.toVector(), medium_serial.toVector());
+  t.transform(medium.view(), medium_parallel, pool, 1);
+  EXPECT_EQ(medium_parallel.toVector(), medium_serial.toVector());
+  PointCloud3 kept;
+  t.transform(serial, kept, pool, serial.size() + 1);
+  t.transform(serial, serial);
+  EXPECT_EQ(kept.toVector(), serial.toVector());
+}
+
+GTEST_TEST(PointCloud3Test, MixedPrecisionTransform) {
+  const Isometry pose = Isometry::FromTranslation({100., -50., 2.}) *
+                        Isometry::FromEulerAngles(0.1, -0.2, 0.3) *
+                        Isometry::RotateAround(Vector3::kUnitZ, 0.05);
+  PointCloud3f in;
+  for (int i = 0; i < 257; ++i) {
+    in.push_back(Vector3f(std::sin(i) * 10., std::cos(i) * 10., i * 0.1));
+  }
+  PointCloud3f out;
+  transform(pose, in, out);
+  ASSERT_EQ(out.size(), in.size());
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    const Vector3 expected = pose * in[i].cast<double>();
+    EXPECT_NEAR(out[i].x(), expected.x(), 1e-4);
+    EXPECT_NEAR(out[i].y(), expected.y(), 1e-4);
+    EXPECT_NEAR(out[i].z(), expected.z(), 1e-4);
+  }
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,227 @@
+#include "point_file.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "thread_pool.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+std::string tempPath(const std::string &name) {
+  return testing::internal::TempDir() + "point_file_TEST_" + name;
+}
+
+void writeFile(const std::string &path, const std::string &bytes) {
+  std::ofstream(path, std::ios::binary) << bytes;
+}
+
+template <typename T> std::string bytesOf(const T &value) {
+  return std::string(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// Point i of the hand-written files.
+Vector3f pointNumber(int i) {
+  return Vector3f(0.5f * i, -1.f * i, 2.f + i);
+}
+
+// x y z floats interleaved with an intensity and an RGB triplet, so records
+// are 19 bytes and most values are unaligned.
+std::string interleavedRecords(int count) {
+  std::string bytes;
+  for (int i = 0; i < count; ++i) {
+    const Vector3f p = pointNumber(i);
+    bytes += bytesOf(p.x()) + bytesOf(float(10 * i)) + bytesOf(p.y()) +
+             bytesOf(p.z());
+    bytes += std::string{char(i), char(2 * i), char(3 * i)};
+  }
+  return bytes;
+}
+
+// The batch kernels may fuse multiply-adds, the strided path does not.
+testing::AssertionResult areAlmostEqual(const PointCloud3f &a,
+                                        const PointCloud3f &b) {
+  if (a.size() != b.size()) {
+    return testing::AssertionFailure() << "sizes differ";
+  }
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    for (int k = 0; k < 3; ++k) {
+      if (std::abs(a[i][k] - b[i][k]) > 1e-6f * (1.f + std::abs(b[i][k]))) {
+        return testing::AssertionFailure()
+               << "point " << i << ": " << a[i] << " != " << b[i];
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+GTEST_TEST(PointFileTest, InterleavedPly) {
+  const std::string path = tempPath("interleaved.ply");
+  // A face element first, which the reader has to skip over.
+  writeFile(path, "ply\nformat binary_little_endian 1.0\ncomment test\n"
+                  "element camera 2\nproperty double focal\n"
+                  "element vertex 5\nproperty float x\nproperty float "
+                  "intensity\nproperty float y\nproperty float z\n"
+                  "property uchar red\nproperty uchar green\n"
+                  "property uchar blue\nelement face 0\n"
+                  "property list uchar int vertex_indices\nend_header\n" +
+                      std::string(16, '\0') + interleavedRecords(5));
+  const MappedPointFile file(path);
+  EXPECT_EQ(file.format(), PointFileFormat::kPly);
+  ASSERT_EQ(file.size(), 5u);
+  EXPECT_EQ(file.stride(), 19u);
+  EXPECT_EQ(file.scalarSize(), 4u);
+  EXPECT_EQ(file.fields().size(), 7u);
+  EXPECT_EQ(file.field("y").offset, 8u);
+
+  const PointView3f points = file.points<float>();
+  const StridedSpan<float> intensity = file.values<float>("intensity");
+  const StridedSpan<unsigned char> blue = file.values<unsigned char>("blue");
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(points[i], pointNumber(i));
+    EXPECT_EQ(intensity[i], 10.f * i);
+    EXPECT_EQ(blue[i], 3 * i);
+  }
+  EXPECT_THROW(file.points<double>(), std::invalid_argument);
+  EXPECT_THROW(file.values<std::int32_t>("intensity"), std::invalid_argument);
+  EXPECT_THROW(file.values<float>("normal_x"), std::out_of_range);
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(PointFileTest, InterleavedPcd) {
+  const std::string path = tempPath("interleaved.pcd");
+  writeFile(path, "# .PCD v0.7 - Point Cloud Data file format\n"
+                  "VERSION 0.7\nFIELDS x intensity y z rgb\n"
+                  "SIZE 4 4 4 4 1\nTYPE F F F F U\nCOUNT 1 1 1 1 3\n"
+                  "WIDTH 4\nHEIGHT 1\nVIEWPOINT 0 0 0 1 0 0 0\nPOINTS 4\n"
+                  "DATA binary\n" +
+                      interleavedRecords(4));
+  const MappedPointFile file(path);
+  EXPECT_EQ(file.format(), PointFileFormat::kPcd);
+  ASSERT_EQ(file.size(), 4u);
+  EXPECT_EQ(file.stride(), 19u);
+  EXPECT_EQ(file.field("rgb").count, 3u);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(file.points<float>()[i], pointNumber(i));
+  }
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(PointFileTest, WriterRoundTrip) {
+  PointCloud3 cloud;
+  for (int i = 0; i < 10000; ++i) {
+    cloud.push_back(Vector3(std::sin(i), std::cos(i), 0.01 * i));
+  }
+  for (const PointFileFormat format :
+       {PointFileFormat::kPly, PointFileFormat::kPcd}) {
+    const std::string path = tempPath("written");
+    {
+      PointFileWriter<double> writer(path, format);
+      const std::vector<Vector3> first{cloud[0], cloud[1]};
+      writer.write(first.data(), first.size());
+      writer.write(cloud.view().subview(2, cloud.size() - 2));
+      EXPECT_EQ(writer.size(), cloud.size());
+      writer.close();
+    }
+    const MappedPointFile file(path);
+    EXPECT_EQ(file.format(), format);
+    ASSERT_EQ(file.size(), cloud.size());
+    EXPECT_EQ(file.stride(), 3 * sizeof(double));
+    const PointView3 points = file.points<double>();
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      ASSERT_EQ(points[i], cloud[i]) << i;
+    }
+    std::remove(path.c_str());
+  }
+
+  // The destructor closes, and an empty file is still valid.
+  const std::string path = tempPath("empty.ply");
+  { PointFileWriter<float> writer(path, PointFileFormat::kPly); }
+  EXPECT_EQ(MappedPointFile(path).size(), 0u);
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(PointFileTest, TransformWithoutCopy) {
+  const std::string path = tempPath("transform.pcd");
+  const int kPoints{70000};
+  writeFile(path, "FIELDS x intensity y z rgb\nSIZE 4 4 4 4 1\n"
+                  "TYPE F F F F U\nCOUNT 1 1 1 1 3\nWIDTH " +
+                      std::to_string(kPoints) + "\nHEIGHT 1\nDATA binary\n" +
+                      interleavedRecords(kPoints));
+  const MappedPointFile file(path);
+  const PointView3f points = file.points<float>();
+  PointCloud3f copied;
+  for (int i = 0; i < kPoints; ++i) {
+    copied.push_back(points[i]);
+  }
+  const Isometryf pose = Isometryf::FromTranslation({1.f, 2.f, 3.f}) *
+                         Isometryf::FromEulerAngles(0.1f, 0.2f, 0.3f);
+  PointCloud3f expected;
+  pose.transform(copied, expected);
+  PointCloud3f direct;
+  pose.transform(points, direct);
+  EXPECT_TRUE(areAlmostEqual(direct, expected));
+  ThreadPool pool(3);
+  PointCloud3f pooled;
+  pose.transform(points, pooled, pool);
+  EXPECT_EQ(pooled.toVector(), direct.toVector());
+  // Contiguous views take the batch kernels.
+  PointCloud3f from_view;
+  pose.transform(copied.view(), from_view);
+  EXPECT_EQ(from_view.toVector(), expected.toVector());
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(PointFileTest, RejectsUnsupportedFiles) {
+  EXPECT_THROW(MappedPointFile(tempPath("missing")), std::runtime_error);
+  const std::string path = tempPath("bad");
+  const std::string ply_vertex =
+      "element vertex 2\nproperty float x\nproperty float y\n"
+      "property float z\nend_header\n";
+  const std::string records(24, '\0');
+
+  writeFile(path, "ply\nformat ascii 1.0\n" + ply_vertex);
+  EXPECT_THROW(MappedPointFile{path}, std::invalid_argument);
+  writeFile(path, "ply\nformat binary_big_endian 1.0\n" + ply_vertex);
+  EXPECT_THROW(MappedPointFile{path}, std::invalid_argument);
+  // Truncated.
+  writeFile(path, "ply\nformat binary_little_endian 1.0\n" + ply_vertex +
+                      records.substr(1));
+  EXPECT_THROW(MappedPointFile{path}, std::invalid_argument);
+  writeFile(path, "ply\nformat binary_little_endian 1.0\n" + ply_vertex +
+                      records);
+  EXPECT_EQ(MappedPointFile{path}.size(), 2u);
+  // Mixed float and double coordinates.
+  writeFile(path, "ply\nformat binary_little_endian 1.0\nelement vertex 0\n"
+                  "property float x\nproperty double y\nproperty float z\n"
+                  "end_header\n");
+  EXPECT_THROW(MappedPointFile{path}, std::invalid_argument);
+
+  writeFile(path, "FIELDS x y z\nSIZE 4 4 4\nTYPE F F F\nWIDTH 1\n"
+                  "DATA ascii\n1 2 3\n");
+  EXPECT_THROW(MappedPointFile{path}, std::invalid_argument);
+  writeFile(path, "FIELDS x y z\nSIZE 4 4\nTYPE F F F\nWIDTH 0\n"
+                  "DATA binary\n");
+  EXPECT_THROW(MappedPointFile{path}, std::invalid_argument);
+  writeFile(path, "not a point file");
+  EXPECT_THROW(MappedPointFile{path}, std::invalid_argument);
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
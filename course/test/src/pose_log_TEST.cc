@@ -0,0 +1,242 @@
+#include "pose_log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+// Rotations all over SO(3), so every quaternion component gets dropped,
+// and translations a few kilometers out.
+std::vector<Isometry> randomPoses(std::size_t count) {
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  std::uniform_real_distribution<double> position(-3000., 3000.);
+  std::vector<Isometry> poses;
+  for (std::size_t i = 0; i < count; ++i) {
+    poses.push_back(
+        Isometry::FromTranslation({position(generator), position(generator),
+                                   position(generator)}) *
+        Isometry::FromEulerAngles(angle(generator), angle(generator),
+                                  angle(generator)));
+  }
+  return poses;
+}
+
+// A vehicle driving at about 1 m/s, sampled at 100 Hz.
+std::vector<Isometry> smoothPoses(std::size_t count) {
+  std::vector<Isometry> poses;
+  for (std::size_t i = 0; i < count; ++i) {
+    const double t = 0.01 * i;
+    poses.push_back(
+        Isometry::FromTranslation(
+            {20. * std::sin(0.05 * t), 15. * std::cos(0.03 * t), 0.1 * t}) *
+        Isometry::FromEulerAngles(0.02 * std::sin(2. * t),
+                                  0.01 * std::cos(3. * t), 0.05 * t));
+  }
+  return poses;
+}
+
+double rotationAngle(const Matrix3 &a, const Matrix3 &b) {
+  double trace = 0.;
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      trace += a(i, j) * b(i, j);
+    }
+  }
+  return std::acos(std::min(1., std::max(-1., (trace - 1.) / 2.)));
+}
+
+testing::AssertionResult areWithinBounds(const Isometry &original,
+                                         const Isometry &decoded,
+                                         const PoseLogOptions &options) {
+  for (int k = 0; k < 3; ++k) {
+    if (std::abs(original.translation()[k] - decoded.translation()[k]) >
+        options.maxTranslationError() * (1. + 1e-9)) {
+      return testing::AssertionFailure()
+             << "translation " << decoded.translation() << " of "
+             << original.translation();
+    }
+  }
+  const double angle = rotationAngle(original.rotation(), decoded.rotation());
+  if (angle > options.maxRotationError()) {
+    return testing::AssertionFailure() << "rotation off by " << angle;
+  }
+  return testing::AssertionSuccess();
+}
+
+GTEST_TEST(PoseLogTest, RoundTripWithinErrorBounds) {
+  const std::vector<Isometry> poses = randomPoses(5000);
+  for (const int bits : {8, 16, 24}) {
+    PoseLogOptions options;
+    options.translation_step = 1e-3;
+    options.rotation_bits = bits;
+    options.chunk_size = 700;
+    PoseLogEncoder encoder(options);
+    encoder.append(poses.data(), 1234);
+    encoder.append(poses.data() + 1234, poses.size() - 1234);
+    EXPECT_EQ(encoder.size(), poses.size());
+    const std::vector<std::uint8_t> log = encoder.finish();
+    EXPECT_EQ(encoder.size(), 0u);
+
+    const PoseLogDecoder decoder(log);
+    ASSERT_EQ(decoder.size(), poses.size());
+    EXPECT_EQ(decoder.chunkCount(), 8u);
+    EXPECT_EQ(decoder.options().rotation_bits, bits);
+    EXPECT_EQ(decoder.options().translation_step, 1e-3);
+    std::vector<Isometry> decoded(poses.size());
+    decoder.decode(0, poses.size(), decoded.data());
+    for (std::size_t i = 0; i < poses.size(); ++i) {
+      ASSERT_TRUE(areWithinBounds(poses[i], decoded[i], options))
+          << "pose " << i << " at " << bits << " bits";
+      // Decoded rotations are exactly orthonormal up to rounding.
+      ASSERT_TRUE(decoded[i].rotation().isOrthonormal(1e-14));
+    }
+  }
+}
+
+GTEST_TEST(PoseLogTest, RandomAccess) {
+  const std::vector<Isometry> poses = randomPoses(1000);
+  PoseLogOptions options;
+  options.chunk_size = 300;
+  PoseLogEncoder encoder(options);
+  encoder.append(poses.data(), poses.size());
+  const std::vector<std::uint8_t> log = encoder.finish();
+  const PoseLogDecoder decoder(log);
+  std::vector<Isometry> all(poses.size());
+  decoder.decode(0, poses.size(), all.data());
+
+  // Inside a chunk, across one boundary and across several.
+  for (const std::size_t first : {0u, 17u, 299u, 300u, 550u, 999u}) {
+    for (const std::size_t count : {1u, 2u, 250u, 700u}) {
+      if (first + count > poses.size()) {
+        continue;
+      }
+      std::vector<Isometry> some(count);
+      decoder.decode(first, count, some.data());
+      for (std::size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(some[i], all[first + i]) << first << " + " << i;
+      }
+    }
+  }
+  EXPECT_EQ(decoder.at<double>(601), all[601]);
+  EXPECT_THROW(decoder.at<double>(1000), std::out_of_range);
+  Isometry pose;
+  EXPECT_THROW(decoder.decode(990, 11, &pose), std::out_of_range);
+  decoder.decode(1000, 0, &pose);
+}
+
+GTEST_TEST(PoseLogTest, FloatPoses) {
+  const std::vector<Isometry> poses = smoothPoses(3000);
+  std::vector<Isometryf> posesf;
+  for (const Isometry &pose : poses) {
+    posesf.push_back(pose.cast<float>());
+  }
+  PoseLogEncoder encoder;
+  encoder.append(posesf.data(), posesf.size());
+  const std::vector<std::uint8_t> log = encoder.finish();
+  const PoseLogDecoder decoder(log);
+  std::vector<Isometryf> decoded(posesf.size());
+  decoder.decode(0, decoded.size(), decoded.data());
+  for (std::size_t i = 0; i < poses.size(); ++i) {
+    for (int k = 0; k < 3; ++k) {
+      ASSERT_NEAR(decoded[i].translation()[k], posesf[i].translation()[k],
+                  1e-4);
+    }
+    ASSERT_LT(rotationAngle(decoded[i].rotation().cast<double>(),
+                            posesf[i].rotation().cast<double>()),
+              1e-3);
+  }
+}
+
+GTEST_TEST(PoseLogTest, SmoothTrajectoriesCompress) {
+  const std::vector<Isometry> poses = smoothPoses(100000);
+  PoseLogEncoder encoder;
+  encoder.append(poses.data(), poses.size());
+  const std::vector<std::uint8_t> log = encoder.finish();
+  // At least 10x smaller than 12 doubles per pose.
+  EXPECT_LT(log.size() * 10, poses.size() * sizeof(Isometry));
+
+  const PoseLogDecoder decoder(log);
+  std::vector<Isometry> decoded(poses.size());
+  decoder.decode(0, poses.size(), decoded.data());
+  for (std::size_t i = 0; i < poses.size(); ++i) {
+    ASSERT_TRUE(areWithinBounds(poses[i], decoded[i], decoder.options()))
+        << "pose " << i;
+  }
+}
+
+GTEST_TEST(PoseLogTest, EncoderStartsOverAfterFinish) {
+  PoseLogEncoder encoder;
+  const std::vector<std::uint8_t> empty = encoder.finish();
+  EXPECT_EQ(empty.size(), kPoseLogHeaderSize);
+  EXPECT_EQ(PoseLogDecoder(empty).size(), 0u);
+
+  const std::vector<Isometry> poses = smoothPoses(10);
+  encoder.append(poses.data(), 4);
+  const std::vector<std::uint8_t> first = encoder.finish();
+  encoder.append(poses.data(), 10);
+  const std::vector<std::uint8_t> second = encoder.finish();
+  EXPECT_EQ(PoseLogDecoder(first).size(), 4u);
+  EXPECT_EQ(PoseLogDecoder(second).size(), 10u);
+  EXPECT_EQ(PoseLogDecoder(second).at<double>(3),
+            PoseLogDecoder(first).at<double>(3));
+}
+
+GTEST_TEST(PoseLogTest, RejectsBadInput) {
+  PoseLogOptions options;
+  options.translation_step = 0.;
+  EXPECT_THROW(PoseLogEncoder{options}, std::invalid_argument);
+  options = PoseLogOptions();
+  options.rotation_bits = 31;
+  EXPECT_THROW(PoseLogEncoder{options}, std::invalid_argument);
+  options = PoseLogOptions();
+  options.chunk_size = 0;
+  EXPECT_THROW(PoseLogEncoder{options}, std::invalid_argument);
+
+  PoseLogEncoder encoder;
+  const Isometry far = Isometry::FromTranslation({1e13, 0., 0.});
+  EXPECT_THROW(encoder.append(&far, 1), std::invalid_argument);
+  const Isometry nan = Isometry::FromTranslation({0., NAN, 0.});
+  EXPECT_THROW(encoder.append(&nan, 1), std::invalid_argument);
+  EXPECT_EQ(encoder.size(), 0u);
+
+  const std::vector<Isometry> poses = smoothPoses(3000);
+  encoder.append(poses.data(), poses.size());
+  const std::vector<std::uint8_t> log = encoder.finish();
+  std::vector<std::uint8_t> bad = log;
+  bad[0] = 'X';
+  EXPECT_THROW(PoseLogDecoder{bad}, std::invalid_argument);
+  // The index no longer fits.
+  bad.assign(log.begin(), log.end() - 1);
+  EXPECT_THROW(PoseLogDecoder{bad}, std::invalid_argument);
+  EXPECT_THROW(PoseLogDecoder(log.data(), 10), std::invalid_argument);
+  // A delta width past the limit in the first chunk: the first channel's
+  // width follows its two varints.
+  bad = log;
+  std::size_t width = kPoseLogHeaderSize;
+  for (int varints = 0; varints < 2; ++width) {
+    varints += (bad[width] & 0x80) == 0;
+  }
+  bad[width] = 60;
+  const PoseLogDecoder decoder(bad);
+  EXPECT_THROW(decoder.at<double>(0), std::invalid_argument);
+  EXPECT_NO_THROW(decoder.at<double>(2000));
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+#include "pose_segment_tree.h"
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+testing::AssertionResult areAlmostEqual(const Isometry &a, const Isometry &b,
+                                        const double tolerance) {
+  for (int i = 0; i < 3; ++i) {
+    if (std::abs(a.translation()[i] - b.translation()[i]) > tolerance) {
+      return testing::AssertionFailure() << a << " != " << b;
+    }
+    for (int j = 0; j < 3; ++j) {
+      if (std::abs(a.rotation()[i][j] - b.rotation()[i][j]) > tolerance) {
+        return testing::AssertionFailure() << a << " != " << b;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+// Increments that do not commute with each other.
+Isometry incrementNumber(std::size_t k) {
+  return Isometry::FromTranslation({1. + k, 0.5 * k, -0.25 * k}) *
+         Isometry::FromEulerAngles(0.1 * k, 0.3 - 0.05 * k, 0.7 + 0.2 * k);
+}
+
+Isometry composeLinearly(const std::vector<Isometry> &increments,
+                         std::size_t begin, std::size_t end) {
+  Isometry composed;
+  for (std::size_t i = begin; i < end; ++i) {
+    composed = composed * increments[i];
+  }
+  return composed;
+}
+
+testing::AssertionResult matchesEveryRange(
+    const PoseSegmentTree &tree, const std::vector<Isometry> &increments) {
+  const double kTolerance{1e-9};
+  for (std::size_t begin = 0; begin <= increments.size(); ++begin) {
+    for (std::size_t end = begin; end <= increments.size(); ++end) {
+      if (!areAlmostEqual(tree.compose(begin, end),
+                          composeLinearly(increments, begin, end),
+                          kTolerance)) {
+        return testing::AssertionFailure()
+               << "range [" << begin << ", " << end << ") of "
+               << increments.size();
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+GTEST_TEST(PoseSegmentTreeTest, ComposeMatchesLinearFold) {
+  // Sizes that are and are not powers of two.
+  for (std::size_t size = 0; size <= 33; ++size) {
+    std::vector<Isometry> increments;
+    for (std::size_t k = 0; k < size; ++k) {
+      increments.push_back(incrementNumber(k));
+    }
+    const PoseSegmentTree tree(increments);
+    EXPECT_EQ(tree.size(), size);
+    EXPECT_TRUE(matchesEveryRange(tree, increments));
+  }
+}
+
+GTEST_TEST(PoseSegmentTreeTest, Update) {
+  std::vector<Isometry> increments;
+  for (std::size_t k = 0; k < 21; ++k) {
+    increments.push_back(incrementNumber(k));
+  }
+  PoseSegmentTree tree(increments);
+  for (std::size_t k : {0u, 20u, 7u, 13u}) {
+    increments[k] = incrementNumber(100 + k);
+    tree.update(k, increments[k]);
+    EXPECT_EQ(tree.increment(k), increments[k]);
+  }
+  EXPECT_TRUE(matchesEveryRange(tree, increments));
+}
+
+GTEST_TEST(PoseSegmentTreeTest, OutOfRange) {
+  const std::vector<Isometry> increments(5, incrementNumber(1));
+  PoseSegmentTree tree(increments);
+  EXPECT_THROW(tree.compose(0, 6), std::out_of_range);
+  EXPECT_THROW(tree.compose(3, 2), std::out_of_range);
+  EXPECT_THROW(tree.increment(5), std::out_of_range);
+  EXPECT_THROW(tree.update(5, Isometry()), std::out_of_range);
+  EXPECT_EQ(tree.compose(2, 2), Isometry());
+
+  const PoseSegmentTree empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(empty.compose(0, 0), Isometry());
+}
+
+GTEST_TEST(PoseSegmentTreeTest, FloatInstantiation) {
+  const std::vector<Isometryf> increments(
+      10, Isometryf::FromTranslation({1.f, 0.f, 0.f}));
+  const PoseSegmentTreef tree(increments);
+  EXPECT_EQ(tree.compose(2, 9).translation(), Vector3f(7.f, 0.f, 0.f));
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
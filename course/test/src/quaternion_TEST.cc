@@ -0,0 +1,143 @@
+#include "quaternion.h"
+
+#include <cmath>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+testing::AssertionResult areAlmostEqual(const Matrix3 &a, const Matrix3 &b,
+                                        const double &tolerance) {
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      if (std::abs(a[i][j] - b[i][j]) > tolerance) {
+        return testing::AssertionFailure() << a << " != " << b;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+testing::AssertionResult areAlmostEqual(const Vector3 &a, const Vector3 &b,
+                                        const double &tolerance) {
+  if ((a - b).norm() > tolerance) {
+    return testing::AssertionFailure() << a << " != " << b;
+  }
+  return testing::AssertionSuccess();
+}
+
+GTEST_TEST(QuaternionTest, QuaternionOperations) {
+  const double kTolerance{1e-12};
+  const Quaternion qx = Quaternion::FromAxisAngle(Vector3::kUnitX, M_PI / 2.);
+  const Quaternion qz = Quaternion::FromAxisAngle(Vector3::kUnitZ, M_PI / 8.);
+  EXPECT_NEAR(qx.norm(), 1., kTolerance);
+  EXPECT_TRUE(areAlmostEqual(qx.toRotation(),
+                             Isometry::RotateAround(Vector3::kUnitX, M_PI / 2.)
+                                 .rotation(),
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual(qx * Vector3::kUnitY, Vector3::kUnitZ, kTolerance));
+  EXPECT_TRUE(areAlmostEqual((qx * qz).toRotation(),
+                             qx.toRotation().product(qz.toRotation()),
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual((qz * qz.conjugate()).toRotation(),
+                             Matrix3::kIdentity, kTolerance));
+  EXPECT_NEAR(Quaternion(1., 1., 1., 1.).normalized().norm(), 1., kTolerance);
+  EXPECT_EQ(Quaternion::kIdentity * Quaternion(0.5, 0.5, 0.5, 0.5),
+            Quaternion(0.5, 0.5, 0.5, 0.5));
+
+  std::stringstream ss;
+  ss << Quaternion::kIdentity;
+  EXPECT_EQ(ss.str(), "(w: 1, x: 0, y: 0, z: 0)");
+}
+
+GTEST_TEST(QuaternionTest, RotationMatrixRoundTrip) {
+  const double kTolerance{1e-12};
+  // Exercises every branch of FromRotation: small and large angles around
+  // each axis.
+  const double kAngles[] = {0., 0.3, 2.9, M_PI, -1.7};
+  const Vector3 kAxes[] = {Vector3::kUnitX, Vector3::kUnitY, Vector3::kUnitZ,
+                           Vector3(1., 2., -2.) * (1. / 3.)};
+  for (const Vector3 &axis : kAxes) {
+    for (const double angle : kAngles) {
+      const Matrix3 r = Isometry::RotateAround(axis, angle).rotation();
+      const Quaternion q = Quaternion::FromRotation(r);
+      EXPECT_NEAR(q.norm(), 1., kTolerance);
+      EXPECT_TRUE(areAlmostEqual(q.toRotation(), r, kTolerance))
+          << "axis " << axis << " angle " << angle;
+    }
+  }
+}
+
+GTEST_TEST(QuaternionTest, Slerp) {
+  const double kTolerance{1e-12};
+  const Vector3 axis = Vector3(1., 2., -2.) * (1. / 3.);
+  const Quaternion from = Quaternion::FromAxisAngle(axis, 0.2);
+  const Quaternion to = Quaternion::FromAxisAngle(axis, 1.4);
+  for (const double t : {0., 0.25, 0.5, 1.}) {
+    const Quaternion expected = Quaternion::FromAxisAngle(axis, 0.2 + 1.2 * t);
+    EXPECT_TRUE(areAlmostEqual(from.slerp(to, t).toRotation(),
+                               expected.toRotation(), kTolerance))
+        << t;
+    // -to is the same rotation; slerp must still take the short arc.
+    const Quaternion negated(-to.w(), -to.x(), -to.y(), -to.z());
+    EXPECT_TRUE(areAlmostEqual(from.slerp(negated, t).toRotation(),
+                               expected.toRotation(), kTolerance))
+        << t;
+  }
+  // Nearly identical rotations fall back to a normalized lerp.
+  const Quaternion close = Quaternion::FromAxisAngle(axis, 0.2 + 1e-9);
+  EXPECT_NEAR(from.slerp(close, 0.5).norm(), 1., kTolerance);
+
+  const IsometryQ a(Vector3(1., 0., 0.), from);
+  const IsometryQ b(Vector3(3., 2., 0.), to);
+  const IsometryQ mid = a.interpolate(b, 0.5);
+  EXPECT_TRUE(areAlmostEqual(mid.translation(), Vector3(2., 1., 0.),
+                             kTolerance));
+  EXPECT_TRUE(areAlmostEqual(
+      mid.rotation().toRotation(),
+      Quaternion::FromAxisAngle(axis, 0.8).toRotation(), kTolerance));
+}
+
+GTEST_TEST(IsometryQTest, MatchesMatrixIsometry) {
+  const double kTolerance{1e-12};
+  const Isometry a = Isometry::FromTranslation({1., 2., 3.}) *
+                     Isometry::FromEulerAngles(0.1, 0.2, 0.3);
+  const Isometry b = Isometry::FromTranslation({-4., 0.5, 1.}) *
+                     Isometry::FromEulerAngles(-1.2, 0.7, 2.9);
+  const IsometryQ qa(a);
+  const IsometryQ qb(b);
+  const Vector3 p{0.3, -7., 2.};
+
+  EXPECT_TRUE(areAlmostEqual(qa * p, a * p, kTolerance));
+  EXPECT_TRUE(areAlmostEqual((qa * qb) * p, (a * b) * p, kTolerance));
+  EXPECT_TRUE(areAlmostEqual(qa.compose(qb).toIsometry().rotation(),
+                             (a * b).rotation(), kTolerance));
+  EXPECT_TRUE(areAlmostEqual(qa.inverse() * (qa * p), p, kTolerance));
+  EXPECT_TRUE(areAlmostEqual(qa.inverse().transform(p), a.inverse() * p,
+                             kTolerance));
+
+  IsometryQ chain;
+  Isometry reference;
+  for (int i = 0; i < 1000; ++i) {
+    chain = (chain * qb).normalized();
+    reference = reference * b;
+  }
+  EXPECT_TRUE(areAlmostEqual(chain * p, reference * p, 1e-9));
+
+  EXPECT_EQ(sizeof(IsometryQ), 56u);
+  const IsometryQf qf = qa.cast<float>();
+  EXPECT_NEAR((qf * p.cast<float>()).x(), (a * p).x(), 1e-5);
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
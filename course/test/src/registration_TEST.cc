@@ -0,0 +1,250 @@
+#include "registration.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+// Uniform in the box of half-size `extent` around `center`.
+template <typename T>
+PointCloud3T<T> randomCloud(std::size_t count, double extent,
+                            const Vector3 &center = Vector3()) {
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> coordinate(-extent, extent);
+  PointCloud3T<T> cloud;
+  for (std::size_t i = 0; i < count; ++i) {
+    const Vector3 point(center[0] + coordinate(generator),
+                        center[1] + coordinate(generator),
+                        center[2] + coordinate(generator));
+    cloud.push_back(point.cast<T>());
+  }
+  return cloud;
+}
+
+// pose * source, rounded to T only at the end.
+template <typename T>
+PointCloud3T<T> transformed(const Isometry &pose,
+                            const PointCloud3T<T> &source) {
+  PointCloud3T<T> target;
+  for (std::size_t i = 0; i < source.size(); ++i) {
+    target.push_back(
+        Vector3(pose * source[i].template cast<double>()).cast<T>());
+  }
+  return target;
+}
+
+template <typename T>
+testing::AssertionResult arePosesNear(const IsometryT<T> &actual,
+                                      const Isometry &expected,
+                                      double rotation_tolerance,
+                                      double translation_tolerance) {
+  const Isometry pose = actual.template cast<double>();
+  for (int r = 0; r < 3; ++r) {
+    if (std::abs(pose.translation()[r] - expected.translation()[r]) >
+        translation_tolerance) {
+      return testing::AssertionFailure()
+             << pose << " is not near " << expected;
+    }
+    for (int c = 0; c < 3; ++c) {
+      if (std::abs(pose.rotation()(r, c) - expected.rotation()(r, c)) >
+          rotation_tolerance) {
+        return testing::AssertionFailure()
+               << pose << " is not near " << expected;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+const Isometry kPose =
+    Isometry::FromTranslation({1.5, -20., 3.}) *
+    Isometry::FromEulerAngles(0.4, -0.7, 2.5);
+
+template <typename T> void checkExactPairs(double tolerance) {
+  // Not a multiple of the vector width, so the scalar tail runs too.
+  for (const std::size_t count : {3u, 4u, 7u, 1003u}) {
+    const PointCloud3T<T> source = randomCloud<T>(count, 10.);
+    const PointCloud3T<T> target = transformed(kPose, source);
+    EXPECT_TRUE(arePosesNear(estimateRigidTransform(source.view(),
+                                                    target.view()),
+                             kPose, tolerance, 10 * tolerance))
+        << count << " pairs";
+  }
+}
+
+GTEST_TEST(RegistrationTest, RecoversPoseFromExactPairs) {
+  checkExactPairs<double>(1e-12);
+  checkExactPairs<float>(1e-5);
+}
+
+GTEST_TEST(RegistrationTest, RecoversPoseFarFromOrigin) {
+  // A 20 m patch at UTM-like coordinates.
+  const Isometry pose = Isometry::FromTranslation({0.3, -0.2, 0.05}) *
+                        Isometry::RotateAround({0., 0., 1.}, 0.01);
+  const PointCloud3 source =
+      randomCloud<double>(1000, 10., Vector3(4.5e5, 5.4e6, 120.));
+  const PointCloud3 target = transformed(pose, source);
+  // The pose about the world origin swings the patch around by 5e4 m, so
+  // compare where it takes the points instead.
+  const Isometry estimate =
+      estimateRigidTransform(source.view(), target.view());
+  for (std::size_t i = 0; i < source.size(); ++i) {
+    const Vector3 error = estimate * source[i] - target[i];
+    ASSERT_LT(error.norm(), 1e-8) << i;
+  }
+}
+
+GTEST_TEST(RegistrationTest, MatchesLeastSquaresWithNoise) {
+  const PointCloud3 source = randomCloud<double>(2000, 5.);
+  PointCloud3 target = transformed(kPose, source);
+  std::mt19937 generator(7);
+  std::normal_distribution<double> noise(0., 0.01);
+  for (std::size_t i = 0; i < target.size(); ++i) {
+    target.x()[i] += noise(generator);
+    target.y()[i] += noise(generator);
+    target.z()[i] += noise(generator);
+  }
+  const Isometry estimate =
+      estimateRigidTransform(source.view(), target.view());
+  EXPECT_TRUE(arePosesNear(estimate, kPose, 1e-3, 1e-3));
+  EXPECT_TRUE(estimate.rotation().isOrthonormal(1e-12));
+
+  // No small perturbation of the estimate fits better.
+  const auto cost = [&](const Isometry &pose) {
+    double sum = 0.;
+    for (std::size_t i = 0; i < source.size(); ++i) {
+      const Vector3 error = pose * source[i] - target[i];
+      sum += error.dot(error);
+    }
+    return sum;
+  };
+  const double best = cost(estimate);
+  for (int axis = 0; axis < 3; ++axis) {
+    Vector3 direction;
+    direction[axis] = 1.;
+    for (const double step : {-1e-4, 1e-4}) {
+      EXPECT_GE(cost(Isometry::RotateAround(direction, step) * estimate),
+                best);
+      EXPECT_GE(cost(Isometry::FromTranslation(direction * step) * estimate),
+                best);
+    }
+  }
+}
+
+template <typename T> void checkWeights(double tolerance) {
+  const PointCloud3T<T> source = randomCloud<T>(1001, 10.);
+  PointCloud3T<T> target = transformed(kPose, source);
+  // Every third pair is an outlier with weight 0; the rest weigh 1 to 3.
+  std::vector<T> weights(source.size());
+  for (std::size_t i = 0; i < source.size(); ++i) {
+    weights[i] = static_cast<T>(1 + i % 3);
+    if (i % 3 == 1) {
+      weights[i] = 0;
+      target.x()[i] += 100;
+    }
+  }
+  EXPECT_TRUE(arePosesNear(estimateRigidTransform(source.view(),
+                                                  target.view(),
+                                                  weights.data()),
+                           kPose, tolerance, 10 * tolerance));
+  EXPECT_FALSE(arePosesNear(
+      estimateRigidTransform(source.view(), target.view()), kPose, tolerance,
+      10 * tolerance));
+}
+
+GTEST_TEST(RegistrationTest, WeightsDiscardOutliers) {
+  checkWeights<double>(1e-12);
+  checkWeights<float>(1e-5);
+}
+
+GTEST_TEST(RegistrationTest, StridedViewsMatchContiguousOnes) {
+  // Interleaved x, y, z records.
+  const PointCloud3 source = randomCloud<double>(1003, 10.);
+  const PointCloud3 target = transformed(kPose, source);
+  std::vector<double> source_records, target_records;
+  for (std::size_t i = 0; i < source.size(); ++i) {
+    for (int k = 0; k < 3; ++k) {
+      source_records.push_back(source[i][k]);
+      target_records.push_back(target[i][k]);
+    }
+  }
+  const std::size_t stride = 3 * sizeof(double);
+  const auto view = [&](const std::vector<double> &records) {
+    return PointView3{StridedSpan<double>(&records[0], source.size(), stride),
+                      StridedSpan<double>(&records[1], source.size(), stride),
+                      StridedSpan<double>(&records[2], source.size(), stride)};
+  };
+  const Isometry strided =
+      estimateRigidTransform(view(source_records), view(target_records));
+  const Isometry contiguous =
+      estimateRigidTransform(source.view(), target.view());
+  EXPECT_TRUE(arePosesNear(strided, contiguous, 1e-13, 1e-12));
+  EXPECT_TRUE(arePosesNear(strided, kPose, 1e-12, 1e-11));
+}
+
+GTEST_TEST(RegistrationTest, ReturnsRotationForMirroredPoints) {
+  const PointCloud3 source = randomCloud<double>(100, 1.);
+  PointCloud3 target = source;
+  for (std::size_t i = 0; i < target.size(); ++i) {
+    target.z()[i] = -target.z()[i];
+  }
+  const Isometry estimate =
+      estimateRigidTransform(source.view(), target.view());
+  EXPECT_TRUE(estimate.rotation().isOrthonormal(1e-12));
+  EXPECT_NEAR(estimate.rotation().det(), 1., 1e-12);
+}
+
+GTEST_TEST(RegistrationTest, DegenerateInputs) {
+  // A single pair only fixes the translation.
+  const PointCloud3 one = randomCloud<double>(1, 1.);
+  const PointCloud3 moved = transformed(kPose, one);
+  const Isometry estimate = estimateRigidTransform(one.view(), moved.view());
+  EXPECT_LT((estimate * one[0] - moved[0]).norm(), 1e-12);
+  EXPECT_TRUE(estimate.rotation().isOrthonormal(1e-12));
+
+  // Collinear points: any rotation about the line fits them exactly.
+  PointCloud3 line;
+  for (int i = 0; i < 10; ++i) {
+    line.push_back(Vector3(i, 2. * i, -i));
+  }
+  const PointCloud3 moved_line = transformed(kPose, line);
+  const Isometry line_estimate =
+      estimateRigidTransform(line.view(), moved_line.view());
+  for (std::size_t i = 0; i < line.size(); ++i) {
+    EXPECT_LT((line_estimate * line[i] - moved_line[i]).norm(), 1e-12);
+  }
+}
+
+GTEST_TEST(RegistrationTest, RejectsBadInput) {
+  const PointCloud3 three = randomCloud<double>(3, 1.);
+  const PointCloud3 four = randomCloud<double>(4, 1.);
+  EXPECT_THROW(estimateRigidTransform(three.view(), four.view()),
+               std::invalid_argument);
+  EXPECT_THROW(estimateRigidTransform(PointCloud3().view(),
+                                      PointCloud3().view()),
+               std::invalid_argument);
+  const double zeros[3] = {0., 0., 0.};
+  EXPECT_THROW(estimateRigidTransform(three.view(), three.view(), zeros),
+               std::invalid_argument);
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double nans[3] = {1., nan, 1.};
+  EXPECT_THROW(estimateRigidTransform(three.view(), three.view(), nans),
+               std::invalid_argument);
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,76 @@
+#include "seqlock.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+// Pose number `k`: every coefficient is derived from k, so a torn read shows
+// up as a mismatch between them.
+Isometry poseNumber(const double k) {
+  return Isometry(Vector3(k, k, k), Matrix3{k, k, k, k, k, k, k, k, k});
+}
+
+bool isConsistent(const Isometry &pose) {
+  const double k = pose.translation().x();
+  return pose == poseNumber(k);
+}
+
+GTEST_TEST(SeqlockTest, StoreAndLoad) {
+  PoseCell cell;
+  EXPECT_EQ(cell.load(), Isometry());
+  EXPECT_EQ(cell.version(), 1u);
+  const Isometry pose = Isometry::FromTranslation({1., 2., 3.}) *
+                        Isometry::RotateAround(Vector3::kUnitZ, 0.5);
+  cell.store(pose);
+  EXPECT_EQ(cell.load(), pose);
+  EXPECT_EQ(cell.version(), 2u);
+
+  const Seqlock<Vector3f> odd_size(Vector3f(1.f, 2.f, 3.f));
+  EXPECT_EQ(odd_size.load(), Vector3f(1.f, 2.f, 3.f));
+}
+
+GTEST_TEST(SeqlockTest, ReadersNeverSeeTornValues) {
+  const int kStores{20000};
+  const int kReaders{3};
+  PoseCell cell(poseNumber(0.));
+  std::atomic<bool> done{false};
+  std::atomic<int> torn{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < kReaders; ++i) {
+    readers.emplace_back([&]() {
+      double last = 0.;
+      while (!done.load()) {
+        const Isometry pose = cell.load();
+        if (!isConsistent(pose) || pose.translation().x() < last) {
+          ++torn;
+        }
+        last = pose.translation().x();
+      }
+    });
+  }
+  for (int k = 1; k <= kStores; ++k) {
+    cell.store(poseNumber(k));
+  }
+  done.store(true);
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(torn.load(), 0);
+  EXPECT_EQ(cell.load(), poseNumber(kStores));
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,82 @@
+#include "shared_frame_graph.h"
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+// world -> base -> sensor, where the base is `k` meters along x.
+FrameGraph graphNumber(const double k) {
+  FrameGraph graph;
+  graph.addFrame("world");
+  graph.setTransform("world", "base", Isometry::FromTranslation({k, 0., 0.}));
+  graph.setTransform("base", "sensor",
+                     Isometry::FromTranslation({0., 0., 1.}));
+  return graph;
+}
+
+GTEST_TEST(SharedFrameGraphTest, PublishAndRead) {
+  SharedFrameGraph shared(graphNumber(1.));
+  {
+    const SharedFrameGraph::Reader reader = shared.read();
+    EXPECT_EQ(reader->lookup("sensor", "world").translation(),
+              Vector3(1., 0., 1.));
+    EXPECT_EQ((*reader).size(), 3u);
+  }
+  shared.publish(graphNumber(2.));
+  SharedFrameGraph::Reader reader = shared.read();
+  const SharedFrameGraph::Reader moved(std::move(reader));
+  EXPECT_EQ(moved->lookup("sensor", "world").translation(),
+            Vector3(2., 0., 1.));
+}
+
+GTEST_TEST(SharedFrameGraphTest, ConcurrentReaders) {
+  const int kPublishes{500};
+  const int kReaders{3};
+  SharedFrameGraph shared(graphNumber(0.));
+  std::atomic<bool> done{false};
+  std::atomic<int> errors{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < kReaders; ++i) {
+    readers.emplace_back([&]() {
+      double last = 0.;
+      while (!done.load()) {
+        const SharedFrameGraph::Reader reader = shared.read();
+        const Vector3 t = reader->lookup("sensor", "world").translation();
+        // Snapshots only move forward and are never half updated.
+        if (t.x() < last || t.y() != 0. || t.z() != 1. ||
+            reader->lookup("base", "sensor").translation().z() != -1.) {
+          ++errors;
+        }
+        last = t.x();
+      }
+    });
+  }
+  for (int k = 1; k <= kPublishes; ++k) {
+    shared.publish(graphNumber(k));
+  }
+  done.store(true);
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(errors.load(), 0);
+  EXPECT_EQ(shared.read()->lookup("base", "world").translation().x(),
+            kPublishes);
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
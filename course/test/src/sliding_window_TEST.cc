@@ -0,0 +1,96 @@
+#include "sliding_window.h"
+
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <random>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+testing::AssertionResult areAlmostEqual(const Isometry &a, const Isometry &b,
+                                        const double tolerance) {
+  for (int i = 0; i < 3; ++i) {
+    if (std::abs(a.translation()[i] - b.translation()[i]) > tolerance) {
+      return testing::AssertionFailure() << a << " != " << b;
+    }
+    for (int j = 0; j < 3; ++j) {
+      if (std::abs(a.rotation()[i][j] - b.rotation()[i][j]) > tolerance) {
+        return testing::AssertionFailure() << a << " != " << b;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+Isometry incrementNumber(std::size_t k) {
+  return Isometry::FromTranslation({1., 0.1 * (k % 7), -0.2 * (k % 5)}) *
+         Isometry::FromEulerAngles(0.1 * (k % 3), 0.2, 0.05 * (k % 11));
+}
+
+Isometry composeAll(const std::deque<Isometry> &window) {
+  Isometry composed;
+  for (const Isometry &increment : window) {
+    composed = composed * increment;
+  }
+  return composed;
+}
+
+GTEST_TEST(SlidingWindowComposerTest, MatchesRecomposition) {
+  const double kTolerance{1e-9};
+  const std::size_t kCapacity{9};
+  SlidingWindowComposer composer(kCapacity);
+  EXPECT_EQ(composer.capacity(), kCapacity);
+  EXPECT_EQ(composer.windowComposition(), Isometry());
+
+  std::deque<Isometry> window;
+  std::mt19937 generator(7);
+  std::bernoulli_distribution pops(0.3);
+  for (std::size_t k = 0; k < 1000; ++k) {
+    if (pops(generator) && !window.empty()) {
+      composer.pop();
+      window.pop_front();
+    } else {
+      composer.push(incrementNumber(k));
+      window.push_back(incrementNumber(k));
+      if (window.size() > kCapacity) {
+        window.pop_front();
+      }
+    }
+    ASSERT_EQ(composer.size(), window.size());
+    ASSERT_EQ(composer.full(), window.size() == kCapacity);
+    ASSERT_TRUE(
+        areAlmostEqual(composer.windowComposition(), composeAll(window),
+                       kTolerance))
+        << "step " << k;
+  }
+
+  composer.clear();
+  EXPECT_TRUE(composer.empty());
+  EXPECT_EQ(composer.windowComposition(), Isometry());
+  EXPECT_THROW(composer.pop(), std::out_of_range);
+}
+
+GTEST_TEST(SlidingWindowComposerTest, CapacityOne) {
+  EXPECT_THROW(SlidingWindowComposer(0), std::invalid_argument);
+  SlidingWindowComposerf composer(1);
+  composer.push(Isometryf::FromTranslation({1.f, 0.f, 0.f}));
+  composer.push(Isometryf::FromTranslation({0.f, 2.f, 0.f}));
+  EXPECT_EQ(composer.size(), 1u);
+  EXPECT_EQ(composer.windowComposition().translation(),
+            Vector3f(0.f, 2.f, 0.f));
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,169 @@
+#include "text.h"
+
+#include <clocale>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+GTEST_TEST(TextTest, Format) {
+  EXPECT_EQ(text::toString(Vector3(1., -0.5, 1e-20)), "1 -0.5 1e-20");
+  EXPECT_EQ(text::toString(Vector3f(0.1f, 2.f, 3.f), ','), "0.1,2,3");
+  EXPECT_EQ(text::toString(Matrix3::kIdentity), "1 0 0 0 1 0 0 0 1");
+  const Isometry pose = Isometry::FromTranslation({4., 5., 6.});
+  EXPECT_EQ(text::toString(pose), "1 0 0 4 0 1 0 5 0 0 1 6");
+
+  char small[8];
+  const std::to_chars_result result =
+      text::format(small, small + sizeof(small), pose);
+  EXPECT_EQ(result.ec, std::errc::value_too_large);
+}
+
+GTEST_TEST(TextTest, RoundTripIsExact) {
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  std::uniform_real_distribution<double> exponent(-300., 300.);
+  for (int i = 0; i < 1000; ++i) {
+    const Isometry pose =
+        Isometry::FromTranslation({std::pow(10., exponent(generator)),
+                                   -angle(generator), angle(generator)}) *
+        Isometry::FromEulerAngles(angle(generator), angle(generator),
+                                  angle(generator));
+    const std::string s = text::toString(pose);
+    Isometry parsed;
+    const std::from_chars_result result =
+        text::parse(s.data(), s.data() + s.size(), parsed);
+    ASSERT_EQ(result.ec, std::errc());
+    ASSERT_EQ(result.ptr, s.data() + s.size());
+    ASSERT_EQ(parsed, pose) << s;
+
+    const Isometryf posef = pose.cast<float>();
+    const std::string sf = text::toString(posef);
+    Isometryf parsedf;
+    text::parse(sf.data(), sf.data() + sf.size(), parsedf);
+    ASSERT_EQ(parsedf, posef) << sf;
+  }
+  const double extremes[] = {std::numeric_limits<double>::lowest(),
+                             std::numeric_limits<double>::denorm_min(),
+                             -std::numeric_limits<double>::min(), -0.};
+  for (const double value : extremes) {
+    const Vector3 v(value, value, value);
+    const std::string s = text::toString(v);
+    EXPECT_LE(s.size(), text::maxChars<Vector3>());
+    Vector3 parsed;
+    text::parse(s.data(), s.data() + s.size(), parsed);
+    EXPECT_EQ(parsed, v);
+  }
+}
+
+GTEST_TEST(TextTest, ParseIsLenient) {
+  const std::string s = "  +1.5,\t-2 , 3e2 rest";
+  Vector3 v;
+  const std::from_chars_result result =
+      text::parse(s.data(), s.data() + s.size(), v, ',');
+  EXPECT_EQ(result.ec, std::errc());
+  EXPECT_EQ(v, Vector3(1.5, -2., 300.));
+  EXPECT_EQ(std::string(result.ptr), " rest");
+
+  const std::string missing = "1 2";
+  EXPECT_EQ(text::parse(missing.data(), missing.data() + missing.size(), v).ec,
+            std::errc::invalid_argument);
+  const std::string bad = "1 x 3";
+  const std::from_chars_result bad_result =
+      text::parse(bad.data(), bad.data() + bad.size(), v);
+  EXPECT_EQ(bad_result.ec, std::errc::invalid_argument);
+  EXPECT_EQ(bad_result.ptr, bad.data() + 2);
+  const std::string huge = "1 1e40 3";
+  Vector3f vf;
+  EXPECT_EQ(text::parse(huge.data(), huge.data() + huge.size(), vf).ec,
+            std::errc::result_out_of_range);
+}
+
+GTEST_TEST(TextTest, Lines) {
+  std::vector<Isometry> poses;
+  for (int i = 0; i < 100; ++i) {
+    poses.push_back(Isometry::FromTranslation({0.1 * i, 1. / (i + 1), -3.}) *
+                    Isometry::RotateAround(Vector3::kUnitZ, 0.01 * i));
+  }
+  std::vector<char> buffer(poses.size() * text::maxChars<Isometry>());
+  const text::FormatResult formatted =
+      text::formatLines(buffer.data(), buffer.data() + buffer.size(),
+                        poses.data(), poses.size());
+  ASSERT_EQ(formatted.ec, std::errc());
+  EXPECT_EQ(formatted.count, poses.size());
+  EXPECT_EQ(*(formatted.ptr - 1), '\n');
+
+  std::vector<Isometry> parsed(poses.size() + 10);
+  const text::ParseResult result = text::parseLines(
+      buffer.data(), formatted.ptr, parsed.data(), parsed.size());
+  ASSERT_EQ(result.ec, std::errc());
+  ASSERT_EQ(result.count, poses.size());
+  EXPECT_EQ(result.ptr, formatted.ptr);
+  parsed.resize(result.count);
+  EXPECT_EQ(parsed, poses);
+
+  // Stops at the capacity, right after a line break.
+  const text::ParseResult partial =
+      text::parseLines(buffer.data(), formatted.ptr, parsed.data(), 10);
+  EXPECT_EQ(partial.count, 10u);
+  EXPECT_EQ(*(partial.ptr - 1), '\n');
+
+  // Only whole lines fit in a short buffer.
+  char short_buffer[20];
+  const text::FormatResult truncated = text::formatLines(
+      short_buffer, short_buffer + sizeof(short_buffer), poses.data(), 2);
+  EXPECT_EQ(truncated.ec, std::errc::value_too_large);
+  EXPECT_EQ(truncated.count, 0u);
+}
+
+GTEST_TEST(TextTest, LinesWithCommentsAndErrors) {
+  const std::string input = "# x y z\r\n1 2 3\r\n\n  \n4 5 6";
+  std::vector<Vector3> points(4);
+  const text::ParseResult result = text::parseLines(
+      input.data(), input.data() + input.size(), points.data(), points.size());
+  EXPECT_EQ(result.ec, std::errc());
+  ASSERT_EQ(result.count, 2u);
+  EXPECT_EQ(points[0], Vector3(1., 2., 3.));
+  EXPECT_EQ(points[1], Vector3(4., 5., 6.));
+
+  const std::string extra = "1 2 3\n1 2 3 4\n";
+  const text::ParseResult bad = text::parseLines(
+      extra.data(), extra.data() + extra.size(), points.data(), points.size());
+  EXPECT_EQ(bad.ec, std::errc::invalid_argument);
+  EXPECT_EQ(bad.count, 1u);
+  EXPECT_EQ(bad.ptr, extra.data() + 6);
+}
+
+GTEST_TEST(TextTest, IgnoresLocale) {
+  // A locale with a decimal comma, if the system has one.
+  const char *previous = std::setlocale(LC_NUMERIC, nullptr);
+  const std::string saved = previous != nullptr ? previous : "C";
+  if (std::setlocale(LC_NUMERIC, "de_DE.UTF-8") == nullptr) {
+    return;
+  }
+  const std::string s = text::toString(Vector3(0.5, 1.25, -2.));
+  Vector3 parsed;
+  text::parse(s.data(), s.data() + s.size(), parsed);
+  std::setlocale(LC_NUMERIC, saved.c_str());
+  EXPECT_EQ(s, "0.5 1.25 -2");
+  EXPECT_EQ(parsed, Vector3(0.5, 1.25, -2.));
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+#include "thread_pool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+// Runs parallelFor over [0, count) and checks every index is visited once
+// and every chunk is non-empty and at most `grain` long.
+testing::AssertionResult coversOnce(ThreadPool &pool, std::size_t count,
+                                    std::size_t grain) {
+  std::vector<std::atomic<int>> visits(count);
+  const std::size_t max_chunk = grain == 0 ? 1 : grain;
+  std::atomic<bool> oversized{false};
+  pool.parallelFor(count, grain, [&](std::size_t begin, std::size_t end) {
+    if (end - begin > max_chunk || begin >= end) {
+      oversized = true;
+    }
+    for (std::size_t i = begin; i < end; ++i) {
+      ++visits[i];
+    }
+  });
+  if (oversized) {
+    return testing::AssertionFailure() << "chunk out of bounds for grain "
+                                       << grain;
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    if (visits[i] != 1) {
+      return testing::AssertionFailure()
+             << "index " << i << " visited " << visits[i] << " times";
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+GTEST_TEST(ThreadPoolTest, CoversEveryIndexOnce) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.threads(), 4u);
+  EXPECT_TRUE(coversOnce(pool, 0, 16));
+  EXPECT_TRUE(coversOnce(pool, 1, 16));
+  EXPECT_TRUE(coversOnce(pool, 1000, 1));
+  EXPECT_TRUE(coversOnce(pool, 1000, 7));
+  EXPECT_TRUE(coversOnce(pool, 1000, 1000));
+  EXPECT_TRUE(coversOnce(pool, 100003, 64));
+  // A zero grain is treated as one.
+  EXPECT_TRUE(coversOnce(pool, 10, 0));
+}
+
+GTEST_TEST(ThreadPoolTest, SingleThreadRunsOnCaller) {
+  ThreadPool pool(1);
+  EXPECT_EQ(pool.threads(), 1u);
+  const std::thread::id caller = std::this_thread::get_id();
+  std::atomic<bool> elsewhere{false};
+  pool.parallelFor(100, 3, [&](std::size_t, std::size_t) {
+    if (std::this_thread::get_id() != caller) {
+      elsewhere = true;
+    }
+  });
+  EXPECT_FALSE(elsewhere);
+  EXPECT_TRUE(coversOnce(pool, 100, 3));
+}
+
+GTEST_TEST(ThreadPoolTest, RethrowsAfterAllChunksRan) {
+  // A one-thread pool runs the chunks inline but keeps the same contract.
+  for (const std::size_t threads : {1u, 3u}) {
+    ThreadPool pool(threads);
+    std::atomic<int> chunks{0};
+    EXPECT_THROW(pool.parallelFor(100, 1,
+                                  [&](std::size_t begin, std::size_t) {
+                                    ++chunks;
+                                    if (begin % 10 == 0) {
+                                      throw std::runtime_error("failed");
+                                    }
+                                  }),
+                 std::runtime_error);
+    EXPECT_EQ(chunks, 100) << threads << " threads";
+    // The pool is still usable afterwards.
+    EXPECT_TRUE(coversOnce(pool, 1000, 10));
+  }
+}
+
+GTEST_TEST(ThreadPoolTest, NestedParallelFor) {
+  ThreadPool pool(4);
+  const std::size_t kOuter{16};
+  const std::size_t kInner{500};
+  std::vector<std::atomic<int>> visits(kOuter * kInner);
+  pool.parallelFor(kOuter, 1, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t outer = begin; outer < end; ++outer) {
+      pool.parallelFor(kInner, 10, [&](std::size_t b, std::size_t e) {
+        for (std::size_t inner = b; inner < e; ++inner) {
+          ++visits[outer * kInner + inner];
+        }
+      });
+    }
+  });
+  for (std::size_t i = 0; i < visits.size(); ++i) {
+    ASSERT_EQ(visits[i], 1) << "index " << i;
+  }
+}
+
+GTEST_TEST(ThreadPoolTest, ConcurrentCallers) {
+  ThreadPool pool(3);
+  std::vector<std::thread> callers;
+  std::atomic<int> failures{0};
+  for (int i = 0; i < 3; ++i) {
+    callers.emplace_back([&]() {
+      for (int k = 0; k < 50; ++k) {
+        if (!coversOnce(pool, 997, 13)) {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (std::thread &caller : callers) {
+    caller.join();
+  }
+  EXPECT_EQ(failures, 0);
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
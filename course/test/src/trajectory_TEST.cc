@@ -0,0 +1,122 @@
+#include "trajectory.h"
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+testing::AssertionResult areAlmostEqual(const Isometry &a, const Isometry &b,
+                                        const double tolerance) {
+  for (int i = 0; i < 3; ++i) {
+    if (std::abs(a.translation()[i] - b.translation()[i]) > tolerance) {
+      return testing::AssertionFailure() << a << " != " << b;
+    }
+    for (int j = 0; j < 3; ++j) {
+      if (std::abs(a.rotation()[i][j] - b.rotation()[i][j]) > tolerance) {
+        return testing::AssertionFailure() << a << " != " << b;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+// Odometry-like increments: a small step forward and a small turn.
+std::vector<Isometry> makeIncrements(std::size_t count) {
+  std::vector<Isometry> increments;
+  for (std::size_t i = 0; i < count; ++i) {
+    increments.push_back(
+        Isometry::FromTranslation({0.01, 0.001 * std::sin(0.1 * i), 0.}) *
+        Isometry::FromEulerAngles(1e-3 * std::cos(0.01 * i), 2e-3, 1e-2));
+  }
+  return increments;
+}
+
+GTEST_TEST(TrajectoryTest, SerialScans) {
+  const double kTolerance{1e-12};
+  const std::vector<Isometry> increments = makeIncrements(100);
+  const Isometry origin = Isometry::FromTranslation({5., 0., 1.});
+
+  std::vector<Isometry> inclusive(increments.size());
+  trajectory::inclusiveScan(increments.data(), inclusive.data(),
+                            increments.size(), origin);
+  std::vector<Isometry> exclusive(increments.size());
+  const Isometry end = trajectory::exclusiveScan(
+      increments.data(), exclusive.data(), increments.size(), origin);
+
+  Isometry running = origin;
+  for (std::size_t i = 0; i < increments.size(); ++i) {
+    EXPECT_TRUE(areAlmostEqual(exclusive[i], running, kTolerance));
+    running = running * increments[i];
+    EXPECT_TRUE(areAlmostEqual(inclusive[i], running, kTolerance));
+  }
+  EXPECT_TRUE(areAlmostEqual(end, running, kTolerance));
+
+  // Empty input.
+  EXPECT_EQ(trajectory::exclusiveScan<double>(nullptr, nullptr, 0, origin),
+            origin);
+}
+
+GTEST_TEST(TrajectoryTest, PooledScansMatchSerial) {
+  const double kTolerance{1e-9};
+  const Isometry origin = Isometry::RotateAround(Vector3::kUnitZ, 0.5);
+  ThreadPool pool(4);
+  // Below the serial cutoff, and above it with a ragged last block.
+  for (const std::size_t count : {1000u, 100003u}) {
+    const std::vector<Isometry> increments = makeIncrements(count);
+    std::vector<Isometry> serial(count);
+    trajectory::inclusiveScan(increments.data(), serial.data(), count, origin);
+    std::vector<Isometry> pooled(count);
+    trajectory::inclusiveScan(increments.data(), pooled.data(), count, pool,
+                              origin);
+    for (std::size_t i = 0; i < count; ++i) {
+      ASSERT_TRUE(areAlmostEqual(pooled[i], serial[i], kTolerance))
+          << "inclusive, index " << i;
+    }
+
+    std::vector<Isometry> serial_exclusive(count);
+    const Isometry serial_end = trajectory::exclusiveScan(
+        increments.data(), serial_exclusive.data(), count, origin);
+    // In place.
+    std::vector<Isometry> in_place = increments;
+    const Isometry pooled_end = trajectory::exclusiveScan(
+        in_place.data(), in_place.data(), count, pool, origin);
+    EXPECT_TRUE(areAlmostEqual(pooled_end, serial_end, kTolerance));
+    for (std::size_t i = 0; i < count; ++i) {
+      ASSERT_TRUE(areAlmostEqual(in_place[i], serial_exclusive[i], kTolerance))
+          << "exclusive, index " << i;
+    }
+  }
+}
+
+GTEST_TEST(TrajectoryTest, ReorthonormalizationBoundsDrift) {
+  const std::size_t kCount{200000};
+  std::vector<Isometryf> increments;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    increments.push_back(Isometryf::FromEulerAngles(0.001f, 0.002f, 0.003f));
+  }
+  std::vector<Isometryf> drifting(kCount);
+  trajectory::inclusiveScan(increments.data(), drifting.data(), kCount);
+  ThreadPool pool(3);
+  std::vector<Isometryf> corrected(kCount);
+  trajectory::inclusiveScan(increments.data(), corrected.data(), kCount, pool,
+                            Isometryf(), 64);
+  EXPECT_FALSE(drifting.back().rotation().isOrthonormal(1e-4f));
+  for (std::size_t i = 63; i < kCount; i += 64) {
+    ASSERT_TRUE(corrected[i].rotation().isOrthonormal(1e-5f)) << i;
+  }
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
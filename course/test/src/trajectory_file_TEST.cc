@@ -0,0 +1,221 @@
+#include "trajectory_file.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+std::string tempPath(const std::string &name) {
+  return testing::internal::TempDir() + "trajectory_file_TEST_" + name;
+}
+
+void writeFile(const std::string &path, const std::string &text) {
+  std::ofstream(path, std::ios::binary) << text;
+}
+
+template <typename T> IsometryT<T> poseNumber(std::size_t i) {
+  return IsometryT<T>::FromTranslation(
+             {T(0.01) * T(i), T(1.5), T(-2.) - T(1e-3) * T(i)}) *
+         IsometryT<T>::FromEulerAngles(T(1e-3) * T(i), T(0.2), T(-0.3));
+}
+
+testing::AssertionResult areAlmostEqual(const Isometry &a, const Isometry &b,
+                                        double tolerance) {
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      if (std::abs(a.rotation()(i, j) - b.rotation()(i, j)) > tolerance) {
+        return testing::AssertionFailure() << a << " != " << b;
+      }
+    }
+    if (std::abs(a.translation()[i] - b.translation()[i]) > tolerance) {
+      return testing::AssertionFailure() << a << " != " << b;
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+// Every pose of the file, read `chunk_size` at a time.
+template <typename T>
+std::vector<IsometryT<T>> readAll(const std::string &path,
+                                  TrajectoryFormat format,
+                                  std::size_t chunk_size,
+                                  std::vector<double> *stamps = nullptr) {
+  TrajectoryReader<T> reader(path, format, chunk_size);
+  std::vector<IsometryT<T>> poses;
+  while (reader.next()) {
+    EXPECT_LE(reader.poses().size(), chunk_size);
+    poses.insert(poses.end(), reader.poses().begin(), reader.poses().end());
+    if (stamps != nullptr) {
+      stamps->insert(stamps->end(), reader.stamps().begin(),
+                     reader.stamps().end());
+    }
+  }
+  EXPECT_EQ(reader.count(), poses.size());
+  EXPECT_TRUE(reader.poses().empty());
+  EXPECT_FALSE(reader.next());
+  return poses;
+}
+
+GTEST_TEST(TrajectoryFileTest, KittiRoundTripIsExact) {
+  const std::string path = tempPath("round_trip.txt");
+  // Over 2 MiB of text, so lines straddle several buffer refills.
+  std::vector<Isometry> poses;
+  for (std::size_t i = 0; i < 10000; ++i) {
+    poses.push_back(poseNumber<double>(i));
+  }
+  TrajectoryWriter<double> writer(path, TrajectoryFormat::kKitti);
+  writer.write(poses.data(), 4000);
+  writer.write(poses.data() + 4000, poses.size() - 4000);
+  EXPECT_EQ(writer.size(), poses.size());
+  writer.close();
+
+  const std::vector<Isometry> read =
+      readAll<double>(path, TrajectoryFormat::kKitti, 333);
+  ASSERT_EQ(read.size(), poses.size());
+  for (std::size_t i = 0; i < poses.size(); ++i) {
+    ASSERT_EQ(read[i], poses[i]) << "pose " << i;
+  }
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(TrajectoryFileTest, TumRoundTrip) {
+  const std::string path = tempPath("round_trip.tum");
+  std::vector<double> stamps;
+  std::vector<Isometry> poses;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    stamps.push_back(1305031102.175304 + 0.033 * i);
+    poses.push_back(poseNumber<double>(i));
+  }
+  {
+    TrajectoryWriter<double> writer(path, TrajectoryFormat::kTum);
+    EXPECT_THROW(writer.write(poses.data(), 1), std::invalid_argument);
+    writer.write(stamps.data(), poses.data(), poses.size());
+    // The destructor closes the file.
+  }
+
+  std::vector<double> read_stamps;
+  const std::vector<Isometry> read =
+      readAll<double>(path, TrajectoryFormat::kTum, 64, &read_stamps);
+  ASSERT_EQ(read.size(), poses.size());
+  EXPECT_EQ(read_stamps, stamps);
+  for (std::size_t i = 0; i < poses.size(); ++i) {
+    // Through a quaternion and back.
+    ASSERT_TRUE(areAlmostEqual(read[i], poses[i], 1e-12)) << "pose " << i;
+  }
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(TrajectoryFileTest, FloatPoses) {
+  const std::string path = tempPath("float.txt");
+  std::vector<Isometryf> poses;
+  for (std::size_t i = 0; i < 100; ++i) {
+    poses.push_back(poseNumber<float>(i));
+  }
+  TrajectoryWriter<float> writer(path, TrajectoryFormat::kKitti);
+  writer.write(poses.data(), poses.size());
+  writer.close();
+  const std::vector<Isometryf> read =
+      readAll<float>(path, TrajectoryFormat::kKitti, 10);
+  EXPECT_EQ(read, poses);
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(TrajectoryFileTest, HandWrittenTum) {
+  const std::string path = tempPath("hand_written.tum");
+  // Comments, blank and CRLF lines, a plus sign, a quaternion off unit norm
+  // and no final line break.
+  writeFile(path, "# ground truth\n"
+                  "# timestamp tx ty tz qx qy qz qw\r\n"
+                  "\n"
+                  "1.5 1 2 3 0 0 0 1\r\n"
+                  "  2.5\t+4 5 6 0 0 0.7071067811865476 0.7071067811865476\n"
+                  "\r\n"
+                  "3.5 0 0 0 0 0 0 2");
+  std::vector<double> stamps;
+  const std::vector<Isometry> poses =
+      readAll<double>(path, TrajectoryFormat::kTum, 2, &stamps);
+  ASSERT_EQ(poses.size(), 3u);
+  EXPECT_EQ(stamps, (std::vector<double>{1.5, 2.5, 3.5}));
+  EXPECT_EQ(poses[0], Isometry::FromTranslation({1., 2., 3.}));
+  EXPECT_TRUE(areAlmostEqual(poses[1],
+                             Isometry(Vector3(4., 5., 6.),
+                                      Matrix3{0., -1., 0., 1., 0., 0., 0., 0.,
+                                              1.}),
+                             1e-15));
+  EXPECT_EQ(poses[2], Isometry());
+  std::remove(path.c_str());
+}
+
+GTEST_TEST(TrajectoryFileTest, MalformedRecordsNameTheLine) {
+  const std::string path = tempPath("malformed.txt");
+  writeFile(path, "1 0 0 0 0 1 0 0 0 0 1 0\n"
+                  "# comment\n"
+                  "1 0 0 0 0 1 0 0 0 0 1\n");
+  TrajectoryReader<double> reader(path, TrajectoryFormat::kKitti);
+  try {
+    reader.next();
+    FAIL() << "the short record was accepted";
+  } catch (const std::invalid_argument &error) {
+    EXPECT_NE(std::string(error.what()).find(path + ":3:"),
+              std::string::npos)
+        << error.what();
+  }
+
+  // Too many values, after a chunk that ended cleanly.
+  writeFile(path, "0 0 0 0 0 0 0 1\n1 0 0 0 0 0 0 1 5\n");
+  TrajectoryReader<double> tum(path, TrajectoryFormat::kTum, 1);
+  EXPECT_TRUE(tum.next());
+  EXPECT_THROW(tum.next(), std::invalid_argument);
+
+  // Quaternions that cannot be normalized.
+  for (const char *quaternion : {"0 0 0 0", "0 0 inf 1", "nan 0 0 1"}) {
+    writeFile(path, "0 0 0 0 0 0 0 1\n1.0 0 0 0 " + std::string(quaternion) +
+                        "\n");
+    TrajectoryReader<double> bad(path, TrajectoryFormat::kTum);
+    try {
+      bad.next();
+      FAIL() << "the quaternion " << quaternion << " was accepted";
+    } catch (const std::invalid_argument &error) {
+      EXPECT_NE(std::string(error.what()).find(path + ":2:"),
+                std::string::npos)
+          << error.what();
+    }
+  }
+
+  EXPECT_THROW(TrajectoryReader<double>(path, TrajectoryFormat::kTum, 0),
+               std::invalid_argument);
+  std::remove(path.c_str());
+  EXPECT_THROW(TrajectoryReader<double>(path, TrajectoryFormat::kTum),
+               std::runtime_error);
+}
+
+GTEST_TEST(TrajectoryFileTest, LongLinesGrowTheBuffer) {
+  const std::string path = tempPath("long_line.txt");
+  // A record padded past the 1 MiB read buffer.
+  writeFile(path, "1 0 0 0 0 1 0 0 0 0 1 0" + std::string(3 << 20, ' ') +
+                      "\n1 0 0 7 0 1 0 0 0 0 1 0\n");
+  TrajectoryReader<double> reader(path, TrajectoryFormat::kKitti);
+  ASSERT_TRUE(reader.next());
+  ASSERT_EQ(reader.poses().size(), 2u);
+  EXPECT_EQ(reader.poses()[1], Isometry::FromTranslation({7., 0., 0.}));
+  EXPECT_GT(reader.memoryBytes(), std::size_t(3 << 20));
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,117 @@
+#include "transform_buffer.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+namespace ekumen {
+namespace math {
+namespace test {
+
+testing::AssertionResult areAlmostEqual(const Isometry &a, const Isometry &b,
+                                        const double &tolerance) {
+  for (int i = 0; i < 3; ++i) {
+    if (std::abs(a.translation()[i] - b.translation()[i]) > tolerance) {
+      return testing::AssertionFailure() << a << " != " << b;
+    }
+    for (int j = 0; j < 3; ++j) {
+      if (std::abs(a.rotation()[i][j] - b.rotation()[i][j]) > tolerance) {
+        return testing::AssertionFailure() << a << " != " << b;
+      }
+    }
+  }
+  return testing::AssertionSuccess();
+}
+
+// Constant velocity motion: 1 m/s along x and 0.5 rad/s around z.
+Isometry poseAt(const double stamp) {
+  return Isometry::FromTranslation({stamp, 0., 1.}) *
+         Isometry::RotateAround(Vector3::kUnitZ, 0.5 * stamp);
+}
+
+GTEST_TEST(TransformBufferTest, InterpolatedLookup) {
+  const double kTolerance{1e-12};
+  TransformBuffer buffer(16);
+  EXPECT_TRUE(buffer.empty());
+  for (int i = 0; i < 5; ++i) {
+    buffer.insert(i * 0.1, poseAt(i * 0.1));
+  }
+  EXPECT_EQ(buffer.size(), 5u);
+  EXPECT_DOUBLE_EQ(buffer.oldestStamp(), 0.);
+  EXPECT_DOUBLE_EQ(buffer.latestStamp(), 0.4);
+  // On samples, between samples (binary search and latest segment) and at
+  // both ends.
+  for (const double stamp : {0., 0.1, 0.05, 0.17, 0.25, 0.33, 0.4}) {
+    EXPECT_TRUE(areAlmostEqual(buffer.lookup(stamp), poseAt(stamp),
+                               kTolerance))
+        << stamp;
+  }
+}
+
+GTEST_TEST(TransformBufferTest, RingBufferWrapsAround) {
+  const double kTolerance{1e-12};
+  TransformBuffer buffer(4);
+  for (int i = 0; i < 10; ++i) {
+    buffer.insert(i, poseAt(i));
+  }
+  EXPECT_EQ(buffer.size(), 4u);
+  EXPECT_EQ(buffer.capacity(), 4u);
+  EXPECT_DOUBLE_EQ(buffer.oldestStamp(), 6.);
+  EXPECT_DOUBLE_EQ(buffer.latestStamp(), 9.);
+  for (const double stamp : {6., 6.5, 7.25, 8.9, 9.}) {
+    EXPECT_TRUE(areAlmostEqual(buffer.lookup(stamp), poseAt(stamp),
+                               kTolerance))
+        << stamp;
+  }
+  EXPECT_THROW(buffer.lookup(5.5), std::out_of_range);
+  buffer.clear();
+  EXPECT_THROW(buffer.lookup(9.), std::out_of_range);
+  buffer.insert(1., poseAt(1.));
+  EXPECT_TRUE(areAlmostEqual(buffer.lookup(1.), poseAt(1.), kTolerance));
+}
+
+GTEST_TEST(TransformBufferTest, BatchLookup) {
+  TransformBuffer buffer(64);
+  for (int i = 0; i < 50; ++i) {
+    buffer.insert(i * 0.02, poseAt(i * 0.02));
+  }
+  std::vector<double> stamps;
+  for (int i = 0; i < 97; ++i) {
+    stamps.push_back(i * 0.01);
+  }
+  // An unsorted tail restarts the search.
+  stamps.push_back(0.015);
+  stamps.push_back(0.5);
+  std::vector<Isometry> poses(stamps.size());
+  buffer.lookup(stamps.data(), poses.data(), stamps.size());
+  for (std::size_t i = 0; i < stamps.size(); ++i) {
+    EXPECT_EQ(poses[i], buffer.lookup(stamps[i])) << stamps[i];
+  }
+}
+
+GTEST_TEST(TransformBufferTest, Errors) {
+  EXPECT_THROW(TransformBuffer(1), std::invalid_argument);
+  TransformBuffer buffer(8);
+  EXPECT_THROW(buffer.lookup(0.), std::out_of_range);
+  buffer.insert(1., Isometry());
+  buffer.insert(2., Isometry());
+  EXPECT_THROW(buffer.insert(2., Isometry()), std::invalid_argument);
+  EXPECT_THROW(buffer.insert(1.5, Isometry()), std::invalid_argument);
+  EXPECT_THROW(buffer.lookup(0.5), std::out_of_range);
+  EXPECT_THROW(buffer.lookup(2.5), std::out_of_range);
+  const double stamps[] = {1.5, 3.};
+  Isometry poses[2];
+  EXPECT_THROW(buffer.lookup(stamps, poses, 2), std::out_of_range);
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
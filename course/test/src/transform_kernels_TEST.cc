@@ -0,0 +1,103 @@
+#include "transform_kernels.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace cppcourse;
+using namespace cppcourse::kernels;
+namespace ekumen {
+namespace math {
+namespace test {
+
+const Backend kAllBackends[] = {Backend::kScalar, Backend::kSse42,
+                                Backend::kAvx2, Backend::kAvx512};
+
+GTEST_TEST(TransformKernelsTest, BackendNames) {
+  for (const Backend backend : kAllBackends) {
+    Backend parsed = Backend::kScalar;
+    ASSERT_TRUE(parseBackend(backendName(backend), &parsed));
+    EXPECT_EQ(parsed, backend);
+  }
+  Backend untouched = Backend::kAvx2;
+  EXPECT_FALSE(parseBackend("neon", &untouched));
+  EXPECT_EQ(untouched, Backend::kAvx2);
+  EXPECT_TRUE(isSupported(Backend::kScalar));
+  EXPECT_TRUE(isSupported(bestBackend()));
+  EXPECT_TRUE(isSupported(activeBackend()));
+
+  const char *pinned = std::getenv(kBackendEnvVar);
+  Backend expected = bestBackend();
+  if (pinned != nullptr && parseBackend(pinned, &expected) &&
+      !isSupported(expected)) {
+    expected = bestBackend();
+  }
+  EXPECT_EQ(activeBackend(), expected);
+}
+
+template <typename T> void expectBackendsAgreeWithScalar() {
+  const AffineCoefficients<T> c = {{T(0.36), T(-0.48), T(0.8), T(10.), T(0.8),
+                                    T(0.6), T(0.), T(-20.), T(-0.48), T(0.64),
+                                    T(0.6), T(0.5)}};
+  // Covers every tail length of the widest backend.
+  for (std::size_t n = 0; n < 40; n += 3) {
+    std::vector<T> x(n), y(n), z(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      x[i] = T(std::sin(i) * 100.);
+      y[i] = T(std::cos(i * 0.7) * 50.);
+      z[i] = T(i * 0.25 - 3.);
+    }
+    std::vector<T> ex(n), ey(n), ez(n);
+    transformPoints(Backend::kScalar, c, x.data(), y.data(), z.data(),
+                    ex.data(), ey.data(), ez.data(), n);
+    for (const Backend backend : kAllBackends) {
+      if (!isSupported(backend)) {
+        continue;
+      }
+      std::vector<T> ox(n), oy(n), oz(n);
+      transformPoints(backend, c, x.data(), y.data(), z.data(), ox.data(),
+                      oy.data(), oz.data(), n);
+      for (std::size_t i = 0; i < n; ++i) {
+        const T *out[3] = {ox.data(), oy.data(), oz.data()};
+        const T *expected[3] = {ex.data(), ey.data(), ez.data()};
+        for (int r = 0; r < 3; ++r) {
+          const T magnitude =
+              std::abs(c.m[4 * r] * x[i]) + std::abs(c.m[4 * r + 1] * y[i]) +
+              std::abs(c.m[4 * r + 2] * z[i]) + std::abs(c.m[4 * r + 3]);
+          if (backend == Backend::kSse42) {
+            EXPECT_EQ(out[r][i], expected[r][i]);
+          } else {
+            EXPECT_NEAR(out[r][i], expected[r][i], tolerance<T>() * magnitude)
+                << backendName(backend) << " n=" << n << " i=" << i;
+          }
+        }
+      }
+      // In place.
+      std::vector<T> ix(x), iy(y), iz(z);
+      transformPoints(backend, c, ix.data(), iy.data(), iz.data(), ix.data(),
+                      iy.data(), iz.data(), n);
+      EXPECT_EQ(ix, ox);
+      EXPECT_EQ(iy, oy);
+      EXPECT_EQ(iz, oz);
+    }
+  }
+}
+
+GTEST_TEST(TransformKernelsTest, DoubleBackendsAgreeWithScalar) {
+  expectBackendsAgreeWithScalar<double>();
+}
+
+GTEST_TEST(TransformKernelsTest, FloatBackendsAgreeWithScalar) {
+  expectBackendsAgreeWithScalar<float>();
+}
+
+}  // namespace test
+}  // namespace math
+}  // namespace ekumen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}